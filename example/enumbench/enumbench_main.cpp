@@ -0,0 +1,261 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "ofp/ofp.h"
+#include "ofp/yaml/ybuffernumber.h"
+#include "ofp/yaml/yconstants.h"
+#include "ofp/yaml/ygroupnumber.h"
+#include "ofp/yaml/yportnumber.h"
+
+using namespace ofp;
+using llvm::yaml::ScalarTraits;
+
+// Benchmark the enum name lookups done by `oftr encode` for the messages in
+// bench_flowmod.json (see tools/oftr/test/runtests-benchmark.sh). Each name is
+// looked up using the converter's name table, and using a linear scan of the
+// converter's names, which is how EnumConverter used to look up a name.
+
+enum Field {
+  kType,
+  kFlowModCommand,
+  kGroupModCommand,
+  kGroupType,
+  kBufferId,
+  kPortNo,
+  kGroupId
+};
+
+struct Sample {
+  Field field;
+  llvm::StringRef name;
+  unsigned count;
+};
+
+// Number of times each name appears in an enum field of bench_flowmod.json.
+static const Sample kSamples[] = {{kType, "FLOW_MOD", 74190},
+                                  {kType, "BARRIER_REQUEST", 6628},
+                                  {kType, "PORT_MOD", 2353},
+                                  {kType, "GROUP_MOD", 286},
+                                  {kFlowModCommand, "ADD", 38195},
+                                  {kFlowModCommand, "MODIFY_STRICT", 21155},
+                                  {kFlowModCommand, "DELETE", 14656},
+                                  {kFlowModCommand, "DELETE_STRICT", 184},
+                                  {kGroupModCommand, "DELETE", 114},
+                                  {kGroupModCommand, "ADD", 94},
+                                  {kGroupModCommand, "MODIFY", 78},
+                                  {kGroupType, "ALL", 270},
+                                  {kGroupType, "FF", 16},
+                                  {kBufferId, "NO_BUFFER", 74190},
+                                  {kPortNo, "ANY", 13759},
+                                  {kPortNo, "CONTROLLER", 1269},
+                                  {kPortNo, "IN_PORT", 64},
+                                  {kGroupId, "ANY", 14840},
+                                  {kGroupId, "ALL", 20}};
+
+/// Converts a name to a value by comparing it to each of the converter's
+/// names in turn.
+template <class Type>
+class LinearConverter {
+ public:
+  template <class Converter>
+  explicit LinearConverter(const Converter &converter)
+      : names_{converter.listAll()} {
+    for (auto name : names_) {
+      Type value;
+      converter.convert(name, &value);
+      values_.push_back(value);
+    }
+  }
+
+  bool convert(llvm::StringRef name, Type *value) const {
+    for (size_t i = 0; i < names_.size(); ++i) {
+      if (name.equals(names_[i])) {
+        *value = values_[i];
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<llvm::StringRef> names_;
+  std::vector<Type> values_;
+};
+
+/// Looks up names using the YAML converters.
+struct ConverterLookup {
+  template <class Type, class Converter>
+  static UInt32 convert(const Converter &converter, llvm::StringRef name) {
+    Type value{};
+    converter.convert(name, &value);
+    return static_cast<UInt32>(value);
+  }
+
+  UInt32 lookup(const Sample &sample) const {
+    switch (sample.field) {
+      case kType:
+        return convert<OFPType>(ScalarTraits<OFPType>::converter, sample.name);
+      case kFlowModCommand:
+        return convert<OFPFlowModCommand>(
+            ScalarTraits<OFPFlowModCommand>::converter, sample.name);
+      case kGroupModCommand:
+        return convert<OFPGroupModCommand>(
+            ScalarTraits<OFPGroupModCommand>::converter, sample.name);
+      case kGroupType:
+        return convert<OFPGroupType>(ScalarTraits<OFPGroupType>::converter,
+                                     sample.name);
+      case kBufferId:
+        return convert<OFPBufferNo>(ScalarTraits<BufferNumber>::converter,
+                                    sample.name);
+      case kPortNo:
+        return convert<OFPPortNo>(ScalarTraits<PortNumber>::converter,
+                                  sample.name);
+      case kGroupId:
+        return convert<OFPGroupNo>(ScalarTraits<GroupNumber>::converter,
+                                   sample.name);
+    }
+    return 0;
+  }
+};
+
+/// Looks up the same names using a linear scan.
+struct LinearLookup {
+  LinearConverter<OFPType> type{ScalarTraits<OFPType>::converter};
+  LinearConverter<OFPFlowModCommand> flowModCommand{
+      ScalarTraits<OFPFlowModCommand>::converter};
+  LinearConverter<OFPGroupModCommand> groupModCommand{
+      ScalarTraits<OFPGroupModCommand>::converter};
+  LinearConverter<OFPGroupType> groupType{
+      ScalarTraits<OFPGroupType>::converter};
+  LinearConverter<OFPBufferNo> bufferId{ScalarTraits<BufferNumber>::converter};
+  LinearConverter<OFPPortNo> portNo{ScalarTraits<PortNumber>::converter};
+  LinearConverter<OFPGroupNo> groupId{ScalarTraits<GroupNumber>::converter};
+
+  template <class Type>
+  static UInt32 convert(const LinearConverter<Type> &converter,
+                        llvm::StringRef name) {
+    Type value{};
+    converter.convert(name, &value);
+    return static_cast<UInt32>(value);
+  }
+
+  UInt32 lookup(const Sample &sample) const {
+    switch (sample.field) {
+      case kType:
+        return convert(type, sample.name);
+      case kFlowModCommand:
+        return convert(flowModCommand, sample.name);
+      case kGroupModCommand:
+        return convert(groupModCommand, sample.name);
+      case kGroupType:
+        return convert(groupType, sample.name);
+      case kBufferId:
+        return convert(bufferId, sample.name);
+      case kPortNo:
+        return convert(portNo, sample.name);
+      case kGroupId:
+        return convert(groupId, sample.name);
+    }
+    return 0;
+  }
+};
+
+static void logStats(const char *label, const std::vector<double> &data) {
+  if (data.size() == 0)
+    return;
+
+  double sum = std::accumulate(data.begin(), data.end(), 0.0);
+  double mean = sum / data.size();
+
+  double accum = 0.0;
+  std::for_each(data.begin(), data.end(), [mean, &accum](double x) {
+    accum += (x - mean) * (x - mean);
+  });
+
+  double stddev = std::sqrt(accum / data.size());
+
+  std::cout << label << " ns/lookup Mean/Stddev: " << mean << "/" << stddev
+            << '\n';
+}
+
+template <class Lookup>
+static double timeLookups(const Lookup &lookup,
+                          const std::vector<Sample> &workload,
+                          unsigned loops) {
+  using clock = std::chrono::high_resolution_clock;
+  using nanoseconds = std::chrono::nanoseconds;
+
+  volatile UInt32 junk = 0;
+  auto start = clock::now();
+
+  for (unsigned i = 0; i < loops; ++i) {
+    for (const auto &sample : workload) {
+      // Make sure the benchmarked operation is NOT optimized out.
+      junk += lookup.lookup(sample);
+    }
+  }
+
+  auto end = clock::now();
+  auto duration = std::chrono::duration_cast<nanoseconds>(end - start);
+  return static_cast<double>(duration.count()) / (loops * workload.size());
+}
+
+int main(int argc, char **argv) {
+  // One sample per name in bench_flowmod.json, in random order.
+  std::vector<Sample> workload;
+  for (const auto &sample : kSamples) {
+    workload.insert(workload.end(), sample.count, sample);
+  }
+  std::shuffle(workload.begin(), workload.end(), std::mt19937{1});
+
+  ConverterLookup converter;
+  LinearLookup linear;
+
+  // Both lookups must agree.
+  for (const auto &sample : kSamples) {
+    if (converter.lookup(sample) != linear.lookup(sample)) {
+      std::cout << "Lookup mismatch: " << sample.name.str() << std::endl;
+      return 1;
+    }
+  }
+
+  // First optional argument is number of loops.
+  const int kTrials = 5;
+  const unsigned kLoops = (argc == 2) ? Unsigned_cast(std::atoi(argv[1])) : 20;
+  std::vector<double> converterResults;
+  std::vector<double> linearResults;
+
+  std::cout << "Running Enum Lookup Benchmark: " << kTrials << " trials, "
+            << kLoops << " loops each of " << workload.size() << " lookups"
+            << std::endl;
+
+  for (int trial = 0; trial <= kTrials; ++trial) {
+    double converterTime = timeLookups(converter, workload, kLoops);
+    double linearTime = timeLookups(linear, workload, kLoops);
+
+    std::cout << "Trial " << std::setw(2) << trial
+              << " Converter: " << converterTime << " ns Linear: " << linearTime
+              << " ns" << std::endl;
+
+    // Ignore trial 0.
+    if (trial == 0) {
+      std::cout << "Ignore trial 0..." << std::endl;
+      continue;
+    }
+
+    converterResults.push_back(converterTime);
+    linearResults.push_back(linearTime);
+  }
+
+  logStats("Converter", converterResults);
+  logStats("Linear", linearResults);
+
+  return 0;
+}
@@ -843,6 +843,9 @@ public:
 
   virtual void setError(const Twine &) = 0;
 
+  // Check if there was an error during input.
+  virtual std::error_code error() { return std::error_code(); }
+
   template <typename T>
   void enumCase(T &Val, const char* Str, const T ConstVal) {
     if ( matchEnumScalar(Str, outputting() && Val == ConstVal) ) {
@@ -1534,7 +1537,7 @@ public:
   ~Input() override;
 
   // Check if there was an syntax or semantic error during parsing.
-  std::error_code error();
+  std::error_code error() override;
 
 private:
   bool outputting() override;
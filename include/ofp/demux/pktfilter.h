@@ -6,6 +6,8 @@
 
 #include <pcap/pcap.h>
 
+#include <vector>
+
 #include "ofp/byterange.h"
 
 namespace ofp {
@@ -32,6 +34,8 @@ class PktFilter {
   bool match(ByteRange data) const { return match(data, data.size()); }
   bool match(ByteRange data, size_t totalLen) const;
 
+  const struct bpf_program &program() const { return prog_; }
+
  private:
   struct bpf_program prog_ = {0, nullptr};
   std::string filter_;
@@ -40,6 +44,47 @@ class PktFilter {
   PktFilter &operator=(const PktFilter &) = delete;
 };
 
+/// \brief A concrete class that matches a packet against a list of filters
+/// in one pass.
+///
+/// The BPF programs of the filters are concatenated into one program. Each
+/// `ret #0` is changed into a jump to the start of the next filter, and each
+/// other `ret #k` returns the index of the filter plus one. If a filter's
+/// program can't be rewritten this way (i.e. it returns a register value), the
+/// filters are matched one at a time instead.
+///
+/// The PktFilter objects must outlive the PktFilterSet.
+
+class PktFilterSet {
+ public:
+  enum : size_t { npos = ~size_t{} };
+
+  PktFilterSet() = default;
+
+  void clear();
+  void setFilters(const std::vector<const PktFilter *> &filters);
+
+  size_t size() const { return filters_.size(); }
+  bool isMerged() const { return !program_.empty(); }
+
+  /// Return the index of the first filter at or after `start` that matches,
+  /// or npos if no filter matches.
+  size_t match(ByteRange data, size_t start = 0) const {
+    return match(data, data.size(), start);
+  }
+  size_t match(ByteRange data, size_t totalLen, size_t start) const;
+
+ private:
+  std::vector<const PktFilter *> filters_;
+  std::vector<struct bpf_insn> program_;
+  std::vector<UInt32> offsets_;  // start of each filter in program_
+
+  bool merge();
+
+  PktFilterSet(const PktFilterSet &) = delete;
+  PktFilterSet &operator=(const PktFilterSet &) = delete;
+};
+
 OFP_END_IGNORE_PADDING
 
 }  // namespace demux
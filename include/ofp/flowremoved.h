@@ -55,6 +55,8 @@ class FlowRemoved
   friend class FlowRemovedBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(FlowRemoved) == 56, "Unexpected size.");
@@ -55,6 +55,8 @@ class FlowRemovedV6
   friend class FlowRemovedV6Builder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(FlowRemovedV6) == 32, "Unexpected size.");
@@ -4,6 +4,9 @@
 #ifndef OFP_HASH_H_
 #define OFP_HASH_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "ofp/types.h"
 
 // This file contains source code adapted from MurmurHash3:
@@ -81,6 +84,107 @@ void HashCombine(size_t &seed, const T &val) {
   seed ^= std::hash<T>{}(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+// A perfect hash table maps a fixed set of keys to distinct slots using two
+// arrays of UInt16: `seeds` and `slots`. The key's first hash selects a seed;
+// the hash with that seed selects the slot. Each slot holds the index of a
+// key, or PerfectHashEmpty. The table is built by PerfectHashBuild, usually
+// by a program that writes the arrays out as source code.
+
+enum : UInt16 { PerfectHashEmpty = 0xFFFF };
+
+/// Return hash of `key` using the hash function selected by `seed`.
+inline UInt32 PerfectHash32(llvm::StringRef key, UInt32 seed) {
+  // FNV-1a
+  UInt32 h = 2166136261U ^ (seed * 0x9e3779b9U);
+  for (char ch : key) {
+    h ^= static_cast<UInt8>(ch);
+    h *= 16777619U;
+  }
+  return detail::FinalMix32(h);
+}
+
+/// Return hash of `key` using the hash function selected by `seed`.
+inline UInt32 PerfectHash32(UInt32 key, UInt32 seed) {
+  return detail::FinalMix32(key ^ (seed * 0x9e3779b9U));
+}
+
+/// Return the index stored for `key` in a perfect hash table with `size`
+/// slots (a power of 2). The caller must check that the key at the returned
+/// index is equal to `key`; a key that was not in the table returns
+/// PerfectHashEmpty or an unrelated index.
+template <class Key>
+UInt16 PerfectHashFind(const Key &key, const UInt16 *seeds,
+                       const UInt16 *slots, size_t size) {
+  const UInt32 mask = UInt32_narrow_cast(size - 1);
+  UInt16 seed = seeds[PerfectHash32(key, 0) & mask];
+  return slots[PerfectHash32(key, seed) & mask];
+}
+
+/// Build a perfect hash table with `size` slots for the distinct `keys`.
+/// `size` must be a power of 2 that is at least `keys.size()`. Return false
+/// if no table is found.
+template <class Key>
+bool PerfectHashBuild(const std::vector<Key> &keys, size_t size,
+                      std::vector<UInt16> *seeds, std::vector<UInt16> *slots) {
+  assert((size & (size - 1)) == 0);
+  if (keys.size() > size || keys.size() >= PerfectHashEmpty) {
+    return false;
+  }
+
+  const UInt32 mask = UInt32_narrow_cast(size - 1);
+  seeds->assign(size, 0);
+  slots->assign(size, PerfectHashEmpty);
+
+  std::vector<std::vector<UInt16>> buckets(size);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    buckets[PerfectHash32(keys[i], 0) & mask].push_back(UInt16_narrow_cast(i));
+  }
+
+  // Place the largest buckets first.
+  std::vector<UInt32> order(size);
+  for (UInt32 i = 0; i < size; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&buckets](UInt32 a, UInt32 b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  std::vector<UInt32> placed;
+  for (UInt32 b : order) {
+    const auto &bucket = buckets[b];
+    if (bucket.empty()) {
+      break;
+    }
+
+    UInt32 seed = 1;
+    for (; seed < PerfectHashEmpty; ++seed) {
+      placed.clear();
+      for (UInt16 i : bucket) {
+        UInt32 slot = PerfectHash32(keys[i], seed) & mask;
+        if ((*slots)[slot] != PerfectHashEmpty ||
+            std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+          break;
+        }
+        placed.push_back(slot);
+      }
+      if (placed.size() == bucket.size()) {
+        break;
+      }
+    }
+
+    if (seed == PerfectHashEmpty) {
+      return false;
+    }
+
+    (*seeds)[b] = UInt16_narrow_cast(seed);
+    for (size_t i = 0; i < bucket.size(); ++i) {
+      (*slots)[placed[i]] = bucket[i];
+    }
+  }
+
+  return true;
+}
+
 }  // namespace hash
 }  // namespace ofp
 
@@ -75,6 +75,7 @@ class Message {
   void setTime(const Timestamp &time) { time_ = time; }
   // N.B. This does not set multipart flags...
   void setMsgFlags(OFPMessageFlags msgFlags) { msgFlags_ = msgFlags; }
+  void setDuplicates(UInt32 duplicates) { duplicates_ = duplicates; }
 
   const UInt8 *data() const { return buf_.data(); }
   size_t size() const { return buf_.size(); }
@@ -87,6 +88,7 @@ class Message {
   OFPMultipartFlags multipartFlags() const;
   OFPMessageFlags msgFlags() const { return msgFlags_ | multipartFlags(); }
   Channel *source() const { return channel_; }
+  UInt32 duplicates() const { return duplicates_; }
   UInt32 xid() const { return header()->xid(); }
   UInt8 version() const { return header()->version(); }
   bool isRequestType() const;
@@ -110,6 +112,10 @@ class Message {
   MessageInfo *info_ = nullptr;
   OFPMessageFlags msgFlags_ = OFP_DEFAULT_MESSAGE_FLAGS;
 
+  // Number of duplicate messages suppressed before this one by the filter
+  // table (see rpc::DedupCache).
+  UInt32 duplicates_ = 0;
+
   // Used by the ProtocolMsg::cast(message) operator.
   template <class MsgType>
   const MsgType *castMessage(OFPErrorCode *error) const;
@@ -63,6 +63,8 @@ class MPFlowStatsReply {
   friend class MPFlowStatsReplyBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(MPFlowStatsReply) == 56, "Unexpected size.");
@@ -47,6 +47,8 @@ class MPPortStats {
   friend class MPPortStatsBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(MPPortStats) == 80, "Unexpected size.");
@@ -31,6 +31,8 @@ class MPQueueStats {
   friend class MPQueueStatsBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(MPQueueStats) == 40, "Unexpected size.");
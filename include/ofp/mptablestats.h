@@ -43,6 +43,8 @@ class MPTableStats {
   friend class MPTableStatsBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(MPTableStats) == 64, "Unexpected size.");
@@ -67,6 +67,9 @@ class OXMType {
   OXMInternalID internalID_IgnoreLength() const;
   OXMInternalID internalID_Experimenter(Big32 experimenter) const;
 
+  /// \returns Internal ID for OXM field `name`, or OXMInternalID::UNKNOWN.
+  static OXMInternalID internalIDFromName(llvm::StringRef name);
+
   bool parse(llvm::StringRef s);
   std::string toString() const { return detail::ToString(*this); }
 
@@ -65,6 +65,8 @@ class PacketIn
   friend class PacketInBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(PacketIn) == 32, "Unexpected size.");
@@ -60,6 +60,8 @@ class Port {
 
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(Port) == 40, "Unexpected size.");
@@ -29,6 +29,8 @@ class PortStatsPropertyEthernet : private NonCopyable {
   friend class MPPortStatsBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(PortStatsPropertyEthernet) == 40, "Unexpected size.");
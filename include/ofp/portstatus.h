@@ -28,6 +28,8 @@ class PortStatus : public ProtocolMsg<PortStatus, OFPT_PORT_STATUS, 56> {
   friend class PortStatusBuilder;
   template <class T>
   friend struct llvm::yaml::MappingTraits;
+  template <class T>
+  friend struct llvm::yaml::JsonTraits;
 };
 
 static_assert(sizeof(PortStatus) == 16, "Unexpected size.");
@@ -0,0 +1,49 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_ARPTABLE_H_
+#define OFP_RPC_ARPTABLE_H_
+
+#include <unordered_map>
+
+#include "ofp/ipv4address.h"
+#include "ofp/macaddress.h"
+
+namespace ofp {
+namespace rpc {
+
+/// Concrete class that maps IPv4 addresses to MAC addresses. The table is
+/// loaded by the controller (OFP.SET_ARP_TABLE) and used by the ARP_REPLY
+/// filter action to answer ARP requests without escalating them.
+
+class ArpTable {
+ public:
+  ArpTable() = default;
+
+  size_t size() const { return table_.size(); }
+  void clear() { table_.clear(); }
+
+  void set(const IPv4Address &ip, const MacAddress &mac) { table_[ip] = mac; }
+  void remove(const IPv4Address &ip) { table_.erase(ip); }
+
+  /// Look up the MAC address for `ip`. Return false if there is no entry.
+  bool lookup(const IPv4Address &ip, MacAddress *mac) const {
+    auto iter = table_.find(ip);
+    if (iter == table_.end()) {
+      return false;
+    }
+    *mac = iter->second;
+    return true;
+  }
+
+ private:
+  std::unordered_map<IPv4Address, MacAddress> table_;
+
+  ArpTable(const ArpTable &) = delete;
+  ArpTable &operator=(const ArpTable &) = delete;
+};
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_ARPTABLE_H_
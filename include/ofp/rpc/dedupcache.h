@@ -0,0 +1,78 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_DEDUPCACHE_H_
+#define OFP_RPC_DEDUPCACHE_H_
+
+#include <unordered_map>
+
+#include "ofp/byterange.h"
+#include "ofp/datapathid.h"
+#include "ofp/portnumber.h"
+#include "ofp/rpc/ratelimiter.h"
+
+namespace ofp {
+namespace rpc {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Concrete class that suppresses duplicate packets within a time window.
+///
+/// Packets are keyed on their flow tuple (datapath, in_port, ethernet, vlan,
+/// IP and transport addresses). Each key has its own RateLimiter, so a limit
+/// of "1/0.5" escalates one packet per flow every half second. The number of
+/// suppressed packets is reported with the next packet that is escalated.
+
+class DedupCache {
+ public:
+  DedupCache() : limiter_{true} {}
+
+  bool enabled() const { return enabled_; }
+  const RateLimiter &limiter() const { return limiter_; }
+  size_t size() const { return cache_.size(); }
+
+  void setLimiter(const RateLimiter &limiter) {
+    limiter_ = limiter;
+    enabled_ = true;
+    cache_.clear();
+    allowed_ = nullptr;
+  }
+
+  /// Return true if the packet is allowed. When allowed, `suppressed` is set
+  /// to the number of duplicates suppressed since the last escalated packet.
+  bool allow(const DatapathID &dpid, PortNumber inPort, ByteRange enetFrame,
+             Timestamp time, UInt32 *suppressed);
+
+  /// Reset the suppressed count of the flow of the packet just allowed. Call
+  /// this only if the packet was actually escalated; if a later limit denies
+  /// it, the count carries over to the next packet.
+  void escalated();
+
+  /// Build the flow tuple key for a packet.
+  static void makeKey(const DatapathID &dpid, PortNumber inPort,
+                      ByteRange enetFrame, std::string *key);
+
+ private:
+  struct Entry {
+    explicit Entry(const RateLimiter &limiter) : limiter{limiter} {}
+
+    RateLimiter limiter;
+    Timestamp lastSeen;
+    UInt32 suppressed = 0;
+  };
+
+  std::unordered_map<std::string, Entry> cache_;
+  std::string key_;
+  Entry *allowed_ = nullptr;
+  RateLimiter limiter_;
+  bool enabled_ = false;
+
+  void expire(Timestamp time);
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_DEDUPCACHE_H_
@@ -14,14 +14,21 @@ class Message;
 
 namespace rpc {
 
+class FilterTable;
+
 class FilterAction {
  public:
-  enum Type { NONE, GENERIC_REPLY };
+  enum Type { NONE, GENERIC_REPLY, ARP_REPLY };
 
   virtual ~FilterAction() {}
 
   virtual bool apply(ByteRange enetFrame, PortNumber inPort, UInt64 metadata,
                      Message *message) = 0;
+
+  /// Called when the action's entry is installed in a filter table. Actions
+  /// that use state shared across the table (e.g. the ARP table) bind to it
+  /// here.
+  virtual void attach(FilterTable *table) {}
 };
 
 }  // namespace rpc
@@ -35,6 +42,7 @@ struct ScalarEnumerationTraits<ofp::rpc::FilterAction::Type> {
   static void enumeration(IO &io, ofp::rpc::FilterAction::Type &value) {
     io.enumCase(value, "NONE", ofp::rpc::FilterAction::NONE);
     io.enumCase(value, "GENERIC_REPLY", ofp::rpc::FilterAction::GENERIC_REPLY);
+    io.enumCase(value, "ARP_REPLY", ofp::rpc::FilterAction::ARP_REPLY);
   }
 };
 
@@ -0,0 +1,43 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_FILTERACTIONARPREPLY_H_
+#define OFP_RPC_FILTERACTIONARPREPLY_H_
+
+#include "ofp/oxmrange.h"
+#include "ofp/rpc/arptable.h"
+#include "ofp/rpc/filteraction.h"
+
+namespace ofp {
+namespace rpc {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Filter action that answers ARP requests for addresses in an ArpTable. The
+/// reply is sent as a PacketOut to the port the request arrived on. Requests
+/// for addresses not in the table do not match.
+
+class FilterActionArpReply : public FilterAction {
+ public:
+  explicit FilterActionArpReply(const ArpTable *arpTable = nullptr)
+      : arpTable_{arpTable} {}
+
+  bool apply(ByteRange enetFrame, PortNumber inPort, UInt64 metadata,
+             Message *message) override;
+
+  void attach(FilterTable *table) override;
+
+ private:
+  const ArpTable *arpTable_;
+
+  bool buildReply(OXMRange oxm, const MacAddress &mac, ByteList *reply);
+  void sendPacketOut(const ByteList *data, PortNumber outPort,
+                     Message *message);
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_FILTERACTIONARPREPLY_H_
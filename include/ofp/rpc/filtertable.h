@@ -6,6 +6,7 @@
 
 #include <vector>
 
+#include "ofp/rpc/arptable.h"
 #include "ofp/rpc/filtertableentry.h"
 
 namespace ofp {
@@ -23,13 +24,18 @@ class FilterTable {
   bool apply(Message *message, bool *escalate);
 
   size_t size() const { return table_.size(); }
+  const std::vector<FilterTableEntry> &entries() const { return table_; }
 
-  void setFilters(std::vector<FilterTableEntry> &&filters) {
-    table_ = std::move(filters);
-  }
+  void setFilters(std::vector<FilterTableEntry> &&filters);
+
+  /// IP to MAC address table used by ARP_REPLY actions.
+  ArpTable &arpTable() { return arpTable_; }
+  const ArpTable &arpTable() const { return arpTable_; }
 
  private:
   std::vector<FilterTableEntry> table_;
+  demux::PktFilterSet filterSet_;
+  ArpTable arpTable_;
 
   FilterTable(const FilterTable &) = delete;
   FilterTable &operator=(const FilterTable &) = delete;
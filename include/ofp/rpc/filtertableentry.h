@@ -6,8 +6,10 @@
 
 #include "ofp/demux/pktfilter.h"
 #include "ofp/portnumber.h"
+#include "ofp/rpc/dedupcache.h"
 #include "ofp/rpc/filteraction.h"
 #include "ofp/rpc/ratelimiter.h"
+#include "ofp/rpc/tokenbucket.h"
 
 namespace ofp {
 
@@ -35,13 +37,46 @@ class FilterTableEntry {
 
   void setEscalate(const RateLimiter &limiter) { escalate_ = limiter; }
 
+  /// Suppress duplicate packets per flow before escalating.
+  void setDedup(const RateLimiter &limiter) { dedup_.setLimiter(limiter); }
+
+  /// Limit escalation using a token bucket for each datapath (or each in_port
+  /// on a datapath, if `perPort` is true).
+  void setLimit(double rate, UInt32 burst, bool perPort) {
+    limit_.setLimit(rate, burst, perPort);
+  }
+
+  /// Token buckets used to limit escalation, with their drop counters.
+  const TokenBucketMap &limit() const { return limit_; }
+
+  /// Bind the action to the filter table that owns this entry.
+  void attach(FilterTable *table) {
+    if (action_) {
+      action_->attach(table);
+    }
+  }
+
   bool apply(ByteRange data, PortNumber inPort, UInt64 metadata,
              Message *message, bool *escalate);
 
+  /// Apply the action to a message that already matches the filter.
+  bool applyAction(ByteRange data, PortNumber inPort, UInt64 metadata,
+                   Message *message, bool *escalate);
+
+  const demux::PktFilter &filter() const { return pktFilter_; }
+
+  /// Number of messages that matched this entry.
+  UInt64 hits() const { return hits_; }
+
  private:
   demux::PktFilter pktFilter_;
   std::unique_ptr<FilterAction> action_;
   RateLimiter escalate_;
+  DedupCache dedup_;
+  TokenBucketMap limit_;
+  UInt64 hits_ = 0;
+
+  bool allowEscalate(ByteRange data, PortNumber inPort, Message *message);
 };
 
 OFP_END_IGNORE_PADDING
@@ -0,0 +1,76 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_MESSAGETEMPLATE_H_
+#define OFP_RPC_MESSAGETEMPLATE_H_
+
+#include <vector>
+
+#include "ofp/bytelist.h"
+
+namespace ofp {
+namespace rpc {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Represents a named slot in a message template, with its sample value.
+struct TemplateSlot {
+  std::string name;
+  std::string value;
+};
+
+/// Represents an OpenFlow message that is encoded once, then sent many times
+/// with different values substituted into its slots.
+///
+/// The template is a YAML message where each slot is written as `$name`. To
+/// compile a template, we encode the message using the sample value for each
+/// slot. Then we encode it again with probe values in one slot at a time to
+/// find the byte offsets where that slot is stored. Finally, we check that
+/// each slot is stored exactly as its value. A slot must be a fixed size
+/// integer, MAC address or IP address field that the encoder does not
+/// transform. Its value may appear more than once in the message.
+class MessageTemplate {
+ public:
+  enum class SlotType : UInt8 { Integer, MacAddress, IPv4Address, IPv6Address };
+
+  /// Compile the template `text`. Return an error message if the template is
+  /// invalid, or an empty string on success.
+  std::string compile(const std::string &text,
+                      const std::vector<TemplateSlot> &slots);
+
+  UInt8 version() const;
+  size_t size() const { return data_.size(); }
+  size_t slotCount() const { return slots_.size(); }
+
+  /// Copy the message into `msg`, substituting the slot `values` in the same
+  /// order that slots were passed to `compile`. Missing values at the end use
+  /// the sample value. Return an error message if a value is invalid.
+  std::string instantiate(const std::vector<std::string> &values, UInt32 xid,
+                          ByteList *msg) const;
+
+ private:
+  struct Slot {
+    std::string name;
+    std::vector<UInt16> offsets;
+    SlotType type;
+    UInt8 size;
+  };
+
+  ByteList data_;
+  std::vector<Slot> slots_;
+
+  bool findSlot(const std::string &text, const std::vector<TemplateSlot> &slots,
+                size_t index, Slot *slot) const;
+  bool verifySlot(const std::string &text,
+                  const std::vector<TemplateSlot> &slots, size_t index,
+                  const Slot &slot) const;
+  static bool parseValue(const Slot &slot, const std::string &value,
+                         UInt8 *buf);
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_MESSAGETEMPLATE_H_
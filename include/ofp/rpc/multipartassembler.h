@@ -0,0 +1,105 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_MULTIPARTASSEMBLER_H_
+#define OFP_RPC_MULTIPARTASSEMBLER_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "ofp/rpc/rpcevents.h"
+#include "ofp/types.h"
+
+namespace ofp {
+namespace rpc {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Reassembles multipart replies that are split across several messages
+/// (OFPMPF_REPLY_MORE) into a single `OFP.MESSAGE` event.
+///
+/// Fragments are buffered as decoded JSON, keyed by connection and xid. Only
+/// replies whose body is a list are reassembled. The merged event uses the
+/// attributes of the last fragment and the concatenated bodies of all the
+/// fragments.
+///
+/// The total size of buffered JSON is limited, and so is the size of each
+/// merged event. When a fragment doesn't fit, or a reply is not complete
+/// before the timeout, the buffered fragments are flushed as a partial reply.
+/// A partial reply still has the MORE flag set.
+class MultipartAssembler {
+ public:
+  explicit MultipartAssembler(size_t limit = 0, Milliseconds timeout = 0_ms,
+                              size_t maxEventSize = RPC_MAX_MESSAGE_SIZE)
+      : limit_{limit}, maxEventSize_{maxEventSize}, timeout_{timeout} {}
+
+  bool enabled() const { return limit_ > 0; }
+  Milliseconds timeout() const { return timeout_; }
+
+  /// Number of partial replies being reassembled.
+  size_t pending() const { return entries_.size(); }
+
+  /// Number of bytes of JSON being buffered.
+  size_t bufferedBytes() const { return bytes_; }
+
+  /// Add the decoded JSON `event` for a multipart reply. Events that are ready
+  /// to send are appended to `events`. Return false if `event` is not
+  /// reassembled; the caller should send it unchanged (after `events`).
+  bool add(UInt64 connId, UInt32 xid, bool more, llvm::StringRef event,
+           TimePoint now, std::vector<std::string> *events);
+
+  /// Flush partial replies that have timed out.
+  void expire(TimePoint now, std::vector<std::string> *events);
+
+  /// Flush all partial replies from the connection `connId`.
+  void flush(UInt64 connId, std::vector<std::string> *events);
+
+  /// Return the time when the oldest partial reply times out.
+  TimePoint nextExpiry() const;
+
+ private:
+  struct Key {
+    UInt64 connId;
+    UInt32 xid;
+
+    bool operator==(const Key &rhs) const {
+      return connId == rhs.connId && xid == rhs.xid;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      return std::hash<UInt64>{}(key.connId ^ (UInt64{key.xid} << 32));
+    }
+  };
+
+  struct Entry {
+    // JSON of the first fragment, up to and including `"msg":[`.
+    std::string prefix;
+    // Comma-separated list elements from all fragments.
+    std::string body;
+    TimePoint started;
+
+    size_t size() const { return prefix.size() + body.size(); }
+  };
+
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  size_t limit_;
+  size_t maxEventSize_;
+  size_t bytes_ = 0;
+  Milliseconds timeout_;
+
+  void start(Entry *entry, llvm::StringRef prefix, llvm::StringRef body,
+             TimePoint now);
+  void flushEntry(Entry *entry, std::vector<std::string> *events);
+
+  static bool splitEvent(llvm::StringRef event, llvm::StringRef *prefix,
+                         llvm::StringRef *body);
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_MULTIPARTASSEMBLER_H_
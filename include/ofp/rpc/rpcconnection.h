@@ -5,8 +5,12 @@
 #define OFP_RPC_RPCCONNECTION_H_
 
 #include "ofp/bytelist.h"
+#include "ofp/rpc/multipartassembler.h"
+#include "ofp/rpc/rpclinebuffer.h"
 #include "ofp/rpc/rpcserver.h"
 #include "ofp/timestamp.h"
+#include "ofp/yaml/decoder.h"
+#include "ofp/yaml/inputjson.h"
 #include "ofp/yaml/yllvm.h"
 
 namespace ofp {
@@ -17,12 +21,13 @@ struct RpcOpenResponse;
 struct RpcClose;
 struct RpcSend;
 struct RpcErrorResponse;
+struct RpcEventMetrics;
 
 OFP_BEGIN_IGNORE_PADDING
 
 class RpcConnection : public std::enable_shared_from_this<RpcConnection> {
  public:
-  explicit RpcConnection(RpcServer *server);
+  RpcConnection(RpcServer *server, bool binaryProtocol);
   virtual ~RpcConnection();
 
   virtual void asyncAccept() = 0;
@@ -36,6 +41,10 @@ class RpcConnection : public std::enable_shared_from_this<RpcConnection> {
   void onRpcAddIdentity(RpcAddIdentity *add);
   void onRpcDescription(RpcDescription *desc);
   void onRpcSetFilter(RpcSetFilter *set);
+  void onRpcAddTemplate(RpcAddTemplate *add);
+  void onRpcSendTemplate(RpcSendTemplate *send);
+  void onRpcMetrics(RpcMetrics *metrics);
+  void onRpcSetArpTable(RpcSetArpTable *set);
 
   template <class Response>
   void rpcReply(Response *response) {
@@ -52,7 +61,12 @@ class RpcConnection : public std::enable_shared_from_this<RpcConnection> {
                 const std::string &alert, const ByteRange &data,
                 const Timestamp &time, UInt32 xid = 0);
 
-  void handleEvent(const std::string &eventText);
+  void handleEvent(llvm::StringRef eventText);
+
+  /// Write byte fields in OFP.MESSAGE events as base64 instead of hex.
+  void setBase64Bytes(bool base64) { decoder_.setBase64Bytes(base64); }
+
+  void collectMetrics(RpcEventMetrics *metrics) const;
 
  protected:
   RpcServer *server_;
@@ -60,15 +74,77 @@ class RpcConnection : public std::enable_shared_from_this<RpcConnection> {
   UInt32 rxEvents_ = 0;
   UInt64 txBytes_ = 0;
   UInt64 rxBytes_ = 0;
+  UInt64 droppedEvents_ = 0;
+  UInt64 decodeErrors_ = 0;
+  size_t maxOutgoingSize_ = 0;
   asio::steady_timer metricTimer_;
-
-  virtual void writeEvent(llvm::StringRef msg, bool ofp_message = false) = 0;
+  asio::steady_timer multipartTimer_;
+  MultipartAssembler multipart_;
+  bool multipartTimerActive_ = false;
+
+  // Decoder for OFP.MESSAGE events; it writes directly to the output buffer.
+  // useJson = true, pktMatch = true
+  yaml::Decoder decoder_{true, true};
+
+  // JSON reader for RPC requests; it keeps its memory between requests.
+  yaml::InputJson parser_;
+
+  // Use a two buffer strategy for async-writes. We queue up data in one
+  // buffer while we're in the process of writing the other buffer.
+  ByteList outgoing_[2];
+  int outgoingIdx_ = 0;
+  bool writing_ = false;
+  bool binaryProtocol_ = false;
+  bool outputClosed_ = false;
+
+  // Text protocol input is read into one contiguous buffer. Each complete
+  // line is passed to `handleEvent` as a view into this buffer.
+  RpcLineBuffer lineBuffer_;
+
+  asio::mutable_buffer inputSpace();
+  bool inputReceived(size_t bytesRead);
+  size_t inputPending() const { return lineBuffer_.pending(); }
+
+  void writeEvent(llvm::StringRef msg, bool ofp_message = false,
+                  bool droppable = false);
+  bool writeMessageEvent(const Message *message, bool droppable);
+  size_t beginEvent();
+  void endEvent(size_t start, bool droppable);
+
+  void asyncWrite();
+  void asyncWriteCompleted(size_t bytesWritten);
+
+  /// Write the data to the underlying transport. When the write finishes,
+  /// the subclass must call `asyncWriteCompleted`.
+  virtual void asyncWriteData(const UInt8 *data, size_t size) = 0;
 
   void rpcRequestInvalid(llvm::StringRef errorMsg);
 
   void asyncMetrics(Milliseconds interval);
   void logMetrics();
-  virtual size_t outgoingBufferSize() const = 0;
+
+  size_t outgoingBufferSize() const {
+    return outgoing_[0].size() + outgoing_[1].size();
+  }
+
+ private:
+  // Size of each event in the pending output buffer, used to drop events
+  // when the output queue overflows (RpcOverflowPolicy::DROP only).
+  struct PendingEvent {
+    UInt32 size;
+    bool droppable;
+  };
+  std::vector<PendingEvent> pending_;
+  UInt32 unreportedDrops_ = 0;
+
+  void onMultipartReply(Channel *channel, const Message *message,
+                        llvm::StringRef event);
+  void writeMultipartEvents(const std::vector<std::string> &events);
+  void asyncMultipartExpire();
+
+  bool handleOverflow(size_t eventSize, bool droppable);
+  bool dropPendingEvents(size_t eventSize);
+  void reportDroppedEvents();
 };
 
 OFP_END_IGNORE_PADDING
@@ -0,0 +1,116 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_RPCCONNECTIONSHM_H_
+#define OFP_RPC_RPCCONNECTIONSHM_H_
+
+#include <atomic>
+
+#include "ofp/rpc/rpcconnection.h"
+#include "ofp/rpc/rpcshmring.h"
+#include "ofp/sys/asio_utils.h"
+
+// The shared memory transport depends on memfd_create and eventfd (Linux).
+#if HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H
+
+namespace ofp {
+namespace rpc {
+
+/// Magic number at the start of the shared memory region ("OFRS").
+const UInt32 RPC_SHM_MAGIC = 0x5352464F;
+const UInt32 RPC_SHM_VERSION = 1;
+
+/// Size of each ring's data area. Must be a power of 2, and large enough to
+/// hold the largest framed message.
+const size_t RPC_SHM_RING_SIZE = 4 * 1048576;
+
+/// Offset of the first ring's data area from the start of the region. The
+/// second ring's data area follows immediately after the first.
+const size_t RPC_SHM_DATA_OFFSET = 4096;
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Header at the start of the shared memory region used by RpcConnectionShm.
+///
+/// The region contains two single-producer/single-consumer byte rings:
+///
+///   tx:  oftr --> controller (replies and notifications)
+///   rx:  controller --> oftr (requests)
+///
+/// Each ring carries the same framed events as the binary protocol. See
+/// RpcShmRing for how `head` and `tail` are used. A frame may wrap around the
+/// end of a ring's data area.
+///
+/// After advancing `txHead` or `rxTail`, oftr writes to the controller's
+/// eventfd. After advancing `rxHead` or `txTail`, the controller writes to
+/// oftr's eventfd.
+struct RpcShmHeader {
+  UInt32 magic;
+  UInt32 version;
+  UInt64 ringSize;
+  alignas(64) std::atomic<UInt64> txHead;
+  alignas(64) std::atomic<UInt64> txTail;
+  alignas(64) std::atomic<UInt64> rxHead;
+  alignas(64) std::atomic<UInt64> rxTail;
+};
+
+static_assert(sizeof(RpcShmHeader) <= RPC_SHM_DATA_OFFSET,
+              "Unexpected header size");
+static_assert((RPC_SHM_RING_SIZE & (RPC_SHM_RING_SIZE - 1)) == 0,
+              "Ring size must be a power of 2");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Atomic UInt64 must be lock-free");
+
+/// Implements an RPC connection over a shared memory region.
+///
+/// The controller connects to a unix domain socket. oftr replies with a
+/// single message containing the region size (UInt64) and three descriptors
+/// (SCM_RIGHTS): the memfd for the region, oftr's eventfd and the controller's
+/// eventfd. The socket stays open; when the controller closes it, the
+/// connection is closed.
+class RpcConnectionShm final : public RpcConnection {
+ public:
+  RpcConnectionShm(RpcServer *server, sys::unix_domain::socket socket);
+  ~RpcConnectionShm();
+
+  void asyncAccept() override;
+  void close() override;
+
+ protected:
+  void asyncWriteData(const UInt8 *data, size_t size) override;
+
+ private:
+  sys::unix_domain::socket sock_;
+  asio::posix::stream_descriptor wakeup_;
+  asio::posix::stream_descriptor notify_;
+  RpcShmHeader *header_ = nullptr;
+  RpcShmRing tx_;
+  RpcShmRing rx_;
+  size_t regionSize_ = 0;
+  UInt64 wakeupCount_ = 0;
+  UInt8 sockByte_ = 0;
+  std::string eventBuf_;
+
+  // Output that has not been copied into the tx ring yet.
+  const UInt8 *writeData_ = nullptr;
+  size_t writeSize_ = 0;
+  size_t writeDone_ = 0;
+
+  std::error_code setUp();
+  std::error_code sendDescriptors(int memfd);
+
+  void asyncWaitWakeup();
+  void asyncWaitClosed();
+
+  bool readRequests();
+  void writePending();
+  void notifyController();
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H
+
+#endif  // OFP_RPC_RPCCONNECTIONSHM_H_
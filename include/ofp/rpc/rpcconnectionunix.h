@@ -21,30 +21,16 @@ class RpcConnectionUnix final : public RpcConnection {
   void close() override;
 
  protected:
-  void writeEvent(llvm::StringRef msg, bool ofp_message = false) override;
+  void asyncWriteData(const UInt8 *data, size_t size) override;
 
  private:
   sys::unix_domain::socket sock_;
-  asio::streambuf streambuf_;
   Big32 hdrBuf_;
   std::string eventBuf_;
 
-  // Use a two buffer strategy for async-writes. We queue up data in one
-  // buffer while we're in the process of writing the other buffer.
-  ByteList outgoing_[2];
-  int outgoingIdx_ = 0;
-  bool writing_ = false;
-  bool binaryProtocol_ = false;
-
   void asyncReadLine();
   void asyncReadHeader();
   void asyncReadMessage(size_t msgLength);
-
-  void asyncWrite();
-
-  size_t outgoingBufferSize() const override {
-    return outgoing_[0].size() + outgoing_[1].size();
-  }
 };
 
 OFP_END_IGNORE_PADDING
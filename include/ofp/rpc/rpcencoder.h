@@ -21,8 +21,11 @@ OFP_BEGIN_IGNORE_PADDING
 
 class RpcEncoder {
  public:
-  explicit RpcEncoder(const std::string &input, RpcConnection *conn,
-                      yaml::Encoder::ChannelFinder finder);
+  /// Parse `input` and pass the request to `conn`. If `parser` is not null,
+  /// it's reused to read strict JSON input.
+  explicit RpcEncoder(llvm::StringRef input, RpcConnection *conn,
+                      yaml::Encoder::ChannelFinder finder,
+                      yaml::InputJson *parser = nullptr);
 
   const std::string &error() {
     errorStream_.str();
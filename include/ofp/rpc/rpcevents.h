@@ -7,8 +7,10 @@
 #include "ofp/datapathid.h"
 #include "ofp/driver.h"
 #include "ofp/padding.h"
+#include "ofp/rpc/filteractionarpreply.h"
 #include "ofp/rpc/filteractiongenericreply.h"
 #include "ofp/rpc/filtertableentry.h"
+#include "ofp/rpc/messagetemplate.h"
 #include "ofp/rpc/rpcid.h"
 #include "ofp/yaml/encoder.h"
 
@@ -27,17 +29,24 @@ const char RPC_EVENT_DELIMITER_CHAR = '\x00';
 /// RPC event tag byte (in the binary protocol).
 const UInt8 RPC_EVENT_BINARY_TAG = 0xF5;
 
+/// Maximum number of message templates (OFP.ADD_TEMPLATE).
+const size_t RPC_MAX_TEMPLATES = 4096;
+
 /// RPC Methods
 enum RpcMethod : UInt32 {
-  METHOD_LISTEN = 0,    // OFP.LISTEN
-  METHOD_CONNECT,       // OFP.CONNECT
-  METHOD_CLOSE,         // OFP.CLOSE
-  METHOD_SEND,          // OFP.SEND
-  METHOD_MESSAGE,       // OFP.MESSAGE
-  METHOD_LIST_CONNS,    // OFP.LIST_CONNECTIONS
-  METHOD_ADD_IDENTITY,  // OFP.ADD_IDENTITY
-  METHOD_DESCRIPTION,   // OFP.DESCRIPTION
-  METHOD_SET_FILTER,    // OFP.SET_FILTER
+  METHOD_LISTEN = 0,     // OFP.LISTEN
+  METHOD_CONNECT,        // OFP.CONNECT
+  METHOD_CLOSE,          // OFP.CLOSE
+  METHOD_SEND,           // OFP.SEND
+  METHOD_MESSAGE,        // OFP.MESSAGE
+  METHOD_LIST_CONNS,     // OFP.LIST_CONNECTIONS
+  METHOD_ADD_IDENTITY,   // OFP.ADD_IDENTITY
+  METHOD_DESCRIPTION,    // OFP.DESCRIPTION
+  METHOD_SET_FILTER,     // OFP.SET_FILTER
+  METHOD_ADD_TEMPLATE,   // OFP.ADD_TEMPLATE
+  METHOD_SEND_TEMPLATE,  // OFP.SEND_TEMPLATE
+  METHOD_METRICS,        // OFP.METRICS
+  METHOD_SET_ARP_TABLE,  // OFP.SET_ARP_TABLE
   METHOD_UNSUPPORTED
 };
 
@@ -48,6 +57,7 @@ enum RpcErrorCode {
   ERROR_CODE_CONNECTION_NOT_FOUND = -65000,
   ERROR_CODE_TLS_ID_NOT_FOUND = -65001,
   ERROR_CODE_INVALID_OPTIONS = -65002,
+  ERROR_CODE_TEMPLATE_NOT_FOUND = -65003,
 };
 
 OFP_BEGIN_IGNORE_PADDING
@@ -80,7 +90,11 @@ struct RpcConnectionStats {
 struct RpcDescription {
   explicit RpcDescription(RpcID ident) : id{ident} {}
 
-  struct Params {};
+  struct Params {
+    /// If present, write byte fields in this connection's OFP.MESSAGE events
+    /// as base64 (true) or hexadecimal (false).
+    llvm::Optional<bool> base64;
+  };
 
   RpcID id;
   Params params;
@@ -305,6 +319,174 @@ struct RpcSetFilterResponse {
   Result result;
 };
 
+/// Represents a RPC request to add a message template (METHOD_ADD_TEMPLATE).
+struct RpcAddTemplate {
+  explicit RpcAddTemplate(RpcID ident) : id{ident} {}
+
+  struct Params {
+    /// YAML message with `$name` slots.
+    std::string message;
+    /// List of slots with sample values.
+    std::vector<TemplateSlot> slots;
+    /// If non-zero, replace this existing template.
+    UInt32 templateId = 0;
+  };
+
+  RpcID id;
+  Params params;
+};
+
+/// Represents a RPC response to add a message template (METHOD_ADD_TEMPLATE).
+struct RpcAddTemplateResponse {
+  explicit RpcAddTemplateResponse(RpcID ident) : id{ident} {}
+  std::string toJson();
+
+  struct Result {
+    /// Template ID of template added.
+    UInt32 templateId = 0;
+  };
+
+  RpcID id;
+  Result result;
+};
+
+/// Represents a RPC request to send a message template to a datapath
+/// (METHOD_SEND_TEMPLATE). The response is a RpcSendResponse.
+struct RpcSendTemplate {
+  explicit RpcSendTemplate(RpcID ident) : id{ident} {}
+
+  struct Params {
+    /// Template ID to send.
+    UInt32 templateId = 0;
+    /// Connection ID to send to.
+    UInt64 connId = 0;
+    /// DatapathID to send to.
+    DatapathID datapathId;
+    /// Transaction ID of message. If missing, the channel assigns one.
+    llvm::Optional<UInt32> xid;
+    /// Slot values, in the same order as the template's slots.
+    std::vector<std::string> values;
+  };
+
+  RpcID id;
+  Params params;
+};
+
+/// Represents the `limit` attribute of a filter table entry in an
+/// ofp.set_filter request.
+struct FilterEscalateLimit {
+  /// Escalated packets per second.
+  double rate = 0;
+  /// Maximum burst of escalated packets.
+  UInt32 burst = 0;
+  /// If true, each in_port on a datapath has its own bucket.
+  bool perPort = false;
+};
+
+/// Represents an entry in an ofp.set_arp_table request.
+struct ArpTableEntry {
+  IPv4Address ip;
+  MacAddress mac;
+};
+
+/// Represents a RPC request to update the ARP table used by ARP_REPLY filter
+/// actions (METHOD_SET_ARP_TABLE).
+struct RpcSetArpTable {
+  explicit RpcSetArpTable(RpcID ident) : id{ident} {}
+
+  struct Params {
+    /// If true, replace the entire table; otherwise, update it in place.
+    bool replace = false;
+    /// Entries to add or update.
+    std::vector<ArpTableEntry> entries;
+    /// Addresses to remove.
+    std::vector<IPv4Address> remove;
+  };
+
+  RpcID id;
+  Params params;
+};
+
+/// Represents a RPC response to update the ARP table (METHOD_SET_ARP_TABLE).
+struct RpcSetArpTableResponse {
+  explicit RpcSetArpTableResponse(RpcID ident) : id{ident} {}
+  std::string toJson();
+
+  struct Result {
+    /// Number of entries in the ARP table.
+    UInt32 count = 0;
+  };
+
+  RpcID id;
+  Result result;
+};
+
+/// Represents the RPC connection counters in a ofp.metrics result.
+struct RpcEventMetrics {
+  UInt64 txEvents = 0;
+  UInt64 rxEvents = 0;
+  UInt64 txBytes = 0;
+  UInt64 rxBytes = 0;
+  UInt64 droppedEvents = 0;
+  UInt64 decodeErrors = 0;
+  UInt64 outputQueue = 0;
+  UInt64 maxOutputQueue = 0;
+};
+
+/// Represents an object in a ofp.metrics connection list.
+struct RpcChannelMetrics {
+  UInt64 connId = 0;
+  DatapathID datapathId;
+  UInt8 auxiliaryId = 0;
+  UInt64 rxMessages = 0;
+  UInt64 rxBytes = 0;
+  UInt64 txBytes = 0;
+};
+
+/// Represents an escalation token bucket in a ofp.metrics result.
+struct RpcFilterDrops {
+  UInt32 index = 0;
+  DatapathID datapathId;
+  PortNumber inPort;
+  UInt64 dropped = 0;
+};
+
+/// Represents a RPC request to report runtime metrics (METHOD_METRICS)
+struct RpcMetrics {
+  explicit RpcMetrics(RpcID ident) : id{ident} {}
+
+  struct Params {};
+
+  RpcID id;
+  Params params;
+};
+
+/// Represents a RPC response to report runtime metrics (METHOD_METRICS)
+struct RpcMetricsResponse {
+  explicit RpcMetricsResponse(RpcID ident) : id{ident} {}
+  std::string toJson();
+
+  /// Format the result in the Prometheus text exposition format.
+  std::string toPrometheus() const;
+
+  struct Result {
+    /// Counters for the RPC connection.
+    RpcEventMetrics rpc;
+    /// Counters for each OpenFlow connection.
+    std::vector<RpcChannelMetrics> connections;
+    /// Number of messages matched by each filter table entry.
+    std::vector<UInt64> filterHits;
+    /// Number of messages dropped by each escalation token bucket.
+    std::vector<RpcFilterDrops> filterDrops;
+    /// Most recent and maximum event loop lag (msec).
+    UInt64 loopLag = 0;
+    UInt64 maxLoopLag = 0;
+  };
+
+  RpcID id;
+  Result result;
+};
+
 /// Represents a RPC notification about a channel (METHOD_MESSAGE subtype)
 struct RpcChannel {
   std::string toJson();
@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_RPCLINEBUFFER_H_
+#define OFP_RPC_RPCLINEBUFFER_H_
+
+#include "ofp/bytelist.h"
+
+namespace ofp {
+namespace rpc {
+
+/// Frames delimited lines of text input in one contiguous buffer.
+///
+/// Input is read directly into the space returned by `prepare`. Each complete
+/// line is returned by `nextLine` as a view into the buffer, so lines are
+/// never copied. A partial line is moved to the front only when the buffer
+/// fills up. The buffer grows up to `maxLineSize + 1` bytes, so a line that is
+/// too long can be detected.
+class RpcLineBuffer {
+ public:
+  explicit RpcLineBuffer(size_t maxLineSize, char delimiter = '\n',
+                         size_t initialSize = 8192)
+      : maxLineSize_{maxLineSize},
+        initialSize_{initialSize},
+        delimiter_{delimiter} {}
+
+  /// Make room for more input. Return a pointer to the free space and set
+  /// `size` to the number of bytes available.
+  UInt8 *prepare(size_t *size);
+
+  /// Add `size` bytes that were read into the space from `prepare`.
+  void received(size_t size);
+
+  /// Return the next complete line, without its delimiter. Return false if
+  /// there are no more complete lines. A line stays valid until the next call
+  /// to `prepare`.
+  bool nextLine(llvm::StringRef *line);
+
+  /// Number of bytes received that are not part of a complete line yet.
+  size_t pending() const { return end_ - start_; }
+
+  /// Return true if the pending partial line is longer than `maxLineSize`.
+  bool overflow() const { return pending() > maxLineSize_; }
+
+  /// Current size of the buffer.
+  size_t capacity() const { return buf_.size(); }
+
+ private:
+  ByteList buf_;
+  size_t start_ = 0;  // offset of first unprocessed byte
+  size_t scan_ = 0;   // offset where delimiter search resumes
+  size_t end_ = 0;    // offset past last byte received
+  size_t maxLineSize_;
+  size_t initialSize_;
+  char delimiter_;
+};
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_RPCLINEBUFFER_H_
@@ -9,6 +9,7 @@
 #include "ofp/datapathid.h"
 #include "ofp/driver.h"
 #include "ofp/rpc/filtertable.h"
+#include "ofp/rpc/messagetemplate.h"
 #include "ofp/rpc/rpcid.h"
 #include "ofp/sys/asio_utils.h"
 
@@ -28,6 +29,18 @@ struct RpcListConns;
 struct RpcAddIdentity;
 struct RpcDescription;
 struct RpcSetFilter;
+struct RpcAddTemplate;
+struct RpcSendTemplate;
+struct RpcMetrics;
+struct RpcMetricsResponse;
+struct RpcSetArpTable;
+
+/// Policy applied when the RPC output queue exceeds its size limit.
+enum class RpcOverflowPolicy {
+  BLOCK,      // Stop reading from channels until the queue drains.
+  DROP,       // Drop queued PACKET_IN events, oldest first.
+  DISCONNECT  // Close the RPC connection.
+};
 
 OFP_BEGIN_IGNORE_PADDING
 
@@ -45,6 +58,37 @@ class RpcServer {
   std::error_code bind(int socketFD);
   std::error_code bind(const std::string &listenPath);
 
+  /// Bind RPC server to a shared memory transport. The controller connects
+  /// to the unix domain socket at `listenPath` to obtain the shared memory.
+  std::error_code bindSharedMemory(const std::string &listenPath);
+
+  /// Serve metrics in the Prometheus text format to each client that
+  /// connects to the unix domain socket at `listenPath`.
+  std::error_code bindMetrics(const std::string &listenPath);
+
+  /// Limit the size of the RPC output queue (0 means unlimited). When the
+  /// policy is BLOCK, reads resume after the queue drains to `lowWater` bytes
+  /// (0 means half the limit).
+  void setOutputLimit(size_t limit, RpcOverflowPolicy policy,
+                      size_t lowWater = 0) {
+    outputLimit_ = limit;
+    outputLowWater_ = lowWater > 0 ? std::min(lowWater, limit) : limit / 2;
+    overflowPolicy_ = policy;
+  }
+
+  /// Reassemble multipart replies using up to `limit` bytes of buffer space
+  /// (0 means disabled). Partial replies are flushed after `timeout`.
+  void setMultipartLimit(size_t limit, Milliseconds timeout) {
+    multipartLimit_ = limit;
+    multipartTimeout_ = timeout;
+  }
+
+  /// Write byte fields, like PacketIn's `data`, as base64 instead of
+  /// hexadecimal in OFP.MESSAGE events. This is the default for RPC
+  /// connections accepted after the call; a client can change it for its own
+  /// connection with OFP.DESCRIPTION.
+  void setBase64Bytes(bool base64) { base64Bytes_ = base64; }
+
   /// Run the rpc server.
   void run() { driver_.run(); }
 
@@ -63,6 +107,10 @@ class RpcServer {
   void onRpcAddIdentity(RpcConnection *conn, RpcAddIdentity *add);
   void onRpcDescription(RpcConnection *conn, RpcDescription *desc);
   void onRpcSetFilter(RpcConnection *conn, RpcSetFilter *set);
+  void onRpcAddTemplate(RpcConnection *conn, RpcAddTemplate *add);
+  void onRpcSendTemplate(RpcConnection *conn, RpcSendTemplate *send);
+  void onRpcMetrics(RpcConnection *conn, RpcMetrics *metrics);
+  void onRpcSetArpTable(RpcConnection *conn, RpcSetArpTable *set);
 
   // These methods are used to bridge RpcChannelListeners to RpcConnections.
   void onChannelUp(Channel *channel);
@@ -73,22 +121,45 @@ class RpcServer {
 
   sys::Engine *engine() const { return engine_; }
   Milliseconds metricInterval() const { return metricInterval_; }
+  size_t outputLimit() const { return outputLimit_; }
+  size_t outputLowWater() const { return outputLowWater_; }
+  RpcOverflowPolicy overflowPolicy() const { return overflowPolicy_; }
+  size_t multipartLimit() const { return multipartLimit_; }
+  Milliseconds multipartTimeout() const { return multipartTimeout_; }
+  bool base64Bytes() const { return base64Bytes_; }
 
  private:
   Driver driver_;
   sys::Engine *engine_;
   sys::unix_domain::acceptor acceptor_;
   sys::unix_domain::socket socket_;
+  sys::unix_domain::acceptor metricsAcceptor_;
+  sys::unix_domain::socket metricsSocket_;
   bool binaryProtocol_ = false;
+  bool sharedMemory_ = false;
   RpcConnection *oneConn_ = nullptr;
   Channel *defaultChannel_ = nullptr;
   Milliseconds metricInterval_ = 0_ms;
+  size_t outputLimit_ = 0;
+  size_t outputLowWater_ = 0;
+  RpcOverflowPolicy overflowPolicy_ = RpcOverflowPolicy::BLOCK;
+  size_t multipartLimit_ = 0;
+  Milliseconds multipartTimeout_ = 0_ms;
+  bool base64Bytes_ = false;
   FilterTable filter_;
+  std::vector<MessageTemplate> templates_;
+  ByteList templateBuf_;
 
+  std::error_code listen(sys::unix_domain::acceptor *acceptor,
+                         const std::string &listenPath);
   void asyncAccept();
+  void asyncAcceptMetrics();
+  void collectMetrics(RpcMetricsResponse *response);
 
   static void connectResponse(RpcConnection *conn, RpcID id, UInt64 connId,
                               const std::error_code &err);
+  static void sendTemplateError(RpcConnection *conn, RpcSendTemplate *send,
+                                int code, const std::string &message);
   static void alertCallback(Channel *channel, const std::string &alert,
                             const ByteRange &data, void *context);
   static std::string softwareVersion();
@@ -0,0 +1,66 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_RPCSHMRING_H_
+#define OFP_RPC_RPCSHMRING_H_
+
+#include <atomic>
+
+#include "ofp/types.h"
+
+namespace ofp {
+namespace rpc {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Accesses one single-producer/single-consumer byte ring in shared memory.
+///
+/// `head` and `tail` are running byte counts; the data for position `p` is at
+/// offset `p % size` in the data area. The producer calls `write`; the
+/// consumer calls `readable`, `peek`, `view` and `consume`. Data may wrap
+/// around the end of the data area.
+class RpcShmRing {
+ public:
+  RpcShmRing() = default;
+  RpcShmRing(UInt8 *data, size_t size, std::atomic<UInt64> *head,
+             std::atomic<UInt64> *tail)
+      : data_{data}, size_{size}, head_{head}, tail_{tail} {
+    assert((size & (size - 1)) == 0);
+  }
+
+  /// Number of bytes the consumer can read.
+  size_t readable() const;
+
+  /// Number of bytes the producer can write.
+  size_t writable() const;
+
+  /// Copy as much of `data` as will fit into the ring and advance `head`.
+  /// Return the number of bytes written.
+  size_t write(const UInt8 *data, size_t size);
+
+  /// Copy `size` readable bytes starting `offset` bytes past `tail`.
+  void peek(size_t offset, UInt8 *data, size_t size) const;
+
+  /// Return `size` readable bytes starting `offset` bytes past `tail`. The
+  /// data is returned in place unless it wraps around the end of the ring; in
+  /// that case, it is copied into `buf`.
+  llvm::StringRef view(size_t offset, size_t size, std::string *buf) const;
+
+  /// Advance `tail` past `size` bytes the consumer is done with.
+  void consume(size_t size);
+
+ private:
+  UInt8 *data_ = nullptr;
+  size_t size_ = 0;
+  std::atomic<UInt64> *head_ = nullptr;
+  std::atomic<UInt64> *tail_ = nullptr;
+
+  size_t mask() const { return size_ - 1; }
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_RPCSHMRING_H_
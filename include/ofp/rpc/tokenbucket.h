@@ -0,0 +1,149 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_RPC_TOKENBUCKET_H_
+#define OFP_RPC_TOKENBUCKET_H_
+
+#include <unordered_map>
+
+#include "ofp/datapathid.h"
+#include "ofp/log.h"
+#include "ofp/portnumber.h"
+#include "ofp/timestamp.h"
+
+namespace ofp {
+namespace rpc {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Concrete class that implements a token bucket. Tokens are added at `rate`
+/// per second, up to `burst` tokens. Each event allowed takes one token. The
+/// bucket starts full.
+
+class TokenBucket {
+ public:
+  explicit TokenBucket(double rate, UInt32 burst)
+      : rate_{rate}, burst_{burst}, tokens_{static_cast<double>(burst)} {}
+
+  bool allow(Timestamp t) {
+    if (t > last_) {
+      if (last_.valid()) {
+        tokens_ += rate_ * t.secondsSince(last_);
+        if (tokens_ > burst_) {
+          tokens_ = burst_;
+        }
+      }
+      last_ = t;
+    }
+
+    if (tokens_ >= 1.0) {
+      tokens_ -= 1.0;
+      return true;
+    }
+
+    ++dropped_;
+    return false;
+  }
+
+  /// Number of events denied.
+  UInt64 dropped() const { return dropped_; }
+
+  /// Return true if the bucket will be full again at time `t`. An idle bucket
+  /// behaves the same as a new one.
+  bool idle(Timestamp t) const {
+    return !last_.valid() || tokens_ + rate_ * t.secondsSince(last_) >= burst_;
+  }
+
+ private:
+  double rate_;
+  UInt32 burst_;
+  double tokens_;
+  Timestamp last_;
+  UInt64 dropped_ = 0;
+};
+
+/// Maximum number of buckets in a TokenBucketMap.
+const size_t kMaxTokenBuckets = 65536;
+
+/// Concrete class that keeps a separate TokenBucket for each datapath, and
+/// optionally for each in_port on a datapath.
+///
+/// At most `kMaxTokenBuckets` buckets are kept. When the map is full, idle
+/// buckets are removed (along with their drop counts); if it is still full,
+/// the map is cleared.
+
+class TokenBucketMap {
+ public:
+  struct Key {
+    DatapathID datapathId;
+    PortNumber inPort;
+
+    bool operator==(const Key &rhs) const {
+      return datapathId == rhs.datapathId && inPort == rhs.inPort;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      return std::hash<DatapathID>{}(key.datapathId) * 31 + key.inPort;
+    }
+  };
+
+  using Map = std::unordered_map<Key, TokenBucket, KeyHash>;
+
+  TokenBucketMap() = default;
+
+  bool enabled() const { return burst_ > 0; }
+  double rate() const { return rate_; }
+  UInt32 burst() const { return burst_; }
+  bool perPort() const { return perPort_; }
+
+  void setLimit(double rate, UInt32 burst, bool perPort) {
+    rate_ = rate;
+    burst_ = burst;
+    perPort_ = perPort;
+    buckets_.clear();
+  }
+
+  bool allow(const DatapathID &dpid, PortNumber inPort, Timestamp t) {
+    Key key{dpid, perPort_ ? inPort : PortNumber{}};
+    auto iter = buckets_.find(key);
+    if (iter == buckets_.end()) {
+      if (buckets_.size() >= kMaxTokenBuckets) {
+        expire(t);
+      }
+      iter = buckets_.emplace(key, TokenBucket{rate_, burst_}).first;
+    }
+    return iter->second.allow(t);
+  }
+
+  const Map &buckets() const { return buckets_; }
+
+ private:
+  Map buckets_;
+  double rate_ = 0;
+  UInt32 burst_ = 0;
+  bool perPort_ = false;
+
+  void expire(Timestamp t) {
+    for (auto iter = buckets_.begin(); iter != buckets_.end();) {
+      if (iter->second.idle(t)) {
+        iter = buckets_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+
+    if (buckets_.size() >= kMaxTokenBuckets) {
+      log_warning("TokenBucketMap: map is full; clearing", buckets_.size());
+      buckets_.clear();
+    }
+  }
+};
+
+OFP_END_IGNORE_PADDING
+
+}  // namespace rpc
+}  // namespace ofp
+
+#endif  // OFP_RPC_TOKENBUCKET_H_
@@ -15,6 +15,11 @@
 
 LLVM_YAML_IS_SEQUENCE_VECTOR(ofp::rpc::RpcConnectionStats)
 LLVM_YAML_IS_SEQUENCE_VECTOR(ofp::rpc::FilterTableEntry)
+LLVM_YAML_IS_SEQUENCE_VECTOR(ofp::rpc::TemplateSlot)
+LLVM_YAML_IS_SEQUENCE_VECTOR(ofp::rpc::RpcChannelMetrics)
+LLVM_YAML_IS_SEQUENCE_VECTOR(ofp::rpc::ArpTableEntry)
+LLVM_YAML_IS_SEQUENCE_VECTOR(ofp::rpc::RpcFilterDrops)
+LLVM_YAML_IS_FLOW_SEQUENCE_VECTOR(ofp::IPv4Address)
 
 namespace llvm {
 namespace yaml {
@@ -23,6 +28,8 @@ const char *const kRpcSchema = R"""(
 {Rpc/OFP.DESCRIPTION}
 id: UInt64
 method: !request OFP.DESCRIPTION
+params: !opt
+  base64: !opt Boolean
 result: !reply
   api_version: String
   sw_desc: String
@@ -93,6 +100,71 @@ params: !request
 result: !reply
   tls_id: UInt64
 
+{Rpc/OFP.ADD_TEMPLATE}
+id: !opt UInt64
+method: !request OFP.ADD_TEMPLATE
+params: !request
+  message: String
+  slots: !opt
+    - name: String
+      value: String
+  template_id: !opt UInt32
+result: !reply
+  template_id: UInt32
+
+{Rpc/OFP.SEND_TEMPLATE}
+id: !opt UInt64
+method: !request OFP.SEND_TEMPLATE
+params: !request
+  template_id: UInt32
+  conn_id: !opt UInt64
+  datapath_id: !opt DatapathID
+  xid: !opt UInt32
+  values: !opt [String]
+result: !reply
+  data: HexData
+
+{Rpc/OFP.SET_ARP_TABLE}
+id: !opt UInt64
+method: !request OFP.SET_ARP_TABLE
+params: !request
+  replace: !opt Boolean
+  entries: !opt
+    - ip: IPv4Address
+      mac: MacAddress
+  remove: !opt [IPv4Address]
+result: !reply
+  count: UInt32
+
+{Rpc/OFP.METRICS}
+id: UInt64
+method: !request OFP.METRICS
+result: !reply
+  rpc:
+    tx_events: UInt64
+    rx_events: UInt64
+    tx_bytes: UInt64
+    rx_bytes: UInt64
+    dropped_events: UInt64
+    decode_errors: UInt64
+    output_queue: UInt64
+    max_output_queue: UInt64
+  connections:
+    - conn_id: UInt64
+      datapath_id: DatapathID
+      auxiliary_id: UInt8
+      rx_messages: UInt64
+      rx_bytes: UInt64
+      tx_bytes: UInt64
+  filter_hits: [UInt64]
+  filter_drops:
+    - index: UInt32
+      datapath_id: DatapathID
+      in_port: PortNumber
+      dropped: UInt64
+  loop_lag: UInt64
+  max_loop_lag: UInt64
+
 {Rpc/OFP.MESSAGE}
 method: !notify OFP.MESSAGE
 params: !notify Message
@@ -166,7 +238,14 @@ struct ScalarEnumerationTraits<ofp::ChannelTransport> {
 
 template <>
 struct MappingTraits<ofp::rpc::RpcDescription::Params> {
-  static void mapping(IO &io, ofp::rpc::RpcDescription::Params &params) {}
+  static void mapping(IO &io, ofp::rpc::RpcDescription::Params &params) {
+    io.mapOptional("base64", params.base64);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcMetrics::Params> {
+  static void mapping(IO &io, ofp::rpc::RpcMetrics::Params &params) {}
 };
 
 template <>
@@ -237,6 +316,11 @@ struct MappingTraits<ofp::rpc::FilterTableEntry> {
         entry.setAction(std::move(action));
         break;
       }
+      case FilterAction::ARP_REPLY: {
+        // The ARP table is bound when the entry is added to a FilterTable.
+        entry.setAction(ofp::MakeUniquePtr<FilterActionArpReply>());
+        break;
+      }
       case FilterAction::NONE:
         break;
     }
@@ -244,6 +328,76 @@ struct MappingTraits<ofp::rpc::FilterTableEntry> {
     RateLimiter rateLimiter{false};
     io.mapOptional("escalate", rateLimiter);
     entry.setEscalate(rateLimiter);
+
+    RateLimiter dedup{false};
+    io.mapOptional("dedup", dedup);
+    if (dedup.n() > 0) {
+      entry.setDedup(dedup);
+    }
+
+    Optional<FilterEscalateLimit> limit;
+    io.mapOptional("limit", limit);
+    if (limit) {
+      if (limit->burst == 0 || !(limit->rate >= 0)) {
+        io.setError("invalid limit");
+      } else {
+        entry.setLimit(limit->rate, limit->burst, limit->perPort);
+      }
+    }
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::FilterEscalateLimit> {
+  static void mapping(IO &io, ofp::rpc::FilterEscalateLimit &limit) {
+    io.mapRequired("rate", limit.rate);
+    io.mapRequired("burst", limit.burst);
+    io.mapOptional("per_port", limit.perPort);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::ArpTableEntry> {
+  static void mapping(IO &io, ofp::rpc::ArpTableEntry &entry) {
+    io.mapRequired("ip", entry.ip);
+    io.mapRequired("mac", entry.mac);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcSetArpTable::Params> {
+  static void mapping(IO &io, ofp::rpc::RpcSetArpTable::Params &params) {
+    io.mapOptional("replace", params.replace);
+    io.mapOptional("entries", params.entries);
+    io.mapOptional("remove", params.remove);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::TemplateSlot> {
+  static void mapping(IO &io, ofp::rpc::TemplateSlot &slot) {
+    io.mapRequired("name", slot.name);
+    io.mapRequired("value", slot.value);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcAddTemplate::Params> {
+  static void mapping(IO &io, ofp::rpc::RpcAddTemplate::Params &params) {
+    io.mapRequired("message", params.message);
+    io.mapOptional("slots", params.slots);
+    io.mapOptional("template_id", params.templateId);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcSendTemplate::Params> {
+  static void mapping(IO &io, ofp::rpc::RpcSendTemplate::Params &params) {
+    io.mapRequired("template_id", params.templateId);
+    io.mapOptional("conn_id", params.connId);
+    io.mapOptional("datapath_id", params.datapathId);
+    io.mapOptional("xid", params.xid);
+    io.mapOptional("values", params.values);
   }
 };
 
@@ -383,6 +537,94 @@ struct MappingTraits<ofp::rpc::RpcSetFilterResponse::Result> {
   }
 };
 
+template <>
+struct MappingTraits<ofp::rpc::RpcSetArpTableResponse> {
+  static void mapping(IO &io, ofp::rpc::RpcSetArpTableResponse &response) {
+    io.mapRequired("id", response.id);
+    io.mapRequired("result", response.result);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcSetArpTableResponse::Result> {
+  static void mapping(IO &io,
+                      ofp::rpc::RpcSetArpTableResponse::Result &result) {
+    io.mapRequired("count", result.count);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcAddTemplateResponse> {
+  static void mapping(IO &io, ofp::rpc::RpcAddTemplateResponse &response) {
+    io.mapRequired("id", response.id);
+    io.mapRequired("result", response.result);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcAddTemplateResponse::Result> {
+  static void mapping(IO &io,
+                      ofp::rpc::RpcAddTemplateResponse::Result &result) {
+    io.mapRequired("template_id", result.templateId);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcMetricsResponse> {
+  static void mapping(IO &io, ofp::rpc::RpcMetricsResponse &response) {
+    io.mapRequired("id", response.id);
+    io.mapRequired("result", response.result);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcMetricsResponse::Result> {
+  static void mapping(IO &io, ofp::rpc::RpcMetricsResponse::Result &result) {
+    io.mapRequired("rpc", result.rpc);
+    io.mapRequired("connections", result.connections);
+    io.mapRequired("filter_hits", result.filterHits);
+    io.mapRequired("filter_drops", result.filterDrops);
+    io.mapRequired("loop_lag", result.loopLag);
+    io.mapRequired("max_loop_lag", result.maxLoopLag);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcEventMetrics> {
+  static void mapping(IO &io, ofp::rpc::RpcEventMetrics &metrics) {
+    io.mapRequired("tx_events", metrics.txEvents);
+    io.mapRequired("rx_events", metrics.rxEvents);
+    io.mapRequired("tx_bytes", metrics.txBytes);
+    io.mapRequired("rx_bytes", metrics.rxBytes);
+    io.mapRequired("dropped_events", metrics.droppedEvents);
+    io.mapRequired("decode_errors", metrics.decodeErrors);
+    io.mapRequired("output_queue", metrics.outputQueue);
+    io.mapRequired("max_output_queue", metrics.maxOutputQueue);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcChannelMetrics> {
+  static void mapping(IO &io, ofp::rpc::RpcChannelMetrics &metrics) {
+    io.mapRequired("conn_id", metrics.connId);
+    io.mapRequired("datapath_id", metrics.datapathId);
+    io.mapRequired("auxiliary_id", metrics.auxiliaryId);
+    io.mapRequired("rx_messages", metrics.rxMessages);
+    io.mapRequired("rx_bytes", metrics.rxBytes);
+    io.mapRequired("tx_bytes", metrics.txBytes);
+  }
+};
+
+template <>
+struct MappingTraits<ofp::rpc::RpcFilterDrops> {
+  static void mapping(IO &io, ofp::rpc::RpcFilterDrops &drops) {
+    io.mapRequired("index", drops.index);
+    io.mapRequired("datapath_id", drops.datapathId);
+    io.mapRequired("in_port", drops.inPort);
+    io.mapRequired("dropped", drops.dropped);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::rpc::RpcErrorResponse> {
   static void mapping(IO &io, ofp::rpc::RpcErrorResponse &response) {
@@ -52,6 +52,11 @@ class Connection : public Channel {
 
   void postMessage(Message *message);
   void postIdle();
+
+  /// Post `message` only if the connection handles it itself and it never
+  /// reaches the channel listener (ECHO_REQUEST and keep-alive ECHO_REPLY).
+  /// Return false if the message was not posted.
+  bool postPriorityMessage(Message *message);
   bool postDatapath(const DatapathID &datapathId, UInt8 auxiliaryId);
 
   sys::Engine *engine() const { return engine_; }
@@ -101,6 +106,11 @@ class Connection : public Channel {
 
   void tickle(TimePoint now) override;
 
+  // Traffic counters.
+  UInt64 rxMessages() const { return rxMessages_; }
+  UInt64 rxBytes() const { return rxBytes_; }
+  UInt64 txBytes() const { return txBytes_; }
+
  protected:
   /// Invoked by subclasses to inform channel delegate that channel is up.
   void channelUp();
@@ -111,6 +121,9 @@ class Connection : public Channel {
   /// Invoked by subclasses when an async read is initiated.
   void updateTimeReadStarted();
 
+  /// Invoked by subclasses when data is written.
+  void countWritten(size_t length) { txBytes_ += length; }
+
   /// Convenience function for initializer.
   void setFlags(UInt64 securityId, ChannelOptions options);
 
@@ -127,8 +140,12 @@ class Connection : public Channel {
   UInt8 auxiliaryId_ = 0;
   TimePoint timeReadStarted_;
   Milliseconds keepAliveTimeout_;
+  UInt64 rxMessages_ = 0;
+  UInt64 rxBytes_ = 0;
+  UInt64 txBytes_ = 0;
 
   bool echoMessageHandled(Message *message);
+  static bool isHandledEcho(const Message *message);
 };
 
 OFP_END_IGNORE_PADDING
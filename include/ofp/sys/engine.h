@@ -48,8 +48,25 @@ class Engine {
   bool isRunning() const { return isRunning_; }
   void installSignalHandlers(std::function<void()> callback);
 
+  // Pause/resume reading from channels. While reads are paused, connections
+  // hold the messages they read (except ECHO, which is still handled) and
+  // stop reading once they hold 64KB; the kernel's TCP receive window then
+  // provides backpressure to the other end.
+  void setReadPaused(bool paused);
+  bool isReadPaused() const { return readPaused_; }
+
+  template <class Handler>
+  void asyncWaitReadResumed(Handler &&handler) {
+    readResumeTimer_.async_wait(std::forward<Handler>(handler));
+  }
+
   asio::io_context &io() { return io_; }
 
+  // Delay between when the idle timer was due and when it actually ran. This
+  // is sampled once per second and measures how busy the event loop is.
+  Milliseconds loopLag() const { return loopLag_; }
+  Milliseconds maxLoopLag() const { return maxLoopLag_; }
+
   Driver *driver() const { return driver_; }
 
   bool registerDatapath(Connection *channel);
@@ -128,6 +145,13 @@ class Engine {
 
   // Timer used to poll idle connections.
   asio::steady_timer idleTimer_;
+  Milliseconds loopLag_ = 0_ms;
+  Milliseconds maxLoopLag_ = 0_ms;
+
+  // Timer that never expires; paused connections wait on it until it is
+  // cancelled by setReadPaused(false).
+  asio::steady_timer readResumeTimer_;
+  bool readPaused_ = false;
 
   mutable bool connListLock_ = false;
   mutable bool serverListLock_ = false;
@@ -41,6 +41,7 @@ class TCP_Connection
   IPv6Endpoint localEndpoint() const override;
 
   void write(const void *data, size_t length) override {
+    countWritten(length);
     socket_.buf_write(data, length);
   }
 
@@ -51,14 +52,26 @@ class TCP_Connection
  private:
   Message message_;
   Buffered<SocketType> socket_;
+  // Messages read while the engine has paused reads.
+  ByteList held_;
+  bool holdWaiting_ = false;
+  bool readWaiting_ = false;
 
   enum {
     // Bytes allowed before we must flush buffer.
-    kFlushLimit = 16383
+    kFlushLimit = 16383,
+    // Bytes of messages held while reads are paused before we stop reading.
+    kHoldLimit = 65535
   };
 
   void asyncReadHeader();
   void asyncReadMessage(size_t length);
+  void asyncWaitReadResumed();
+  void dispatchMessage();
+  void releaseHeldMessages(bool force = false);
+  bool readsPaused() {
+    return engine()->isReadPaused() && (flags() & kChannelUp);
+  }
   void asyncWrite();
   void asyncHandshake(bool isClient);
 
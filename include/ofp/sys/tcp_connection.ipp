@@ -199,6 +199,14 @@ void TCP_Connection<SocketType>::asyncReadHeader() {
   }
 
   auto self(this->shared_from_this());
+
+  // If reads are paused and we are already holding as many messages as we
+  // can, wait until they are released before reading the next message.
+  if (held_.size() >= kHoldLimit && readsPaused()) {
+    readWaiting_ = true;
+    return;
+  }
+
   updateTimeReadStarted();
 
   asio::async_read(
@@ -219,7 +227,7 @@ void TCP_Connection<SocketType>::asyncReadHeader() {
             UInt16 msgLength = hdr->length();
 
             if (msgLength == sizeof(Header)) {
-              postMessage(&message_);
+              dispatchMessage();
               if (socket_.is_open()) {
                 asyncReadHeader();
               } else {
@@ -234,6 +242,7 @@ void TCP_Connection<SocketType>::asyncReadHeader() {
             // The header failed our rudimentary validation checks.
             log_debug("asyncReadHeader header validation failed",
                       std::make_pair("connid", connectionId()));
+            releaseHeldMessages(true);
             channelDown();
             engine()->alert(this, "Invalid OpenFlow message header",
                             {hdr, sizeof(*hdr)});
@@ -249,6 +258,7 @@ void TCP_Connection<SocketType>::asyncReadHeader() {
                       std::make_pair("connid", connectionId()), err);
           }
 
+          releaseHeldMessages(true);
           channelDown();
           shutdown();
         }
@@ -279,7 +289,7 @@ void TCP_Connection<SocketType>::asyncReadMessage(size_t msgLength) {
         if (!err) {
           assert(bytes_transferred == message_.size() - sizeof(Header));
 
-          postMessage(&message_);
+          dispatchMessage();
           if (socket_.is_open()) {
             asyncReadHeader();
           } else {
@@ -292,11 +302,78 @@ void TCP_Connection<SocketType>::asyncReadMessage(size_t msgLength) {
             log_info("asyncReadMessage error",
                      std::make_pair("connid", connectionId()), err);
           }
+          releaseHeldMessages(true);
           channelDown();
         }
       });
 }
 
+/// Post the message just read. While reads are paused, only priority messages
+/// (e.g. ECHO) are posted; other messages are held until reads resume.
+template <class SocketType>
+void TCP_Connection<SocketType>::dispatchMessage() {
+  // Release held messages first to preserve the order of messages.
+  releaseHeldMessages();
+
+  if (held_.empty() && !readsPaused()) {
+    postMessage(&message_);
+  } else if (!postPriorityMessage(&message_)) {
+    held_.add(message_.data(), message_.size());
+    if (!holdWaiting_) {
+      asyncWaitReadResumed();
+    }
+  }
+}
+
+/// Wait until reads are resumed, then release the held messages. The pending
+/// wait keeps this connection alive.
+template <class SocketType>
+void TCP_Connection<SocketType>::asyncWaitReadResumed() {
+  assert(!holdWaiting_);
+
+  auto self(this->shared_from_this());
+  holdWaiting_ = true;
+
+  engine()->asyncWaitReadResumed([this, self](const asio::error_code &) {
+    holdWaiting_ = false;
+    if (!socket_.is_open()) {
+      return;
+    }
+
+    releaseHeldMessages();
+    if (!held_.empty()) {
+      // Reads were paused again.
+      asyncWaitReadResumed();
+    }
+
+    if (readWaiting_ && held_.size() < kHoldLimit) {
+      readWaiting_ = false;
+      asyncReadHeader();
+    }
+  });
+}
+
+/// Post the messages held while reads were paused. Stop if reads are paused
+/// again, unless `force` is true.
+template <class SocketType>
+void TCP_Connection<SocketType>::releaseHeldMessages(bool force) {
+  if (held_.empty()) {
+    return;
+  }
+
+  Message message{this};
+  size_t offset = 0;
+  while (offset < held_.size() && (force || !readsPaused())) {
+    const Header *hdr = Interpret_cast<Header>(held_.data() + offset);
+    size_t msgLength = hdr->length();
+    std::memcpy(message.mutableDataResized(msgLength), hdr, msgLength);
+    offset += msgLength;
+    postMessage(&message);
+  }
+
+  held_.remove(held_.data(), offset);
+}
+
 template <class SocketType>
 void TCP_Connection<SocketType>::asyncHandshake(bool isClient) {
   // Indicate the connection is up.
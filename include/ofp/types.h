@@ -278,7 +278,7 @@ std::string RawDataToHex(const void *data, size_t length, char delimiter,
 /// \param  length size of output buffer
 /// \param  error ptr to optional boolean error result
 /// \return number of bytes resulting from hexadecimal string
-size_t HexToRawData(const std::string &hex, void *data, size_t length,
+size_t HexToRawData(llvm::StringRef hex, void *data, size_t length,
                     bool *error = nullptr);
 
 /// Convert a (small) fixed size array to hexadecimal using lower case and ':'
@@ -328,6 +328,13 @@ std::string HexToRawData(const std::string &hex);
 /// \return base64 string
 std::string RawDataToBase64(const void *data, size_t length);
 
+/// Convert raw buffer to a base64.
+///
+/// \param  data pointer to input buffer
+/// \param  length size of input buffer
+/// \param  os output stream
+void RawDataToBase64(const void *data, size_t length, llvm::raw_ostream &os);
+
 /// Return true if memory block is filled with given byte value.
 ///
 /// \param  data   pointer to memory block
@@ -427,6 +434,9 @@ struct MappingTraits;
 template <class T>
 struct ScalarTraits;
 
+template <class T>
+struct JsonTraits;
+
 }  // namespace yaml
 }  // namespace llvm
 
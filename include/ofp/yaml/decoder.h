@@ -4,9 +4,11 @@
 #ifndef OFP_YAML_DECODER_H_
 #define OFP_YAML_DECODER_H_
 
+#include "ofp/bytelist.h"
 #include "ofp/channel.h"
 #include "ofp/message.h"
 #include "ofp/messageinfo.h"
+#include "ofp/yaml/outputjson.h"
 #include "ofp/yaml/yaddress.h"
 #include "ofp/yaml/ybyteorder.h"
 #include "ofp/yaml/ydatapathid.h"
@@ -16,23 +18,72 @@
 namespace ofp {
 namespace yaml {
 
+OFP_BEGIN_IGNORE_PADDING
+
+namespace detail {
+
+// Output stream used by the Decoder. It writes to the decoder's result
+// buffer, or appends to an external ByteList when one is set.
+class DecoderStream : public llvm::raw_ostream {
+ public:
+  explicit DecoderStream(llvm::SmallVectorImpl<char> *result)
+      : result_{result} {
+    SetUnbuffered();
+  }
+
+  void setOutput(ByteList *output) { output_ = output; }
+
+ private:
+  llvm::SmallVectorImpl<char> *result_;
+  ByteList *output_ = nullptr;
+
+  void write_impl(const char *ptr, size_t size) override;
+  uint64_t current_pos() const override;
+};
+
+}  // namespace detail
+
 class Decoder {
  public:
+  /// Construct a decoder that can be reused to decode many messages. The
+  /// output buffer and the YAML/JSON output backend are kept between calls to
+  /// decode().
+  explicit Decoder(bool useJsonFormat, bool includePktMatch = false);
+
+  /// Construct a decoder and decode `msg`.
   explicit Decoder(const Message *msg, bool useJsonFormat = false,
                    bool includePktMatch = false);
 
+  /// Decode `msg`, replacing the previous result. Return false if there is an
+  /// error.
+  bool decode(const Message *msg);
+
+  /// Decode `msg` and append the text to `output` instead of result(). Return
+  /// false if there is an error; `output` is left unchanged.
+  bool decode(const Message *msg, ByteList *output);
+
   const llvm::StringRef result() const { return result_; }
 
+  /// Write byte fields as base64 instead of hexadecimal (JSON only).
+  void setBase64Bytes(bool base64) { context_.base64Bytes = base64; }
+
   const std::string &error() const { return error_; }
   void setError(const std::string &error) { error_ = error; }
 
  private:
-  const Message *msg_;
+  const Message *msg_ = nullptr;
   llvm::SmallString<1024> result_;
   std::string error_;
+  detail::DecoderStream stream_{&result_};
+  detail::YamlContext context_;
+  OutputJson jsonOut_{stream_, &context_};
+  llvm::yaml::Output yamlOut_{stream_, &context_};
+  bool useJsonFormat_ = false;
 
   explicit Decoder(const Message *msg, const Decoder *decoder);
 
+  void decodeTo(const Message *msg);
+
   bool decodeMsg(llvm::yaml::IO &io);
   bool decodeRequestForward(llvm::yaml::IO &io, const Message *msg);
 
@@ -41,6 +92,8 @@ class Decoder {
                                 const Message *msg);
 };
 
+OFP_END_IGNORE_PADDING
+
 }  // namespace yaml
 }  // namespace ofp
 
@@ -69,6 +122,11 @@ struct MappingTraits<ofp::yaml::Decoder> {
       io.mapRequired("flags", flags);
     }
 
+    UInt32 duplicates = decoder.msg_->duplicates();
+    if (duplicates) {
+      io.mapRequired("duplicates", duplicates);
+    }
+
     io.mapRequired("xid", header.xid_);
     io.mapRequired("version", header.version_);
 
@@ -16,6 +16,8 @@
 namespace ofp {
 namespace yaml {
 
+class InputJson;
+
 OFP_BEGIN_IGNORE_PADDING
 
 class Encoder {
@@ -28,6 +30,16 @@ class Encoder {
           int lineNumber = 1, UInt8 defaultVersion = 0,
           ChannelFinder finder = nullptr);
 
+  /// Encode `input` using `parser` to read strict JSON. The parser keeps its
+  /// memory between messages; it may be null. `input` may be a slice of a
+  /// larger buffer; if it is not JSON, it is copied so the YAML reader sees a
+  /// null terminator. Set `nullTerminated` if `input` is already followed by
+  /// a null character, e.g. it is a std::string.
+  Encoder(InputJson *parser, llvm::StringRef input,
+          bool matchPrereqsChecked = true, int lineNumber = 1,
+          UInt8 defaultVersion = 0, ChannelFinder finder = nullptr,
+          bool nullTerminated = false);
+
   const UInt8 *data() const { return channel_.data(); }
   size_t size() const { return channel_.size(); }
 
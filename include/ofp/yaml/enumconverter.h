@@ -4,8 +4,12 @@
 #ifndef OFP_YAML_ENUMCONVERTER_H_
 #define OFP_YAML_ENUMCONVERTER_H_
 
+#include <algorithm>
+#include <numeric>
+
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include "ofp/hash.h"
 
 namespace ofp {
 namespace yaml {
@@ -21,6 +25,142 @@ constexpr uint64_t MaxIntValue() {
                                : 0;
 }
 
+/// Hash table that maps a key to its index in a fixed list of keys. The
+/// table is built once, when the enum converter is constructed. If a key is
+/// listed more than once, the first index is used. If no perfect hash table
+/// can be built for the keys, `find` falls back to a linear search.
+template <class Key>
+class EnumHashTable {
+ public:
+  explicit EnumHashTable(const std::vector<Key> &keys) {
+    // Sort the indexes by key, keeping the first index of each key.
+    std::vector<UInt16> indexes(keys.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::stable_sort(
+        indexes.begin(), indexes.end(),
+        [&keys](UInt16 lhs, UInt16 rhs) { return keys[lhs] < keys[rhs]; });
+    indexes.erase(std::unique(indexes.begin(), indexes.end(),
+                              [&keys](UInt16 lhs, UInt16 rhs) {
+                                return keys[lhs] == keys[rhs];
+                              }),
+                  indexes.end());
+
+    std::vector<Key> unique;
+    for (auto index : indexes) {
+      unique.push_back(keys[index]);
+    }
+
+    size_t size = 1;
+    while (size < unique.size()) {
+      size *= 2;
+    }
+
+    if (!hash::PerfectHashBuild(unique, size, &seeds_, &slots_)) {
+      seeds_.clear();
+      slots_.clear();
+      keys_ = keys;
+      return;
+    }
+
+    for (auto &slot : slots_) {
+      if (slot != hash::PerfectHashEmpty) {
+        slot = indexes[slot];
+      }
+    }
+  }
+
+  /// Return the index of `key`. The caller must check that the key at the
+  /// returned index is equal to `key`. Returns PerfectHashEmpty or an
+  /// unrelated index if `key` is not in the table.
+  UInt16 find(const Key &key) const {
+    if (slots_.empty()) {
+      auto iter = std::find(keys_.begin(), keys_.end(), key);
+      return iter != keys_.end()
+                 ? UInt16_narrow_cast(std::distance(keys_.begin(), iter))
+                 : UInt16{hash::PerfectHashEmpty};
+    }
+    return hash::PerfectHashFind(key, seeds_.data(), slots_.data(),
+                                 slots_.size());
+  }
+
+  /// Return true if `find` uses the perfect hash table.
+  bool hashed() const { return !slots_.empty(); }
+
+ private:
+  std::vector<UInt16> seeds_;
+  std::vector<UInt16> slots_;
+  std::vector<Key> keys_;  // only used if there is no hash table
+};
+
+/// Table that maps a name to its index in a fixed list of names. The names
+/// are grouped by length, so a lookup only compares names of the same length.
+/// If a name is listed more than once, the first index is used.
+class EnumNameTable {
+ public:
+  explicit EnumNameTable(const std::vector<llvm::StringRef> &names) {
+    size_t maxLength = 0;
+    for (auto name : names) {
+      maxLength = std::max(maxLength, name.size());
+    }
+
+    // Count the names of each length, then turn the counts into offsets.
+    starts_.assign(maxLength + 2, 0);
+    for (auto name : names) {
+      ++starts_[name.size() + 1];
+    }
+    std::partial_sum(starts_.begin(), starts_.end(), starts_.begin());
+
+    std::vector<UInt16> next{starts_.begin(), starts_.end() - 1};
+    names_.resize(names.size());
+    indexes_.resize(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+      UInt16 pos = next[names[i].size()]++;
+      names_[pos] = names[i];
+      indexes_[pos] = UInt16_narrow_cast(i);
+    }
+  }
+
+  /// Return the index of `name`, or PerfectHashEmpty if `name` is not in the
+  /// table.
+  UInt16 find(llvm::StringRef name) const {
+    const size_t len = name.size();
+    if (len + 1 >= starts_.size()) {
+      return hash::PerfectHashEmpty;
+    }
+    for (size_t i = starts_[len]; i < starts_[len + 1]; ++i) {
+      if (std::memcmp(names_[i].data(), name.data(), len) == 0) {
+        return indexes_[i];
+      }
+    }
+    return hash::PerfectHashEmpty;
+  }
+
+ private:
+  std::vector<UInt16> starts_;
+  std::vector<llvm::StringRef> names_;
+  std::vector<UInt16> indexes_;
+};
+
+/// Return the list of names in `entries`.
+template <class Entry>
+std::vector<llvm::StringRef> EntryNames(llvm::ArrayRef<Entry> entries) {
+  std::vector<llvm::StringRef> result;
+  for (const auto &entry : entries) {
+    result.push_back(entry.second);
+  }
+  return result;
+}
+
+/// Return the list of values in `entries`.
+template <class Entry>
+std::vector<UInt32> EntryValues(llvm::ArrayRef<Entry> entries) {
+  std::vector<UInt32> result;
+  for (const auto &entry : entries) {
+    result.push_back(static_cast<UInt32>(entry.first));
+  }
+  return result;
+}
+
 }  // namespace detail
 
 template <class Type>
@@ -41,15 +181,14 @@ class EnumConverter {
  public:
   explicit EnumConverter(llvm::ArrayRef<llvm::StringRef> names,
                          llvm::StringRef maxIntName = "")
-      : names_{names}, maxIntName_{maxIntName} {}
+      : names_{names}, maxIntName_{maxIntName}, nameTable_{names.vec()} {}
 
   bool convert(llvm::StringRef name, Type *value) const {
     // Check for name match.
-    for (size_t i = 0, len = names_.size(); i < len; ++i) {
-      if (name.equals(names_[i])) {
-        *value = static_cast<Type>(i);
-        return true;
-      }
+    size_t i = nameTable_.find(name);
+    if (i < names_.size() && name.equals(names_[i])) {
+      *value = static_cast<Type>(i);
+      return true;
     }
     if (!maxIntName_.empty() && name.equals(maxIntName_)) {
       *value = static_cast<Type>(detail::MaxIntValue<Type>());
@@ -85,6 +224,7 @@ class EnumConverter {
  private:
   llvm::ArrayRef<llvm::StringRef> names_;
   llvm::StringRef maxIntName_;
+  detail::EnumNameTable nameTable_;
 };
 
 template <class Type>
@@ -93,26 +233,26 @@ class EnumConverterSparse {
   using Entry = std::pair<Type, llvm::StringRef>;
 
   explicit EnumConverterSparse(llvm::ArrayRef<Entry> entries)
-      : entries_{entries} {}
+      : entries_{entries},
+        nameTable_{detail::EntryNames(entries)},
+        valueTable_{detail::EntryValues(entries)} {}
 
   bool convert(llvm::StringRef name, Type *value) const {
     // Check for name match.
-    for (size_t i = 0, len = entries_.size(); i < len; ++i) {
-      if (name.equals(entries_[i].second)) {
-        *value = entries_[i].first;
-        return true;
-      }
+    size_t i = nameTable_.find(name);
+    if (i < entries_.size() && name.equals(entries_[i].second)) {
+      *value = entries_[i].first;
+      return true;
     }
     return false;
   }
 
   bool convert(Type value, llvm::StringRef *name) const {
     // Check for value match.
-    for (size_t i = 0, len = entries_.size(); i < len; ++i) {
-      if (value == entries_[i].first) {
-        *name = entries_[i].second;
-        return true;
-      }
+    size_t i = valueTable_.find(static_cast<UInt32>(value));
+    if (i < entries_.size() && value == entries_[i].first) {
+      *name = entries_[i].second;
+      return true;
     }
     return false;
   }
@@ -127,6 +267,10 @@ class EnumConverterSparse {
 
  private:
   llvm::ArrayRef<Entry> entries_;
+  detail::EnumNameTable nameTable_;
+  detail::EnumHashTable<UInt32> valueTable_;
+
+  static_assert(sizeof(Type) <= sizeof(UInt32), "Unexpected size");
 };
 
 }  // namespace yaml
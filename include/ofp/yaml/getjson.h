@@ -38,6 +38,28 @@ bool getyaml(std::istream &input, std::string &yaml, int &lineNum,
 bool getline(std::istream &input, std::string &line, int &lineNum,
              int &newlineCount);
 
+/// Function pointer type for the in-memory versions below.
+///
+/// These split a buffer that is already in memory (e.g. a memory-mapped file).
+/// Each message is returned in place as a slice of `input`, and `input` is
+/// advanced past it. Line numbers are counted the same way as the stream
+/// versions.
+
+using GetMsgRangeFunction = bool (*)(llvm::StringRef &, llvm::StringRef &,
+                                     int &, int &);
+
+bool getjson(llvm::StringRef &input, llvm::StringRef &json, int &lineNum,
+             int &newlineCount);
+
+/// Unlike the stream version, a CR-LF line ending inside the YAML message is
+/// not converted, and the last line is not given a missing LF.
+
+bool getyaml(llvm::StringRef &input, llvm::StringRef &yaml, int &lineNum,
+             int &newlineCount);
+
+bool getline(llvm::StringRef &input, llvm::StringRef &line, int &lineNum,
+             int &newlineCount);
+
 }  // namespace yaml
 }  // namespace ofp
 
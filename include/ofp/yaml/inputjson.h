@@ -0,0 +1,173 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_YAML_INPUTJSON_H_
+#define OFP_YAML_INPUTJSON_H_
+
+#include "ofp/yaml/yllvm.h"
+
+namespace ofp {
+namespace yaml {
+
+OFP_BEGIN_IGNORE_PADDING
+
+/// Strict JSON input for llvm::yaml mappings.
+///
+/// InputJson reads a single JSON object directly from the input buffer. The
+/// input is validated in one pass into a flat array of tokens; there is no
+/// YAML node tree and no SourceMgr (unless an error is reported). Error
+/// messages mirror the ones produced by llvm::yaml::Input.
+///
+/// If the input is not a strict JSON object, valid() returns false and the
+/// caller should fall back to llvm::yaml::Input.
+///
+/// An InputJson can be reused to read many inputs with reset(). The token
+/// arrays and string allocator keep their memory between inputs.
+
+class InputJson : public llvm::yaml::IO {
+ public:
+  /// Construct an empty reader; call reset() to read an input.
+  InputJson();
+  explicit InputJson(llvm::StringRef input, void *ctxt = nullptr,
+                     llvm::SourceMgr::DiagHandlerTy diagHandler = nullptr,
+                     void *diagHandlerCtxt = nullptr);
+  ~InputJson() override;
+
+  /// Read a new input, replacing the previous one. Values read from the
+  /// previous input are no longer valid.
+  void reset(llvm::StringRef input,
+             llvm::SourceMgr::DiagHandlerTy diagHandler = nullptr,
+             void *diagHandlerCtxt = nullptr);
+
+  /// Return true if the input is a strict JSON object.
+  bool valid() const { return !nodes_.empty(); }
+
+  std::error_code error() override { return error_; }
+
+  bool outputting() override { return false; }
+
+  unsigned beginSequence() override;
+  bool preflightElement(unsigned Index, void *&SaveInfo) override;
+  void postflightElement(void *SaveInfo) override;
+  void endSequence() override {}
+  bool canElideEmptySequence() override { return false; }
+
+  unsigned beginFlowSequence() override { return beginSequence(); }
+  bool preflightFlowElement(unsigned Index, void *&SaveInfo) override {
+    return preflightElement(Index, SaveInfo);
+  }
+  void postflightFlowElement(void *SaveInfo) override {
+    postflightElement(SaveInfo);
+  }
+  void endFlowSequence() override {}
+
+  bool mapTag(llvm::StringRef Tag, bool Default = false) override {
+    return Default;
+  }
+  void beginMapping() override;
+  void endMapping() override;
+  bool preflightKey(const char *Key, bool Required, bool, bool &UseDefault,
+                    void *&SaveInfo) override;
+  void postflightKey(void *SaveInfo) override;
+  std::vector<llvm::StringRef> keys() override;
+
+  void beginFlowMapping() override { beginMapping(); }
+  void endFlowMapping() override { endMapping(); }
+
+  void beginEnumScalar() override { scalarMatchFound_ = false; }
+  bool matchEnumScalar(const char *Str, bool) override;
+  bool matchEnumFallback() override;
+  void endEnumScalar() override;
+
+  bool beginBitSetScalar(bool &DoClear) override;
+  bool bitSetMatch(const char *Str, bool) override;
+  void endBitSetScalar() override;
+  bool bitSetMatchOther(uint32_t &Val) override;
+  llvm::StringRef bitSetCaseUnmatched() override;
+
+  void scalarString(llvm::StringRef &S, llvm::yaml::QuotingType) override;
+  void blockScalarString(llvm::StringRef &S) override {
+    scalarString(S, llvm::yaml::QuotingType::None);
+  }
+  void scalarTag(std::string &Tag) override { Tag.clear(); }
+
+  llvm::yaml::NodeKind getNodeKind() override;
+
+  void setError(const llvm::Twine &message) override;
+
+ public:
+  // This is only used by operator>>. It could be private if that templated
+  // operator could be made a friend.
+  bool setCurrentDocument();
+
+ private:
+  enum NodeKind : UInt8 { kScalar, kString, kMap, kSeq };
+
+  // Each token records its byte range in the input. For a map or sequence,
+  // `next` is the index just past its last descendant and `count` is the
+  // number of members or elements. A map's members are stored as alternating
+  // key and value tokens. For an escaped string, `count` is the index of its
+  // unescaped value.
+  struct Node {
+    NodeKind kind;
+    bool escaped;
+    bool used;
+    UInt32 begin;
+    UInt32 end;
+    UInt32 next;
+    UInt32 count;
+    UInt32 cursorIndex;
+    UInt32 cursorNode;
+  };
+
+  bool parseValue(const char *&pos, unsigned depth);
+  bool parseString(const char *&pos);
+  bool parseNumber(const char *&pos);
+  size_t addNode(NodeKind kind, const char *begin);
+
+  llvm::StringRef value(size_t index);
+  bool isScalar(size_t index) const { return nodes_[index].kind <= kString; }
+  size_t findKey(size_t map, llvm::StringRef key);
+  size_t element(size_t seq, unsigned index);
+
+  void setError(size_t index, const llvm::Twine &message);
+
+  static void *toSaveInfo(size_t index) {
+    return reinterpret_cast<void *>(static_cast<uintptr_t>(index));
+  }
+  static size_t fromSaveInfo(void *saveInfo) {
+    return static_cast<size_t>(reinterpret_cast<uintptr_t>(saveInfo));
+  }
+
+  llvm::StringRef input_;
+  std::vector<Node> nodes_;
+  std::vector<llvm::StringRef> unescaped_;
+  size_t current_ = 0;
+  std::error_code error_;
+  std::vector<bool> bitValuesUsed_;
+  llvm::BumpPtrAllocator stringAllocator_;
+  llvm::SourceMgr::DiagHandlerTy diagHandler_;
+  void *diagHandlerCtxt_;
+  bool scalarMatchFound_ = false;
+};
+
+OFP_END_IGNORE_PADDING
+
+// Define non-member operator>> so that InputJson can stream in a map.
+// (Adapted from llvm::yaml.)
+template <typename T>
+inline typename std::enable_if<
+    llvm::yaml::has_MappingTraits<T, llvm::yaml::EmptyContext>::value,
+    InputJson &>::type
+operator>>(InputJson &yin, T &map) {
+  llvm::yaml::EmptyContext Ctx;
+  if (yin.setCurrentDocument()) {
+    yamlize(yin, map, true, Ctx);
+  }
+  return yin;
+}
+
+}  // namespace yaml
+}  // namespace ofp
+
+#endif  // OFP_YAML_INPUTJSON_H_
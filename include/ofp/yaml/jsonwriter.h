@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef OFP_YAML_JSONWRITER_H_
+#define OFP_YAML_JSONWRITER_H_
+
+#include "ofp/yaml/outputjson.h"
+#include "ofp/yaml/ybytelist.h"
+
+namespace llvm {
+namespace yaml {
+
+// JsonTraits<T> provides a specialized JSON writer for a hot message type. It
+// must produce the same output as MappingTraits<T> with OutputJson. Define:
+//
+//   static void write(ofp::yaml::JsonWriter &json, T &value);
+//
+// The body of `write` looks like MappingTraits<T>::mapping, but the calls to
+// mapRequired/mapOptional are resolved at compile time.
+template <class T>
+struct JsonTraits {};
+
+}  // namespace yaml
+}  // namespace llvm
+
+namespace ofp {
+namespace yaml {
+
+class JsonWriter;
+
+namespace detail {
+
+// Test if JsonTraits<T>::write is defined.
+template <class T>
+struct has_JsonTraits {
+  template <class U>
+  static char test(decltype(U::write(std::declval<JsonWriter &>(),
+                                     std::declval<T &>())) *);
+
+  template <class U>
+  static double test(...);
+
+  static const bool value =
+      sizeof(test<llvm::yaml::JsonTraits<T>>(nullptr)) == 1;
+};
+
+// Test if T is an indexed sequence of elements that have JsonTraits.
+template <class T>
+struct has_JsonSequence {
+  template <class U>
+  static typename std::enable_if<
+      has_JsonTraits<typename std::remove_reference<decltype(U::element(
+          std::declval<llvm::yaml::IO &>(), std::declval<T &>(), 0))>::type>::
+          value,
+      char>::type
+  test(U *);
+
+  template <class U>
+  static double test(...);
+
+  static const bool value =
+      sizeof(test<llvm::yaml::SequenceTraits<T>>(nullptr)) == 1;
+};
+
+}  // namespace detail
+
+/// Writes JSON to an OutputJson without going through the virtual IO
+/// interface.
+///
+/// Scalars use the same ScalarTraits as OutputJson; types with JsonTraits use
+/// their specialized writer. All other types fall back to the generic path,
+/// so the output is always the same as OutputJson's.
+class JsonWriter {
+ public:
+  explicit JsonWriter(OutputJson &io) : io_(io) {}
+
+  llvm::yaml::IO &io() { return io_; }
+
+  template <class T>
+  void mapRequired(const char *key, T &value) {
+    writeKey(key);
+    write(value);
+    io_.NeedComma = true;
+  }
+
+  template <class T>
+  void mapOptional(const char *key, T &value) {
+    mapRequired(key, value);
+  }
+
+  template <class T>
+  void mapOptional(const char *key, llvm::Optional<T> &value) {
+    if (value.hasValue()) {
+      mapRequired(key, *value);
+    }
+  }
+
+  template <class T, class U>
+  void mapOptional(const char *key, T &value, const U &defaultValue) {
+    if (!(value == defaultValue)) {
+      mapRequired(key, value);
+    }
+  }
+
+  /// Write the fields of `value` into the current mapping.
+  template <class T>
+  typename std::enable_if<detail::has_JsonTraits<T>::value>::type mapping(
+      T &value) {
+    llvm::yaml::JsonTraits<T>::write(*this, value);
+  }
+
+  template <class T>
+  typename std::enable_if<!detail::has_JsonTraits<T>::value>::type mapping(
+      T &value) {
+    llvm::yaml::MappingTraits<T>::mapping(io_, value);
+  }
+
+  template <class T>
+  typename std::enable_if<detail::has_JsonTraits<T>::value>::type write(
+      T &value) {
+    io_.output("{");
+    io_.NeedComma = false;
+    llvm::yaml::JsonTraits<T>::write(*this, value);
+    io_.output("}");
+  }
+
+  template <class T>
+  typename std::enable_if<detail::has_JsonSequence<T>::value>::type write(
+      T &seq) {
+    io_.output("[");
+    io_.NeedComma = false;
+    size_t count = llvm::yaml::SequenceTraits<T>::size(io_, seq);
+    for (size_t i = 0; i < count; ++i) {
+      if (io_.NeedComma)
+        io_.output(",");
+      write(llvm::yaml::SequenceTraits<T>::element(io_, seq, i));
+      io_.NeedComma = true;
+    }
+    io_.output("]");
+  }
+
+  void write(ByteRange &value) { io_.scalarBytes(value.data(), value.size()); }
+  void write(ByteList &value) { io_.scalarBytes(value.data(), value.size()); }
+
+  template <class T>
+  typename std::enable_if<llvm::yaml::has_ScalarTraits<T>::value &&
+                          llvm::yaml::has_ScalarJsonTraits<T>::value>::type
+  write(T &value) {
+    using llvm::yaml::primitive_to_json;
+    typename llvm::yaml::ScalarTraits<T>::json_type u = value;
+    primitive_to_json(u, io_.Out);
+  }
+
+  template <class T>
+  typename std::enable_if<llvm::yaml::has_ScalarTraits<T>::value &&
+                          !llvm::yaml::has_ScalarJsonTraits<T>::value>::type
+  write(T &value) {
+    llvm::SmallString<128> buf;
+    llvm::raw_svector_ostream os{buf};
+    llvm::yaml::ScalarTraits<T>::output(value, io_.getContext(), os);
+    llvm::StringRef str = os.str();
+    io_.OutputJson::scalarString(str, llvm::yaml::QuotingType::Double);
+  }
+
+  template <class T>
+  typename std::enable_if<!detail::has_JsonTraits<T>::value &&
+                          !detail::has_JsonSequence<T>::value &&
+                          !llvm::yaml::has_ScalarTraits<T>::value>::type
+  write(T &value) {
+    llvm::yaml::EmptyContext ctx;
+    yamlize(io_, value, true, ctx);
+  }
+
+ private:
+  OutputJson &io_;
+
+  void writeKey(const char *key) {
+    if (io_.NeedComma)
+      io_.output(",");
+    io_.paddedKey(key);
+  }
+};
+
+}  // namespace yaml
+}  // namespace ofp
+
+#endif  // OFP_YAML_JSONWRITER_H_
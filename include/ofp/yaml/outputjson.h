@@ -59,6 +59,10 @@ class OutputJson : public llvm::yaml::IO {
   }
   void scalarTag(std::string &Tag) override { assert(Tag.empty()); }
 
+  /// Write a byte field as a quoted hexadecimal string, or as base64 if the
+  /// context's `base64Bytes` option is set.
+  void scalarBytes(const void *data, size_t length);
+
   llvm::yaml::NodeKind getNodeKind() override {
     llvm::report_fatal_error("invalid call");
   }
@@ -79,6 +83,8 @@ class OutputJson : public llvm::yaml::IO {
 
   llvm::raw_ostream &Out;
   bool NeedComma;
+
+  friend class JsonWriter;
 };
 
 OFP_END_IGNORE_PADDING
@@ -60,6 +60,12 @@ struct ScalarTraits<ofp::ByteList> {
   using json_type = JsonByteRange;
 };
 
+// When writing JSON, byte fields are written by OutputJson::scalarBytes, which
+// may use base64 instead of hexadecimal. These overloads are found by ADL in
+// place of the generic yamlize templates.
+void yamlize(IO &io, ofp::ByteRange &value, bool required, EmptyContext &ctx);
+void yamlize(IO &io, ofp::ByteList &value, bool required, EmptyContext &ctx);
+
 }  // namespace yaml
 }  // namespace llvm
 
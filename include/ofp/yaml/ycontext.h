@@ -23,6 +23,9 @@ namespace detail {
 //
 // When decoding a message, the `pktMatch` option specifies whether to include
 // the `data_match` field when decoding a PacketIn message.
+//
+// The `base64Bytes` option specifies whether byte fields, like PacketIn's
+// `data`, are written to JSON as base64 instead of hexadecimal.
 
 struct YamlContext {
   explicit YamlContext(Encoder *enc, llvm::yaml::IO *_io)
@@ -39,11 +42,12 @@ struct YamlContext {
   llvm::yaml::IO *io = nullptr;
   UInt8 version;
   bool pktMatch;
+  bool base64Bytes = false;
 
   // Use magic values to verify that context exists and is valid.
   UInt8 magic1 = 'c';
   UInt8 magic2 = 'o';
-  UInt8 padding[4];
+  UInt8 padding[3];
 
   bool validate() const { return magic1 == 'c' && magic2 == 'o'; }
 
@@ -57,6 +61,7 @@ Encoder *GetEncoderFromContext(llvm::yaml::IO &io);
 Decoder *GetDecoderFromContext(llvm::yaml::IO &io);
 UInt8 GetVersionFromContext(llvm::yaml::IO &io);
 bool GetIncludePktMatchFromContext(llvm::yaml::IO &io);
+bool GetBase64BytesFromContext(llvm::yaml::IO &io);
 
 }  // namespace yaml
 }  // namespace ofp
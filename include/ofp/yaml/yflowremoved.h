@@ -6,6 +6,7 @@
 
 #include "ofp/flowremoved.h"
 #include "ofp/flowremovedv6.h"
+#include "ofp/yaml/jsonwriter.h"
 #include "ofp/yaml/ydurationsec.h"
 #include "ofp/yaml/ystat.h"
 
@@ -46,6 +47,24 @@ struct MappingTraits<ofp::FlowRemoved> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::FlowRemoved> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::FlowRemoved &msg) {
+    json.mapRequired("cookie", msg.cookie_);
+    json.mapRequired("priority", msg.priority_);
+    json.mapRequired("reason", msg.reason_);
+    json.mapRequired("table_id", msg.tableId_);
+    json.mapRequired("duration", msg.duration_);
+    json.mapRequired("idle_timeout", msg.idleTimeout_);
+    json.mapRequired("hard_timeout", msg.hardTimeout_);
+    json.mapRequired("packet_count", msg.packetCount_);
+    json.mapRequired("byte_count", msg.byteCount_);
+
+    ofp::Match m = msg.match();
+    json.mapRequired("match", m);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::FlowRemovedBuilder> {
   static void mapping(IO &io, ofp::FlowRemovedBuilder &msg) {
@@ -89,6 +108,32 @@ struct MappingTraits<ofp::FlowRemovedV6> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::FlowRemovedV6> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::FlowRemovedV6 &msg) {
+    using namespace ofp;
+    DurationSec duration = msg.duration();
+    Hex64 packetCount = msg.packetCount();
+    Hex64 byteCount = msg.byteCount();
+
+    json.mapRequired("cookie", msg.cookie_);
+    json.mapRequired("priority", msg.priority_);
+    json.mapRequired("reason", msg.reason_);
+    json.mapRequired("table_id", msg.tableId_);
+    json.mapRequired("duration", duration);
+    json.mapRequired("idle_timeout", msg.idleTimeout_);
+    json.mapRequired("hard_timeout", msg.hardTimeout_);
+    json.mapRequired("packet_count", packetCount);
+    json.mapRequired("byte_count", byteCount);
+
+    Match m = msg.match();
+    json.mapRequired("match", m);
+
+    Stat s = msg.stat();
+    json.mapRequired("stat", s);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::FlowRemovedV6Builder> {
   static void mapping(IO &io, ofp::FlowRemovedV6Builder &msg) {
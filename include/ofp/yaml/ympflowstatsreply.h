@@ -5,6 +5,7 @@
 #define OFP_YAML_YMPFLOWSTATSREPLY_H_
 
 #include "ofp/mpflowstatsreply.h"
+#include "ofp/yaml/jsonwriter.h"
 #include "ofp/yaml/ydurationsec.h"
 #include "ofp/yaml/yflowmod.h"
 #include "ofp/yaml/yinstructions.h"
@@ -35,6 +36,29 @@ struct MappingTraits<ofp::MPFlowStatsReply> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::MPFlowStatsReply> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::MPFlowStatsReply &msg) {
+    using namespace ofp;
+
+    json.mapRequired("table_id", msg.tableId_);
+    json.mapRequired("duration", msg.duration_);
+    json.mapRequired("priority", msg.priority_);
+    json.mapRequired("idle_timeout", msg.idleTimeout_);
+    json.mapRequired("hard_timeout", msg.hardTimeout_);
+    json.mapRequired("flags", msg.flags_);
+    json.mapRequired("cookie", msg.cookie_);
+    json.mapRequired("packet_count", msg.packetCount_);
+    json.mapRequired("byte_count", msg.byteCount_);
+
+    Match m = msg.match();
+    json.mapRequired("match", m);
+
+    InstructionRange instrs = msg.instructions();
+    json.mapRequired("instructions", instrs);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::MPFlowStatsReplyBuilder> {
   static void mapping(IO &io, ofp::MPFlowStatsReplyBuilder &msg) {
@@ -5,6 +5,7 @@
 #define OFP_YAML_YMPPORTSTATS_H_
 
 #include "ofp/mpportstats.h"
+#include "ofp/yaml/jsonwriter.h"
 #include "ofp/yaml/yportstatsproperty.h"
 
 namespace llvm {
@@ -50,6 +51,45 @@ struct MappingTraits<ofp::MPPortStats> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::MPPortStats> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::MPPortStats &body) {
+    json.mapRequired("port_no", body.portNo_);
+    json.mapRequired("duration", body.duration_);
+    json.mapRequired("rx_packets", body.rxPackets_);
+    json.mapRequired("tx_packets", body.txPackets_);
+    json.mapRequired("rx_bytes", body.rxBytes_);
+    json.mapRequired("tx_bytes", body.txBytes_);
+    json.mapRequired("rx_dropped", body.rxDropped_);
+    json.mapRequired("tx_dropped", body.txDropped_);
+    json.mapRequired("rx_errors", body.rxErrors_);
+    json.mapRequired("tx_errors", body.txErrors_);
+
+    ofp::PropertyRange props = body.properties();
+
+    auto eprop = props.findProperty(ofp::PortStatsPropertyEthernet::type());
+    if (eprop != props.end()) {
+      const ofp::PortStatsPropertyEthernet &eth =
+          eprop->property<ofp::PortStatsPropertyEthernet>();
+      json.mapping(RemoveConst_cast(eth));
+    } else {
+      // If property is missing, write out empty values.
+      ofp::PortStatsPropertyEthernet empty;
+      json.mapping(empty);
+    }
+
+    auto oprop = props.findProperty(ofp::PortStatsPropertyOptical::type());
+    if (oprop != props.end()) {
+      const ofp::PortStatsPropertyOptical &opt =
+          oprop->property<ofp::PortStatsPropertyOptical>();
+      json.mapRequired("optical", RemoveConst_cast(opt));
+    }
+
+    json.mapRequired("properties",
+                     Ref_cast<ofp::detail::PortStatsPropertyRange>(props));
+  }
+};
+
 template <>
 struct MappingTraits<ofp::MPPortStatsBuilder> {
   static void mapping(IO &io, ofp::MPPortStatsBuilder &msg) {
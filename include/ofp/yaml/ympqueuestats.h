@@ -5,6 +5,7 @@
 #define OFP_YAML_YMPQUEUESTATS_H_
 
 #include "ofp/mpqueuestats.h"
+#include "ofp/yaml/jsonwriter.h"
 
 namespace llvm {
 namespace yaml {
@@ -21,6 +22,18 @@ struct MappingTraits<ofp::MPQueueStats> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::MPQueueStats> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::MPQueueStats &body) {
+    json.mapRequired("port_no", body.portNo_);
+    json.mapRequired("queue_id", body.queueId_);
+    json.mapRequired("tx_packets", body.txPackets_);
+    json.mapRequired("tx_bytes", body.txBytes_);
+    json.mapRequired("tx_errors", body.txErrors_);
+    json.mapRequired("duration", body.duration_);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::MPQueueStatsBuilder> {
   static void mapping(IO &io, ofp::MPQueueStatsBuilder &msg) {
@@ -5,6 +5,7 @@
 #define OFP_YAML_YMPTABLESTATS_H_
 
 #include "ofp/mptablestats.h"
+#include "ofp/yaml/jsonwriter.h"
 
 namespace llvm {
 namespace yaml {
@@ -22,6 +23,19 @@ struct MappingTraits<ofp::MPTableStats> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::MPTableStats> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::MPTableStats &body) {
+    json.mapRequired("table_id", body.tableId_);
+    json.mapOptional("name", body.name_);
+    json.mapOptional("wildcards", body.wildcards_);
+    json.mapOptional("max_entries", body.maxEntries_);
+    json.mapRequired("active_count", body.activeCount_);
+    json.mapRequired("lookup_count", body.lookupCount_);
+    json.mapRequired("matched_count", body.matchedCount_);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::MPTableStatsBuilder> {
   static void mapping(IO &io, ofp::MPTableStatsBuilder &msg) {
@@ -6,6 +6,7 @@
 
 #include "ofp/matchpacketbuilder.h"
 #include "ofp/packetin.h"
+#include "ofp/yaml/jsonwriter.h"
 #include "ofp/yaml/ybuffernumber.h"
 #include "ofp/yaml/ymatchpacket.h"
 
@@ -67,6 +68,43 @@ struct MappingTraits<ofp::PacketIn> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::PacketIn> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::PacketIn &msg) {
+    using namespace ofp;
+
+    BufferNumber bufferID = msg.bufferId();
+    Hex16 totalLen = msg.totalLen();
+    json.mapRequired("buffer_id", bufferID);
+    json.mapRequired("total_len", totalLen);
+
+    PortNumber inPort = msg.inPort();
+    Hex32 inPhyPort = msg.inPhyPort();
+    Hex64 metadata = msg.metadata();
+    json.mapRequired("in_port", inPort);
+    json.mapOptional("in_phy_port", inPhyPort, inPort);
+    json.mapRequired("metadata", metadata);
+
+    OFPPacketInReason reason = msg.reason();
+    TableNumber tableID = msg.tableID();
+    Hex64 cookie = msg.cookie();
+    json.mapRequired("reason", reason);
+    json.mapRequired("table_id", tableID);
+    json.mapRequired("cookie", cookie);
+
+    ofp::Match m = msg.match();
+    json.mapRequired("match", m);
+
+    ofp::ByteRange enetFrame = msg.enetFrame();
+    json.mapRequired("data", enetFrame);
+
+    if (ofp::yaml::GetIncludePktMatchFromContext(json.io())) {
+      ofp::MatchPacket mp{enetFrame};
+      json.mapRequired("_pkt", mp);
+    }
+  }
+};
+
 template <>
 struct MappingTraits<ofp::PacketInBuilder> {
   static void mapping(IO &io, ofp::PacketInBuilder &msg) {
@@ -6,6 +6,7 @@
 
 #include "ofp/port.h"
 #include "ofp/portlist.h"
+#include "ofp/yaml/jsonwriter.h"
 #include "ofp/yaml/yportnumber.h"
 #include "ofp/yaml/yportproperty.h"
 #include "ofp/yaml/ysmallcstring.h"
@@ -87,6 +88,44 @@ struct MappingTraits<ofp::Port> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::Port> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::Port &msg) {
+    using namespace ofp;
+
+    json.mapRequired("port_no", msg.portNo_);
+    json.mapRequired("hw_addr", msg.hwAddr_);
+    json.mapRequired("name", msg.name_);
+
+    OFPPortConfigFlags config = msg.config();
+    json.mapRequired("config", config);
+
+    OFPPortStateFlags state = msg.state();
+    json.mapRequired("state", state);
+
+    PropertyRange props = msg.properties();
+
+    auto eprop = props.findProperty(PortPropertyEthernet::type());
+    if (eprop != props.end()) {
+      const PortPropertyEthernet &eth = eprop->property<PortPropertyEthernet>();
+      json.mapping(RemoveConst_cast(eth));
+    } else {
+      // If property is missing, write out empty values.
+      PortPropertyEthernet empty;
+      json.mapping(empty);
+    }
+
+    auto oprop = props.findProperty(PortPropertyOptical::type());
+    if (oprop != props.end()) {
+      const PortPropertyOptical &opt = oprop->property<PortPropertyOptical>();
+      json.mapRequired("optical", RemoveConst_cast(opt));
+    }
+
+    json.mapRequired("properties",
+                     Ref_cast<ofp::detail::PortPropertyRange>(props));
+  }
+};
+
 template <>
 struct MappingTraits<ofp::PortBuilder> {
   static void mapping(IO &io, ofp::PortBuilder &msg) {
@@ -5,6 +5,7 @@
 #define OFP_YAML_YPORTSTATSPROPERTY_H_
 
 #include "ofp/portstatsproperty.h"
+#include "ofp/yaml/jsonwriter.h"
 
 namespace ofp {
 namespace detail {
@@ -33,6 +34,17 @@ struct MappingTraits<ofp::PortStatsPropertyEthernet> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::PortStatsPropertyEthernet> {
+  static void write(ofp::yaml::JsonWriter &json,
+                    ofp::PortStatsPropertyEthernet &prop) {
+    json.mapRequired("rx_frame_err", prop.rxFrameErr_);
+    json.mapRequired("rx_over_err", prop.rxOverErr_);
+    json.mapRequired("rx_crc_err", prop.rxCrcErr_);
+    json.mapRequired("collisions", prop.collisions_);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::PortStatsPropertyOptical> {
   static void mapping(IO &io, ofp::PortStatsPropertyOptical &prop) {
@@ -48,6 +48,16 @@ struct MappingTraits<ofp::PortStatus> {
   }
 };
 
+template <>
+struct JsonTraits<ofp::PortStatus> {
+  static void write(ofp::yaml::JsonWriter &json, ofp::PortStatus &msg) {
+    json.mapRequired("reason", msg.reason_);
+
+    ofp::Port &port = RemoveConst_cast(msg.port());
+    json.mapping(port);
+  }
+};
+
 template <>
 struct MappingTraits<ofp::PortStatusBuilder> {
   static void mapping(IO &io, ofp::PortStatusBuilder &msg) {
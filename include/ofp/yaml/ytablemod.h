@@ -42,7 +42,7 @@ struct MappingTraits<ofp::TableMod> {
     auto vprop = props.findProperty(ofp::TableModPropertyVacancy::type());
     if (vprop != props.end()) {
       const ofp::TableModPropertyVacancy &vac =
-          eprop->property<ofp::TableModPropertyVacancy>();
+          vprop->property<ofp::TableModPropertyVacancy>();
       io.mapRequired("vacancy", RemoveConst_cast(vac));
     }
 
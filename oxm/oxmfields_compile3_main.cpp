@@ -2,16 +2,36 @@
 // This file is distributed under the MIT License.
 /// \file
 /// \brief Program to sort OXM types by typeID and output C++ source file
-/// `oxmfieldsdata.cpp`.
+/// `oxmfieldsdata.cpp`. The output also contains perfect hash tables for
+/// looking up OXM types by name and by typeID.
 
 #include <algorithm>
 #include <iostream>
 #include <vector>
 
+#include "ofp/hash.h"
 #include "ofp/oxmfields.h"
 
 using namespace ofp;
 
+static void WriteArray(const char *name, const std::vector<UInt16> &values) {
+  std::cout << "const ofp::UInt16 ofp::" << name << "[] = {";
+  for (size_t i = 0; i < values.size(); ++i) {
+    std::cout << (i % 16 == 0 ? "\n  " : " ") << values[i] << ",";
+  }
+  std::cout << "\n};\n";
+}
+
+template <class Key>
+static void BuildHashTable(const char *name, const std::vector<Key> &keys,
+                           std::vector<UInt16> *seeds,
+                           std::vector<UInt16> *slots) {
+  if (!hash::PerfectHashBuild(keys, OXMHashTableSize, seeds, slots)) {
+    std::cerr << "Unable to build perfect hash table for " << name << '\n';
+    std::exit(1);
+  }
+}
+
 int main() {
   std::vector<OXMTypeInternalMapEntry> entries;
 
@@ -41,5 +61,37 @@ int main() {
     std::cout << "static_cast<ofp::OXMInternalID>("
               << static_cast<int>(entry.id) << ") },\n";
   }
-  std::cout << "};\n";
+  std::cout << "};\n\n";
+
+  // Hash OXM names to their index in OXMTypeInfoArray.
+  std::vector<llvm::StringRef> names;
+  for (size_t i = 0; i < OXMTypeInfoArraySize; ++i) {
+    names.push_back(OXMTypeInfoArray[i].name);
+  }
+
+  std::vector<UInt16> seeds;
+  std::vector<UInt16> slots;
+  BuildHashTable("OXMNameHash", names, &seeds, &slots);
+  WriteArray("OXMNameHashSeeds", seeds);
+  WriteArray("OXMNameHashSlots", slots);
+
+  // Hash typeIDs to the index of their first entry in OXMTypeInternalMapArray.
+  // Experimenter fields may share the same typeID.
+  std::vector<UInt32> values;
+  std::vector<UInt16> indexes;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (i == 0 || entries[i].value32 != entries[i - 1].value32) {
+      values.push_back(entries[i].value32);
+      indexes.push_back(UInt16_narrow_cast(i));
+    }
+  }
+
+  BuildHashTable("OXMTypeHash", values, &seeds, &slots);
+  for (auto &slot : slots) {
+    if (slot != hash::PerfectHashEmpty) {
+      slot = indexes[slot];
+    }
+  }
+  WriteArray("OXMTypeHashSeeds", seeds);
+  WriteArray("OXMTypeHashSlots", slots);
 }
@@ -237,6 +237,18 @@ static void WriteHeaderFile(ostream &stream, vector<OXMField> &fields) {
   stream
       << "extern const OXMTypeInternalMapEntry OXMTypeInternalMapArray[];\n\n";
 
+  // Perfect hash tables for looking up OXM names and types. These are
+  // written out by `oxmfields_compile3`.
+  size_t hashSize = 1;
+  while (hashSize < fields.size()) {
+    hashSize *= 2;
+  }
+  stream << "constexpr size_t OXMHashTableSize = " << hashSize << ";\n";
+  stream << "extern const UInt16 OXMNameHashSeeds[];\n";
+  stream << "extern const UInt16 OXMNameHashSlots[];\n";
+  stream << "extern const UInt16 OXMTypeHashSeeds[];\n";
+  stream << "extern const UInt16 OXMTypeHashSlots[];\n\n";
+
   stream << "template <class Visitor>\n";
   stream << "void OXMDispatch(OXMInternalID id, Visitor *visitor) {\n";
   stream << "  switch (id) {\n";
@@ -4,6 +4,8 @@
 #include "ofp/actiontype.h"
 
 #include "ofp/actions.h"
+#include "ofp/hash.h"
+#include "ofp/log.h"
 
 using namespace ofp;
 
@@ -27,21 +29,61 @@ static const ActionTypeInfo sActionInfo[] = {
     {ActionType{OFPAT_SET_FIELD, 0}, "SET_FIELD", 0, 0},
     {ActionType{OFPAT_EXPERIMENTER, 0}, "EXPERIMENTER", 0, 0}};
 
-bool ActionType::parse(llvm::StringRef s) {
-  for (const auto &i : sActionInfo) {
-    if (s == i.name) {
-      value32_ = i.type.value32_;
-      return true;
+namespace {
+
+// Perfect hash tables for looking up sActionInfo by name and by type.
+struct ActionInfoHash {
+  enum : size_t { Size = 32 };
+
+  std::vector<UInt16> nameSeeds;
+  std::vector<UInt16> nameSlots;
+  std::vector<UInt16> typeSeeds;
+  std::vector<UInt16> typeSlots;
+
+  ActionInfoHash() {
+    std::vector<llvm::StringRef> names;
+    std::vector<UInt32> types;
+    for (const auto &i : sActionInfo) {
+      names.push_back(i.name);
+      types.push_back(i.type);
+    }
+
+    // The keys are fixed, so a failure here is a bug in sActionInfo or in
+    // the hash function. Without the table, no action type can be parsed.
+    if (!hash::PerfectHashBuild(names, Size, &nameSeeds, &nameSlots) ||
+        !hash::PerfectHashBuild(types, Size, &typeSeeds, &typeSlots)) {
+      log::fatal("ActionInfoHash: failed to build perfect hash table");
     }
   }
+};
+
+static_assert(ArrayLength(sActionInfo) <= ActionInfoHash::Size,
+              "Unexpected size.");
+
+}  // namespace
+
+static const ActionInfoHash &GetActionInfoHash() {
+  static const ActionInfoHash table;
+  return table;
+}
+
+bool ActionType::parse(llvm::StringRef s) {
+  const ActionInfoHash &table = GetActionInfoHash();
+  UInt16 idx = hash::PerfectHashFind(s, table.nameSeeds.data(),
+                                     table.nameSlots.data(), table.Size);
+  if (idx < ArrayLength(sActionInfo) && s == sActionInfo[idx].name) {
+    value32_ = sActionInfo[idx].type.value32_;
+    return true;
+  }
   return false;
 }
 
 const ActionTypeInfo *ActionType::lookupInfo() const {
-  for (const auto &i : sActionInfo) {
-    if (value32_ == i.type) {
-      return &i;
-    }
+  const ActionInfoHash &table = GetActionInfoHash();
+  UInt16 idx = hash::PerfectHashFind(value32_, table.typeSeeds.data(),
+                                     table.typeSlots.data(), table.Size);
+  if (idx < ArrayLength(sActionInfo) && value32_ == sActionInfo[idx].type) {
+    return &sActionInfo[idx];
   }
 
   // Ignore length when checking for SET_FIELD or EXPERIMENTER actions.
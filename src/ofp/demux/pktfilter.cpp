@@ -61,3 +61,99 @@ bool PktFilter::match(ByteRange data, size_t totalLen) const {
   assert(prog_.bf_insns != nullptr);
   return pcap_offline_filter(&prog_, &hdr, data.data()) > 0;
 }
+
+void PktFilterSet::clear() {
+  filters_.clear();
+  program_.clear();
+  offsets_.clear();
+}
+
+void PktFilterSet::setFilters(const std::vector<const PktFilter *> &filters) {
+  clear();
+  filters_ = filters;
+
+  if (!merge()) {
+    log_debug("PktFilterSet: unable to merge filters; matching one at a time");
+    program_.clear();
+    offsets_.clear();
+  }
+}
+
+// The programs generated by pcap_compile never read the A or X registers or
+// scratch memory before storing to them, so a filter's program behaves the
+// same when it is entered by a jump from the end of the previous one.
+
+bool PktFilterSet::merge() {
+  if (filters_.empty())
+    return false;
+
+  for (size_t index = 0; index < filters_.size(); ++index) {
+    const struct bpf_program &prog = filters_[index]->program();
+    const UInt32 start = UInt32_narrow_cast(program_.size());
+    offsets_.push_back(start);
+
+    // An empty filter never matches; it contributes no instructions.
+    if (prog.bf_insns == nullptr)
+      continue;
+
+    for (UInt32 pc = 0; pc < prog.bf_len; ++pc) {
+      struct bpf_insn insn = prog.bf_insns[pc];
+      if (BPF_CLASS(insn.code) == BPF_RET) {
+        if (BPF_RVAL(insn.code) != BPF_K) {
+          // Return value is in a register; we can't rewrite this.
+          return false;
+        }
+        if (insn.k == 0) {
+          // No match: continue with the next filter. Jump offsets are
+          // relative to the following instruction.
+          insn.code = BPF_JMP | BPF_JA;
+          insn.jt = insn.jf = 0;
+          insn.k = prog.bf_len - pc - 1;
+        } else {
+          insn.k = UInt32_narrow_cast(index + 1);
+        }
+      }
+      program_.push_back(insn);
+    }
+  }
+
+  offsets_.push_back(UInt32_narrow_cast(program_.size()));
+
+  // No filter matched.
+  struct bpf_insn fail = {BPF_RET | BPF_K, 0, 0, 0};
+  program_.push_back(fail);
+
+  return true;
+}
+
+size_t PktFilterSet::match(ByteRange data, size_t totalLen,
+                           size_t start) const {
+  if (start >= filters_.size())
+    return npos;
+
+  if (!isMerged()) {
+    for (size_t i = start; i < filters_.size(); ++i) {
+      if (filters_[i]->match(data, totalLen))
+        return i;
+    }
+    return npos;
+  }
+
+  struct pcap_pkthdr hdr;
+  hdr.ts.tv_sec = 0;
+  hdr.ts.tv_usec = 0;
+  hdr.caplen = UInt32_narrow_cast(data.size());
+  hdr.len = UInt32_narrow_cast(totalLen);
+
+  // Jumps only go forward, so we can start in the middle of the program.
+  const UInt32 offset = offsets_[start];
+  struct bpf_program prog;
+  prog.bf_len = UInt32_narrow_cast(program_.size() - offset);
+  prog.bf_insns = const_cast<struct bpf_insn *>(&program_[offset]);
+
+  int result = pcap_offline_filter(&prog, &hdr, data.data());
+  if (result <= 0)
+    return npos;
+
+  return Unsigned_cast(result - 1);
+}
@@ -6,17 +6,16 @@
 using namespace ofp;
 
 bool OXMFullType::parse(llvm::StringRef s) {
-  // TODO(bfish): make faster
-  for (size_t i = 0; i < OXMTypeInfoArraySize; ++i) {
-    if (s == OXMTypeInfoArray[i].name) {
-      id_ = static_cast<OXMInternalID>(i);
-      type_.setValue32(OXMTypeInfoArray[i].value32);
-      experimenter_ = OXMTypeInfoArray[i].experimenter;
-      return true;
-    }
+  OXMInternalID id = OXMType::internalIDFromName(s);
+  if (id == OXMInternalID::UNKNOWN) {
+    return false;
   }
 
-  return false;
+  const OXMTypeInfo &info = OXMTypeInfoArray[static_cast<size_t>(id)];
+  id_ = id;
+  type_.setValue32(info.value32);
+  experimenter_ = info.experimenter;
+  return true;
 }
 
 std::vector<llvm::StringRef> OXMFullType::listAll() {
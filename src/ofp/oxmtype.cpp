@@ -5,11 +5,25 @@
 
 #include <algorithm>
 
+#include "ofp/hash.h"
 #include "ofp/log.h"
 #include "ofp/oxmfields.h"
 
 using namespace ofp;
 
+/// \returns First entry in OXMTypeInternalMapArray for `value32`, or nullptr
+/// if not found.
+static const OXMTypeInternalMapEntry *FindInternalMapEntry(UInt32 value32) {
+  UInt16 idx = hash::PerfectHashFind(value32, OXMTypeHashSeeds,
+                                     OXMTypeHashSlots, OXMHashTableSize);
+  if (idx < OXMTypeInfoArraySize &&
+      OXMTypeInternalMapArray[idx].value32 == value32) {
+    return &OXMTypeInternalMapArray[idx];
+  }
+
+  return nullptr;
+}
+
 const OXMTypeInfo *OXMType::lookupInfo() const {
   unsigned idx = static_cast<unsigned>(internalID());
   if (idx < OXMTypeInfoArraySize) {
@@ -33,15 +47,9 @@ OXMInternalID OXMType::internalID() const {
   // Get unmasked value before we search for it.
   UInt32 value32 = hasMask() ? withoutMask() : value32_;
 
-  const OXMTypeInternalMapEntry *begin = &OXMTypeInternalMapArray[0];
-  const OXMTypeInternalMapEntry *end = begin + OXMTypeInfoArraySize;
-
-  begin = std::lower_bound(begin, end, value32,
-                           [](const OXMTypeInternalMapEntry &item,
-                              UInt32 value) { return item.value32 < value; });
-
-  if (begin != end && begin->value32 == value32) {
-    return begin->id;
+  const OXMTypeInternalMapEntry *entry = FindInternalMapEntry(value32);
+  if (entry) {
+    return entry->id;
   }
 
   return OXMInternalID::UNKNOWN;
@@ -71,12 +79,12 @@ OXMInternalID OXMType::internalID_Experimenter(Big32 experimenter) const {
   // Get unmasked value before we search for it.
   UInt32 value32 = hasMask() ? withoutMask() : value32_;
 
-  const OXMTypeInternalMapEntry *begin = &OXMTypeInternalMapArray[0];
-  const OXMTypeInternalMapEntry *end = begin + OXMTypeInfoArraySize;
-
-  begin = std::lower_bound(begin, end, value32,
-                           [](const OXMTypeInternalMapEntry &item,
-                              UInt32 value) { return item.value32 < value; });
+  const OXMTypeInternalMapEntry *begin = FindInternalMapEntry(value32);
+  const OXMTypeInternalMapEntry *end =
+      &OXMTypeInternalMapArray[0] + OXMTypeInfoArraySize;
+  if (!begin) {
+    return OXMInternalID::UNKNOWN;
+  }
 
   // Linear search for experimenter. (TODO: Sort by experimenter also...)
   while (begin != end && begin->value32 == value32) {
@@ -88,14 +96,22 @@ OXMInternalID OXMType::internalID_Experimenter(Big32 experimenter) const {
   return OXMInternalID::UNKNOWN;
 }
 
+OXMInternalID OXMType::internalIDFromName(llvm::StringRef name) {
+  UInt16 idx = hash::PerfectHashFind(name, OXMNameHashSeeds, OXMNameHashSlots,
+                                     OXMHashTableSize);
+  if (idx < OXMTypeInfoArraySize && name == OXMTypeInfoArray[idx].name) {
+    return static_cast<OXMInternalID>(idx);
+  }
+
+  return OXMInternalID::UNKNOWN;
+}
+
 bool OXMType::parse(llvm::StringRef s) {
-  // TODO(bfish): make faster
-  for (size_t i = 0; i < OXMTypeInfoArraySize; ++i) {
-    if (s == OXMTypeInfoArray[i].name) {
-      value32_ = OXMTypeInfoArray[i].value32;
-      return true;
-    }
+  OXMInternalID id = internalIDFromName(s);
+  if (id == OXMInternalID::UNKNOWN) {
+    return false;
   }
 
-  return false;
+  value32_ = OXMTypeInfoArray[static_cast<size_t>(id)].value32;
+  return true;
 }
@@ -0,0 +1,102 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/dedupcache.h"
+
+#include "ofp/matchpacket.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+// Maximum number of flows tracked. When the cache is full, stale entries are
+// removed; if it is still full, the cache is cleared.
+const size_t kMaxDedupEntries = 65536;
+
+bool DedupCache::allow(const DatapathID &dpid, PortNumber inPort,
+                       ByteRange enetFrame, Timestamp time,
+                       UInt32 *suppressed) {
+  assert(enabled_);
+  allowed_ = nullptr;
+
+  makeKey(dpid, inPort, enetFrame, &key_);
+
+  auto iter = cache_.find(key_);
+  if (iter == cache_.end()) {
+    if (cache_.size() >= kMaxDedupEntries) {
+      expire(time);
+    }
+    iter = cache_.emplace(key_, Entry{limiter_}).first;
+  }
+
+  Entry &entry = iter->second;
+  entry.lastSeen = time;
+
+  if (!entry.limiter.allow(time)) {
+    ++entry.suppressed;
+    return false;
+  }
+
+  *suppressed = entry.suppressed;
+  allowed_ = &entry;
+
+  return true;
+}
+
+void DedupCache::escalated() {
+  assert(allowed_ != nullptr);
+  allowed_->suppressed = 0;
+  allowed_ = nullptr;
+}
+
+void DedupCache::expire(Timestamp time) {
+  TimeInterval window = limiter_.t();
+  if (window.valid()) {
+    for (auto iter = cache_.begin(); iter != cache_.end();) {
+      if (time >= iter->second.lastSeen + window) {
+        iter = cache_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  if (cache_.size() >= kMaxDedupEntries) {
+    log_warning("DedupCache: cache is full; clearing", cache_.size());
+    cache_.clear();
+  }
+}
+
+void DedupCache::makeKey(const DatapathID &dpid, PortNumber inPort,
+                         ByteRange enetFrame, std::string *key) {
+  key->assign(reinterpret_cast<const char *>(&dpid), sizeof(dpid));
+  key->append(reinterpret_cast<const char *>(&inPort), sizeof(inPort));
+
+  MatchPacket pkt{enetFrame, false};
+  for (auto &item : pkt) {
+    switch (item.type()) {
+      case OFB_ETH_DST::type():
+      case OFB_ETH_SRC::type():
+      case OFB_VLAN_VID::type():
+      case OFB_ETH_TYPE::type():
+      case OFB_IP_PROTO::type():
+      case OFB_IPV4_SRC::type():
+      case OFB_IPV4_DST::type():
+      case OFB_IPV6_SRC::type():
+      case OFB_IPV6_DST::type():
+      case OFB_TCP_SRC::type():
+      case OFB_TCP_DST::type():
+      case OFB_UDP_SRC::type():
+      case OFB_UDP_DST::type():
+      case OFB_SCTP_SRC::type():
+      case OFB_SCTP_DST::type():
+      case OFB_ARP_OP::type():
+      case OFB_ARP_SPA::type():
+      case OFB_ARP_TPA::type():
+        key->append(reinterpret_cast<const char *>(&item),
+                    sizeof(OXMType) + item.type().length());
+        break;
+      default:
+        break;
+    }
+  }
+}
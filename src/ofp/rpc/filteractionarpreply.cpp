@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/filteractionarpreply.h"
+
+#include "ofp/channel.h"
+#include "ofp/matchpacket.h"
+#include "ofp/matchpacketbuilder.h"
+#include "ofp/packetout.h"
+#include "ofp/rpc/filtertable.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+enum : UInt16 {
+  ARP_OP_REQUEST = 1,
+  ARP_OP_REPLY = 2,
+};
+
+void FilterActionArpReply::attach(FilterTable *table) {
+  arpTable_ = &table->arpTable();
+}
+
+bool FilterActionArpReply::apply(ByteRange enetFrame, PortNumber inPort,
+                                 UInt64 metadata, Message *message) {
+  if (!arpTable_) {
+    return false;
+  }
+
+  MatchPacket pkt{enetFrame};
+
+  OXMRange oxm = pkt.toRange();
+  if (!oxm.exists<OFB_ARP_OP>() || oxm.get<OFB_ARP_OP>() != ARP_OP_REQUEST) {
+    return false;
+  }
+
+  MacAddress mac;
+  if (!arpTable_->lookup(oxm.get<OFB_ARP_TPA>(), &mac)) {
+    return false;
+  }
+
+  ByteList reply;
+  if (!buildReply(oxm, mac, &reply)) {
+    return false;
+  }
+  sendPacketOut(&reply, inPort, message);
+
+  return true;
+}
+
+bool FilterActionArpReply::buildReply(OXMRange oxm, const MacAddress &mac,
+                                      ByteList *reply) {
+  MacAddress ethDst = oxm.get<OFB_ETH_SRC>();
+  MacAddress requestSha = oxm.get<OFB_ARP_SHA>();
+
+  if (ethDst.isMulticast() || requestSha.isMulticast()) {
+    log_warning("FilterActionArpReply::buildReply: invalid sender:", ethDst);
+    return false;
+  }
+
+  OXMList fields;
+  fields.add(OFB_ETH_TYPE{DATALINK_ARP});
+  fields.add(OFB_ETH_DST{ethDst});
+  fields.add(OFB_ETH_SRC{mac});
+
+  UInt16 vlan = oxm.get<OFB_VLAN_VID>();
+  if (vlan) {
+    fields.add(OFB_VLAN_VID{vlan});
+  }
+
+  fields.add(OFB_ARP_OP{ARP_OP_REPLY});
+  fields.add(OFB_ARP_SHA{mac});
+  fields.add(OFB_ARP_SPA{oxm.get<OFB_ARP_TPA>()});
+  fields.add(OFB_ARP_THA{requestSha});
+  fields.add(OFB_ARP_TPA{oxm.get<OFB_ARP_SPA>()});
+
+  MatchPacketBuilder pktBuild{fields.toRange()};
+  pktBuild.build(reply, {});
+
+  return true;
+}
+
+void FilterActionArpReply::sendPacketOut(const ByteList *data,
+                                         PortNumber outPort, Message *message) {
+  // Set flag to indicate we replied.
+  message->setMsgFlags(message->msgFlags() | OFP_REPLIED);
+
+  ActionList actions;
+  actions.add(AT_OUTPUT{outPort});
+
+  PacketOutBuilder packetOut;
+  packetOut.setInPort(OFPP_CONTROLLER);
+  packetOut.setActions(actions);
+  packetOut.setEnetFrame(*data);
+  packetOut.send(message->source());
+}
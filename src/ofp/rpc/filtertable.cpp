@@ -8,9 +8,24 @@
 
 using namespace ofp::rpc;
 
+void FilterTable::setFilters(std::vector<FilterTableEntry> &&filters) {
+  table_ = std::move(filters);
+
+  std::vector<const demux::PktFilter *> pktFilters;
+  pktFilters.reserve(table_.size());
+  for (auto &entry : table_) {
+    entry.attach(this);
+    pktFilters.push_back(&entry.filter());
+  }
+
+  filterSet_.setFilters(pktFilters);
+}
+
 // Apply an OF message against the filter table.
 //
 // We apply the message against each table entry in order until one matches.
+// The packet filters of all entries are matched in one pass by `filterSet_`;
+// if an entry's action doesn't match, we resume with the entry after it.
 //
 // For a filter entry F, F(M, escalate) returns true when the filter criteria
 // and action matches the message. A filter entry that matches may modify the
@@ -34,10 +49,12 @@ bool FilterTable::apply(Message *message, bool *escalate) {
   PortNumber inPort = packetIn->inPort();
   UInt64 metadata = packetIn->metadata();
 
-  for (auto &entry : table_) {
-    if (entry.apply(data, inPort, metadata, message, escalate)) {
+  size_t index = filterSet_.match(data);
+  while (index != demux::PktFilterSet::npos) {
+    if (table_[index].applyAction(data, inPort, metadata, message, escalate)) {
       return true;
     }
+    index = filterSet_.match(data, data.size(), index + 1);
   }
 
   return false;
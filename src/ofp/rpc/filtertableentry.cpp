@@ -3,6 +3,7 @@
 
 #include "ofp/rpc/filtertableentry.h"
 
+#include "ofp/channel.h"
 #include "ofp/message.h"
 #include "ofp/rpc/filteraction.h"
 
@@ -10,13 +11,19 @@ using namespace ofp::rpc;
 
 bool FilterTableEntry::apply(ByteRange data, PortNumber inPort, UInt64 metadata,
                              Message *message, bool *escalate) {
-  assert(message->type() == OFPT_PACKET_IN);
-
   if (!pktFilter_.match(data)) {
     log_debug("FilterTableEntry::apply - data doesn't match filter");
     return false;
   }
 
+  return applyAction(data, inPort, metadata, message, escalate);
+}
+
+bool FilterTableEntry::applyAction(ByteRange data, PortNumber inPort,
+                                   UInt64 metadata, Message *message,
+                                   bool *escalate) {
+  assert(message->type() == OFPT_PACKET_IN);
+
   if (action_) {
     if (!action_->apply(data, inPort, metadata, message)) {
       log_debug("FilterTableEntry::apply - action doesn't match");
@@ -24,7 +31,42 @@ bool FilterTableEntry::apply(ByteRange data, PortNumber inPort, UInt64 metadata,
     }
   }
 
-  *escalate = escalate_.allow(message->time());
+  if (dedup_.enabled() || limit_.enabled()) {
+    *escalate = allowEscalate(data, inPort, message);
+  } else {
+    *escalate = escalate_.allow(message->time());
+  }
+  ++hits_;
+
+  return true;
+}
+
+bool FilterTableEntry::allowEscalate(ByteRange data, PortNumber inPort,
+                                     Message *message) {
+  Channel *channel = message->source();
+  DatapathID dpid = channel ? channel->datapathId() : DatapathID{};
+  Timestamp time = message->time();
 
+  UInt32 suppressed = 0;
+  if (dedup_.enabled() &&
+      !dedup_.allow(dpid, inPort, data, time, &suppressed)) {
+    return false;
+  }
+
+  // Duplicates don't count against the escalate limits. Check the
+  // per-datapath limit first, so a message it denies doesn't use up the
+  // shared escalate limit.
+  if (limit_.enabled() && !limit_.allow(dpid, inPort, time)) {
+    return false;
+  }
+
+  if (!escalate_.allow(time)) {
+    return false;
+  }
+
+  if (dedup_.enabled()) {
+    dedup_.escalated();
+  }
+  message->setDuplicates(suppressed);
   return true;
 }
@@ -0,0 +1,351 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/messagetemplate.h"
+
+#include "ofp/header.h"
+#include "ofp/ipv6address.h"
+#include "ofp/macaddress.h"
+#include "ofp/yaml/encoder.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+namespace {
+
+using SlotType = MessageTemplate::SlotType;
+
+// Probe values used to locate a slot in the encoded message. Every byte of
+// the first value encodes as 0x11 and every byte of the second as 0x22. The
+// integer probes are listed from widest to narrowest, since a narrow value
+// also fits in a wider field.
+struct Probe {
+  SlotType type;
+  UInt8 size;
+  const char *first;
+  const char *second;
+};
+
+const Probe kProbes[] = {
+    {SlotType::Integer, 8, "0x1111111111111111", "0x2222222222222222"},
+    {SlotType::Integer, 4, "0x11111111", "0x22222222"},
+    {SlotType::Integer, 2, "0x1111", "0x2222"},
+    {SlotType::Integer, 1, "0x11", "0x22"},
+    {SlotType::MacAddress, 6, "11:11:11:11:11:11", "22:22:22:22:22:22"},
+    {SlotType::IPv6Address, 16, "1111:1111:1111:1111:1111:1111:1111:1111",
+     "2222:2222:2222:2222:2222:2222:2222:2222"},
+    {SlotType::IPv4Address, 4, "17.17.17.17", "34.34.34.34"},
+};
+
+// Values used to check that a slot is stored exactly as its value, once the
+// probes have located it. Every byte of a check value is different.
+const char *const kIntegerChecks[] = {
+    nullptr, "0x01", "0x0102", nullptr, "0x01020304", nullptr,
+    nullptr, nullptr, "0x0102030405060708"};
+
+// Values one past the largest value that fits in an integer slot of each size.
+// A field that accepts one of these is wider than the slot.
+const char *const kIntegerOverflows[] = {
+    nullptr, "0x100", "0x10000", nullptr, "0x100000000"};
+
+const char *checkValue(SlotType type, size_t size) {
+  switch (type) {
+    case SlotType::Integer:
+      return kIntegerChecks[size];
+    case SlotType::MacAddress:
+      return "01:23:45:67:89:ab";
+    case SlotType::IPv4Address:
+      return "1.2.3.4";
+    case SlotType::IPv6Address:
+      return "2001:db8:1:2:3:4:5:6";
+  }
+  return nullptr;
+}
+
+inline bool isSlotChar(char ch, bool first) {
+  auto uch = static_cast<unsigned char>(ch);
+  return uch == '_' || std::isalpha(uch) || (!first && std::isdigit(uch));
+}
+
+/// Replace each `$name` in `text` with the value of the named slot. If
+/// `probe` is not null, use it as the value of the slot at `index`. Return
+/// false and set `error` if a slot name is unknown. If `used` is not null,
+/// mark each slot that appears in the text.
+bool substitute(const std::string &text, const std::vector<TemplateSlot> &slots,
+                size_t index, const char *probe, std::string *result,
+                std::string *error, std::vector<bool> *used = nullptr) {
+  result->clear();
+  result->reserve(text.size());
+
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t dollar = text.find('$', pos);
+    if (dollar == std::string::npos) {
+      break;
+    }
+
+    size_t end = dollar + 1;
+    while (end < text.size() && isSlotChar(text[end], end == dollar + 1)) {
+      ++end;
+    }
+
+    result->append(text, pos, dollar - pos);
+    pos = end;
+
+    if (end == dollar + 1) {
+      // Not a slot; copy the '$' as is.
+      result->push_back('$');
+      continue;
+    }
+
+    llvm::StringRef name{&text[dollar + 1], end - dollar - 1};
+    auto iter = std::find_if(
+        slots.begin(), slots.end(),
+        [name](const TemplateSlot &slot) { return slot.name == name; });
+    if (iter == slots.end()) {
+      *error = "unknown slot '$" + name.str() + "'";
+      return false;
+    }
+
+    size_t slotIndex = Unsigned_cast(iter - slots.begin());
+    if (used) {
+      (*used)[slotIndex] = true;
+    }
+
+    if (probe && slotIndex == index) {
+      result->append(probe);
+    } else {
+      result->append(iter->value);
+    }
+  }
+
+  result->append(text, pos, std::string::npos);
+  return true;
+}
+
+}  // namespace
+
+std::string MessageTemplate::compile(const std::string &text,
+                                     const std::vector<TemplateSlot> &slots) {
+  data_.clear();
+  slots_.clear();
+
+  std::string error;
+  std::string input;
+  std::vector<bool> used(slots.size());
+  if (!substitute(text, slots, 0, nullptr, &input, &error, &used)) {
+    return error;
+  }
+
+  for (size_t i = 0; i < slots.size(); ++i) {
+    if (!used[i]) {
+      return "slot '$" + slots[i].name + "' is not used";
+    }
+  }
+
+  yaml::Encoder encoder{input};
+  if (!encoder.error().empty()) {
+    return encoder.error();
+  }
+
+  data_.set(encoder.data(), encoder.size());
+
+  for (size_t i = 0; i < slots.size(); ++i) {
+    Slot slot;
+    slot.name = slots[i].name;
+    if (!findSlot(text, slots, i, &slot)) {
+      data_.clear();
+      slots_.clear();
+      return "slot '$" + slot.name +
+             "' must be a fixed size integer, MAC address or IP address field";
+    }
+    if (!verifySlot(text, slots, i, slot)) {
+      data_.clear();
+      slots_.clear();
+      return "slot '$" + slot.name +
+             "' is not stored exactly as its value in the encoded message";
+    }
+    slots_.push_back(std::move(slot));
+  }
+
+  return "";
+}
+
+UInt8 MessageTemplate::version() const {
+  return data_.empty() ? 0 : *data_.data();
+}
+
+std::string MessageTemplate::instantiate(const std::vector<std::string> &values,
+                                         UInt32 xid, ByteList *msg) const {
+  if (values.size() > slots_.size()) {
+    return "too many slot values: expected " + std::to_string(slots_.size());
+  }
+
+  msg->set(data_.data(), data_.size());
+
+  UInt8 *data = msg->mutableData();
+  reinterpret_cast<Header *>(data)->setXid(xid);
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    const Slot &slot = slots_[i];
+    UInt8 buf[IPv6Address::Length];
+    if (!parseValue(slot, values[i], buf)) {
+      return "invalid value for slot '$" + slot.name + "': " + values[i];
+    }
+    for (UInt16 offset : slot.offsets) {
+      std::memcpy(data + offset, buf, slot.size);
+    }
+  }
+
+  return "";
+}
+
+/// Encode the template with each probe value in the slot at `index` to find
+/// the slot's type and offsets. Return false if no probe fits.
+bool MessageTemplate::findSlot(const std::string &text,
+                               const std::vector<TemplateSlot> &slots,
+                               size_t index, Slot *slot) const {
+  std::string error;
+  std::string input;
+
+  for (const Probe &probe : kProbes) {
+    if (!substitute(text, slots, index, probe.first, &input, &error))
+      continue;
+    yaml::Encoder first{input};
+    if (!first.error().empty() || first.size() != data_.size())
+      continue;
+
+    if (!substitute(text, slots, index, probe.second, &input, &error))
+      continue;
+    yaml::Encoder second{input};
+    if (!second.error().empty() || second.size() != data_.size())
+      continue;
+
+    // Every byte that differs between the two encodings must belong to a
+    // whole copy of the probe value.
+    const UInt8 *a = first.data();
+    const UInt8 *b = second.data();
+    const size_t size = data_.size();
+
+    std::vector<UInt16> offsets;
+    bool valid = true;
+    size_t i = 0;
+    while (i < size && valid) {
+      if (a[i] == b[i]) {
+        ++i;
+        continue;
+      }
+      if (i + probe.size > size) {
+        valid = false;
+        break;
+      }
+      for (size_t j = i; j < i + probe.size; ++j) {
+        if (a[j] != 0x11 || b[j] != 0x22) {
+          valid = false;
+          break;
+        }
+      }
+      offsets.push_back(UInt16_narrow_cast(i));
+      i += probe.size;
+    }
+
+    if (valid && !offsets.empty()) {
+      slot->offsets = std::move(offsets);
+      slot->type = probe.type;
+      slot->size = probe.size;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/// Check that the slot at `index` holds its value exactly. A probe may locate
+/// only part of a field, or a field that the encoder transforms (e.g. an
+/// OpenFlow 1.0 match clears OFPVID_PRESENT from vlan_vid). Patching such a
+/// slot would produce a different message than encoding the value, so the
+/// template is rejected.
+bool MessageTemplate::verifySlot(const std::string &text,
+                                 const std::vector<TemplateSlot> &slots,
+                                 size_t index, const Slot &slot) const {
+  std::string error;
+  std::string input;
+
+  // Patching in the check value must produce the same message as encoding it.
+  const char *check = checkValue(slot.type, slot.size);
+  assert(check != nullptr);
+  if (!substitute(text, slots, index, check, &input, &error))
+    return false;
+  yaml::Encoder encoded{input};
+  if (!encoded.error().empty() || encoded.size() != data_.size())
+    return false;
+
+  UInt8 buf[IPv6Address::Length];
+  if (!parseValue(slot, check, buf))
+    return false;
+  ByteList patched{data_};
+  for (UInt16 offset : slot.offsets) {
+    std::memcpy(patched.mutableData() + offset, buf, slot.size);
+  }
+  if (std::memcmp(patched.data(), encoded.data(), data_.size()) != 0)
+    return false;
+
+  // An integer field must not accept a value that is too big for the slot.
+  if (slot.type == SlotType::Integer && slot.size < sizeof(UInt64)) {
+    if (!substitute(text, slots, index, kIntegerOverflows[slot.size], &input,
+                    &error))
+      return false;
+    yaml::Encoder overflow{input};
+    if (overflow.error().empty())
+      return false;
+  }
+
+  return true;
+}
+
+/// Convert a slot value to its wire representation in `buf`.
+bool MessageTemplate::parseValue(const Slot &slot, const std::string &value,
+                                 UInt8 *buf) {
+  switch (slot.type) {
+    case SlotType::Integer: {
+      UInt64 n;
+      if (llvm::StringRef{value}.getAsInteger(0, n)) {
+        return false;
+      }
+      if (slot.size < sizeof(n) && (n >> (8 * slot.size)) != 0) {
+        return false;
+      }
+      for (size_t i = slot.size; i > 0; --i) {
+        buf[i - 1] = n & 0xFFu;
+        n >>= 8;
+      }
+      return true;
+    }
+    case SlotType::MacAddress: {
+      MacAddress addr;
+      if (!addr.parse(value)) {
+        return false;
+      }
+      std::memcpy(buf, addr.toArray().data(), MacAddress::Length);
+      return true;
+    }
+    case SlotType::IPv4Address: {
+      IPv4Address addr;
+      if (!addr.parse(value)) {
+        return false;
+      }
+      std::memcpy(buf, addr.toArray().data(), IPv4Address::Length);
+      return true;
+    }
+    case SlotType::IPv6Address: {
+      IPv6Address addr;
+      if (!addr.parse(value)) {
+        return false;
+      }
+      std::memcpy(buf, addr.toArray().data(), IPv6Address::Length);
+      return true;
+    }
+  }
+
+  return false;
+}
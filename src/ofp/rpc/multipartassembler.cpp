@@ -0,0 +1,155 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/multipartassembler.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+// In a decoded multipart reply, `msg` is the last attribute.
+constexpr llvm::StringLiteral kMsgListKey{",\"msg\":["};
+constexpr llvm::StringLiteral kMsgListEnd{"]}"};
+
+bool MultipartAssembler::add(UInt64 connId, UInt32 xid, bool more,
+                             llvm::StringRef event, TimePoint now,
+                             std::vector<std::string> *events) {
+  llvm::StringRef prefix;
+  llvm::StringRef body;
+  if (!enabled() || !splitEvent(event, &prefix, &body)) {
+    return false;
+  }
+
+  auto iter = entries_.find(Key{connId, xid});
+  if (iter == entries_.end()) {
+    // A reply that fits in one message is sent unchanged.
+    if (!more || bytes_ + event.size() > limit_ ||
+        event.size() > maxEventSize_) {
+      return false;
+    }
+    start(&entries_[Key{connId, xid}], prefix, body, now);
+    return true;
+  }
+
+  // Size of the event once this fragment is added. While more fragments
+  // follow, that is a partial reply with the prefix of the first fragment.
+  // The merged reply uses the prefix of the last fragment.
+  Entry &entry = iter->second;
+  size_t eventSize = (more ? entry.prefix.size() : prefix.size()) +
+                     entry.body.size() + body.size() + kMsgListEnd.size();
+  if (!entry.body.empty() && !body.empty()) {
+    ++eventSize;
+  }
+
+  if (bytes_ + body.size() + 1 > limit_ || eventSize > maxEventSize_) {
+    // Out of space; send what we have so far as a partial reply.
+    flushEntry(&entry, events);
+    if (!more || bytes_ + event.size() > limit_ ||
+        event.size() > maxEventSize_) {
+      entries_.erase(iter);
+      return false;
+    }
+    start(&entry, prefix, body, now);
+    return true;
+  }
+
+  if (!body.empty()) {
+    if (!entry.body.empty()) {
+      entry.body += ',';
+      ++bytes_;
+    }
+    entry.body.append(body.data(), body.size());
+    bytes_ += body.size();
+  }
+
+  if (more) {
+    return true;
+  }
+
+  // The last fragment supplies the attributes of the merged reply.
+  std::string merged;
+  merged.reserve(prefix.size() + entry.body.size() + kMsgListEnd.size());
+  merged.append(prefix.data(), prefix.size());
+  merged += entry.body;
+  merged.append(kMsgListEnd.data(), kMsgListEnd.size());
+  events->push_back(std::move(merged));
+
+  bytes_ -= entry.size();
+  entries_.erase(iter);
+
+  return true;
+}
+
+void MultipartAssembler::expire(TimePoint now,
+                                std::vector<std::string> *events) {
+  for (auto iter = entries_.begin(); iter != entries_.end();) {
+    if (now - iter->second.started >= timeout_) {
+      flushEntry(&iter->second, events);
+      iter = entries_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void MultipartAssembler::flush(UInt64 connId,
+                               std::vector<std::string> *events) {
+  for (auto iter = entries_.begin(); iter != entries_.end();) {
+    if (iter->first.connId == connId) {
+      flushEntry(&iter->second, events);
+      iter = entries_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+TimePoint MultipartAssembler::nextExpiry() const {
+  assert(!entries_.empty());
+
+  TimePoint oldest = TimePoint::max();
+  for (const auto &iter : entries_) {
+    oldest = std::min(oldest, iter.second.started);
+  }
+
+  return oldest + timeout_;
+}
+
+void MultipartAssembler::start(Entry *entry, llvm::StringRef prefix,
+                               llvm::StringRef body, TimePoint now) {
+  entry->prefix = prefix.str();
+  entry->body = body.str();
+  entry->started = now;
+  bytes_ += entry->size();
+}
+
+/// Append the partial reply in `entry` to `events` and release its buffer.
+void MultipartAssembler::flushEntry(Entry *entry,
+                                    std::vector<std::string> *events) {
+  bytes_ -= entry->size();
+
+  entry->prefix += entry->body;
+  entry->prefix.append(kMsgListEnd.data(), kMsgListEnd.size());
+  events->push_back(std::move(entry->prefix));
+
+  entry->prefix.clear();
+  entry->body.clear();
+}
+
+/// Split the JSON text of a multipart reply into the part before the list
+/// elements of `msg` (including the opening bracket) and the list elements.
+/// Return false if `msg` is not a list.
+bool MultipartAssembler::splitEvent(llvm::StringRef event,
+                                    llvm::StringRef *prefix,
+                                    llvm::StringRef *body) {
+  // Quotes inside JSON strings are escaped, so the first match is the key.
+  size_t pos = event.find(kMsgListKey);
+  if (pos == llvm::StringRef::npos || !event.endswith(kMsgListEnd)) {
+    return false;
+  }
+
+  pos += kMsgListKey.size();
+  *prefix = event.take_front(pos);
+  *body = event.slice(pos, event.size() - kMsgListEnd.size());
+
+  return true;
+}
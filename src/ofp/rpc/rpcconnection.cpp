@@ -8,6 +8,7 @@
 
 #include "ofp/channel.h"
 #include "ofp/rpc/rpcencoder.h"
+#include "ofp/rpc/rpcevents.h"
 #include "ofp/sys/engine.h"
 #include "ofp/yaml/decoder.h"
 #include "ofp/yaml/encoder.h"
@@ -15,8 +16,19 @@
 using namespace ofp;
 using namespace ofp::rpc;
 
-RpcConnection::RpcConnection(RpcServer *server)
-    : server_{server}, metricTimer_{server->engine()->io()} {
+// For `OFP.MESSAGE` notification event.
+constexpr llvm::StringLiteral kMsgPrefix{"{\"params\":"};
+constexpr llvm::StringLiteral kMsgSuffix{",\"method\":\"OFP.MESSAGE\"}"};
+
+RpcConnection::RpcConnection(RpcServer *server, bool binaryProtocol)
+    : server_{server},
+      metricTimer_{server->engine()->io()},
+      multipartTimer_{server->engine()->io()},
+      multipart_{server->multipartLimit(), server->multipartTimeout(),
+                 RPC_MAX_MESSAGE_SIZE - kMsgPrefix.size() - kMsgSuffix.size()},
+      binaryProtocol_{binaryProtocol},
+      lineBuffer_{RPC_MAX_MESSAGE_SIZE, RPC_EVENT_DELIMITER_CHAR} {
+  decoder_.setBase64Bytes(server->base64Bytes());
   server_->onConnect(this);
 }
 
@@ -56,6 +68,22 @@ void RpcConnection::onRpcSetFilter(RpcSetFilter *set) {
   server_->onRpcSetFilter(this, set);
 }
 
+void RpcConnection::onRpcAddTemplate(RpcAddTemplate *add) {
+  server_->onRpcAddTemplate(this, add);
+}
+
+void RpcConnection::onRpcSendTemplate(RpcSendTemplate *send) {
+  server_->onRpcSendTemplate(this, send);
+}
+
+void RpcConnection::onRpcMetrics(RpcMetrics *metrics) {
+  server_->onRpcMetrics(this, metrics);
+}
+
+void RpcConnection::onRpcSetArpTable(RpcSetArpTable *set) {
+  server_->onRpcSetArpTable(this, set);
+}
+
 void RpcConnection::onChannelUp(Channel *channel) {
   RpcChannel notification;
   notification.params.type = "CHANNEL_UP";
@@ -75,6 +103,13 @@ void RpcConnection::onChannelUp(Channel *channel) {
 }
 
 void RpcConnection::onChannelDown(Channel *channel) {
+  if (multipart_.pending() > 0) {
+    // Send any partial multipart replies before the CHANNEL_DOWN event.
+    std::vector<std::string> events;
+    multipart_.flush(channel->connectionId(), &events);
+    writeMultipartEvents(events);
+  }
+
   RpcChannel notification;
   notification.params.type = "CHANNEL_DOWN";
   notification.params.time = Timestamp::now();
@@ -87,24 +122,82 @@ void RpcConnection::onChannelDown(Channel *channel) {
 }
 
 void RpcConnection::onMessage(Channel *channel, const Message *message) {
-  // useJson = true, pktMatch = true
-  yaml::Decoder decoder{message, true, true};
-
-  if (decoder.error().empty()) {
-    // Send `OFP.MESSAGE` notification event.
-    writeEvent(decoder.result(), true);
-
+  bool decoded;
+  if (message->type() == OFPT_MULTIPART_REPLY && multipart_.enabled()) {
+    decoded = decoder_.decode(message);
+    if (decoded) {
+      onMultipartReply(channel, message, decoder_.result());
+    }
   } else {
+    // Send `OFP.MESSAGE` notification event. PACKET_IN events may be dropped
+    // if the output queue overflows.
+    decoded = writeMessageEvent(message, message->type() == OFPT_PACKET_IN);
+  }
+
+  if (!decoded) {
     // Send `CHANNEL_ALERT` notification event.
-    auto alert = std::string("DECODE FAILED: ") + decoder.error();
+    ++decodeErrors_;
+    auto alert = std::string("DECODE FAILED: ") + decoder_.error();
     rpcAlert(channel, alert, {message->data(), message->size()},
              message->time(), message->xid());
 
-    log_error("OpenFlow parse error:", decoder.error(),
+    log_error("OpenFlow parse error:", decoder_.error(),
               std::make_pair("connid", message->source()->connectionId()));
   }
 }
 
+/// Buffer a fragment of a multipart reply. Send the merged reply when the
+/// last fragment arrives.
+void RpcConnection::onMultipartReply(Channel *channel, const Message *message,
+                                     llvm::StringRef event) {
+  UInt64 connId = channel ? channel->connectionId() : 0;
+  bool more = (message->msgFlags() & OFP_MORE) != 0;
+
+  std::vector<std::string> events;
+  bool buffered = multipart_.add(connId, message->xid(), more, event,
+                                 TimeClock::now(), &events);
+  writeMultipartEvents(events);
+
+  if (!buffered) {
+    writeEvent(event, true);
+  }
+
+  asyncMultipartExpire();
+}
+
+void RpcConnection::writeMultipartEvents(
+    const std::vector<std::string> &events) {
+  for (const auto &event : events) {
+    writeEvent(event, true);
+  }
+}
+
+/// Start the timer that flushes partial multipart replies, unless it is
+/// already running or there is nothing to flush.
+void RpcConnection::asyncMultipartExpire() {
+  if (multipartTimerActive_ || multipart_.pending() == 0)
+    return;
+
+  auto self(shared_from_this());
+
+  multipartTimerActive_ = true;
+  multipartTimer_.expires_at(multipart_.nextExpiry());
+  multipartTimer_.async_wait([this, self](const asio::error_code &err) {
+    // Check for cancelled operation first.
+    if (err == asio::error::operation_aborted) {
+      return;
+    }
+
+    multipartTimerActive_ = false;
+    if (!err) {
+      std::vector<std::string> events;
+      multipart_.expire(TimeClock::now(), &events);
+      writeMultipartEvents(events);
+      asyncMultipartExpire();
+    }
+  });
+}
+
 void RpcConnection::rpcAlert(Channel *channel, const std::string &alert,
                              const ByteRange &data, const Timestamp &time,
                              UInt32 xid) {
@@ -136,14 +229,268 @@ void RpcConnection::rpcAlert(const DatapathID &datapathId, UInt64 connId,
   rpcReply(&messageAlert);
 }
 
-void RpcConnection::handleEvent(const std::string &eventText) {
+void RpcConnection::handleEvent(llvm::StringRef eventText) {
   ++rxEvents_;
   rxBytes_ += eventText.size() + 1;  // include delimiter char
 
   RpcEncoder encoder{eventText, this,
                      [this](UInt64 connId, const DatapathID &datapathId) {
                        return server_->findDatapath(connId, datapathId);
-                     }};
+                     },
+                     &parser_};
+}
+
+/// Return the free space at the end of the text input buffer. If the buffer
+/// is full, move the partial line to the front, growing the buffer if needed.
+asio::mutable_buffer RpcConnection::inputSpace() {
+  size_t size;
+  UInt8 *data = lineBuffer_.prepare(&size);
+  return asio::buffer(data, size);
+}
+
+/// Handle each complete line in the text input buffer after `bytesRead` more
+/// bytes have been read into `inputSpace()`. Return false if the remaining
+/// partial line is too big.
+bool RpcConnection::inputReceived(size_t bytesRead) {
+  lineBuffer_.received(bytesRead);
+
+  llvm::StringRef line;
+  while (lineBuffer_.nextLine(&line)) {
+    log::trace_rpc("Read RPC", 0, line.data(), line.size());
+    handleEvent(line);
+  }
+
+  return !lineBuffer_.overflow();
+}
+
+void RpcConnection::writeEvent(llvm::StringRef msg, bool ofp_message,
+                               bool droppable) {
+  if (outputClosed_)
+    return;
+
+  ByteList &outgoing = outgoing_[outgoingIdx_];
+  size_t start = beginEvent();
+
+  if (ofp_message) {
+    outgoing.add(kMsgPrefix.data(), kMsgPrefix.size());
+    outgoing.add(msg.data(), msg.size());
+    outgoing.add(kMsgSuffix.data(), kMsgSuffix.size());
+  } else {
+    outgoing.add(msg.data(), msg.size());
+  }
+
+  endEvent(start, droppable);
+}
+
+/// Decode `message` directly into the output buffer as an `OFP.MESSAGE`
+/// event. Return false if the message can't be decoded; nothing is written.
+bool RpcConnection::writeMessageEvent(const Message *message, bool droppable) {
+  if (outputClosed_)
+    return true;
+
+  ByteList &outgoing = outgoing_[outgoingIdx_];
+  size_t start = beginEvent();
+
+  outgoing.add(kMsgPrefix.data(), kMsgPrefix.size());
+  if (!decoder_.decode(message, &outgoing)) {
+    outgoing.resize(start);
+    return false;
+  }
+  outgoing.add(kMsgSuffix.data(), kMsgSuffix.size());
+
+  endEvent(start, droppable);
+  return true;
+}
+
+/// Start a new event at the end of the output buffer. Return its offset.
+size_t RpcConnection::beginEvent() {
+  ByteList &outgoing = outgoing_[outgoingIdx_];
+  size_t start = outgoing.size();
+
+  if (binaryProtocol_) {
+    // Reserve space for the binary header; endEvent() fills it in.
+    outgoing.addUninitialized(sizeof(Big32));
+  }
+
+  return start;
+}
+
+/// Finish the event that begins at offset `start` in the output buffer. If
+/// the output queue overflows, the event may be removed again.
+void RpcConnection::endEvent(size_t start, bool droppable) {
+  ByteList &outgoing = outgoing_[outgoingIdx_];
+  size_t msgSize = outgoing.size() - start;
+  if (binaryProtocol_) {
+    msgSize -= sizeof(Big32);
+  }
+
+  // The binary header only has 24 bits for the size, and the client may
+  // reject an event bigger than RPC_MAX_MESSAGE_SIZE.
+  if (msgSize > RPC_MAX_MESSAGE_SIZE) {
+    log_error("RPC event too large; dropped", msgSize);
+    outgoing.resize(start);
+    return;
+  }
+
+  if (binaryProtocol_) {
+    // Fill in binary header.
+    Big32 hdr = UInt32_narrow_cast((msgSize << 8) | RPC_EVENT_BINARY_TAG);
+    std::memcpy(outgoing.mutableData() + start, &hdr, sizeof(hdr));
+  } else {
+    const UInt8 delimiter = RPC_EVENT_DELIMITER_CHAR;
+    outgoing.add(&delimiter, sizeof(delimiter));
+  }
+
+  size_t eventSize = outgoing.size() - start;
+
+  size_t limit = server_->outputLimit();
+  if (limit > 0 && outgoingBufferSize() > limit) {
+    if (!handleOverflow(eventSize, droppable)) {
+      outgoing.resize(start);
+      return;
+    }
+  }
+
+  ++txEvents_;
+  txBytes_ += msgSize;
+
+  if (limit > 0 && server_->overflowPolicy() == RpcOverflowPolicy::DROP) {
+    pending_.push_back({UInt32_narrow_cast(eventSize), droppable});
+  }
+
+  maxOutgoingSize_ = std::max(maxOutgoingSize_, outgoingBufferSize());
+
+  if (!writing_) {
+    asyncWrite();
+  }
+}
+
+void RpcConnection::asyncWrite() {
+  assert(!writing_);
+
+  int idx = outgoingIdx_;
+  outgoingIdx_ = !outgoingIdx_;
+  writing_ = true;
+  pending_.clear();
+
+  asyncWriteData(outgoing_[idx].data(), outgoing_[idx].size());
+}
+
+void RpcConnection::asyncWriteCompleted(size_t bytesWritten) {
+  assert(writing_);
+  assert(bytesWritten == outgoing_[!outgoingIdx_].size());
+
+  writing_ = false;
+  outgoing_[!outgoingIdx_].clear();
+
+  size_t limit = server_->outputLimit();
+  if (limit > 0) {
+    if (server_->overflowPolicy() == RpcOverflowPolicy::BLOCK) {
+      // Resume reading once the output queue has drained to the low
+      // watermark.
+      if (outgoingBufferSize() <= server_->outputLowWater()) {
+        server_->engine()->setReadPaused(false);
+      }
+    } else if (outgoingBufferSize() <= limit && unreportedDrops_ > 0) {
+      reportDroppedEvents();
+    }
+  }
+
+  if (!writing_ && !outgoing_[outgoingIdx_].empty()) {
+    // Start another async write for the other output buffer.
+    asyncWrite();
+  }
+}
+
+/// Apply the overflow policy when the event of `eventSize` bytes just added to
+/// the output buffer exceeds the output limit. Return true if the event should
+/// still be queued.
+bool RpcConnection::handleOverflow(size_t eventSize, bool droppable) {
+  switch (server_->overflowPolicy()) {
+    case RpcOverflowPolicy::BLOCK:
+      // Queue the event, but stop reading from channels until the output
+      // queue drains.
+      server_->engine()->setReadPaused(true);
+      return true;
+
+    case RpcOverflowPolicy::DROP:
+      // Only PACKET_IN events may be dropped; always queue other events.
+      return !droppable || dropPendingEvents(eventSize);
+
+    case RpcOverflowPolicy::DISCONNECT:
+      log_error("RPC output queue limit exceeded; closing RPC connection",
+                outgoingBufferSize());
+      outputClosed_ = true;
+      close();
+      return false;
+  }
+
+  return true;
+}
+
+/// Make room for the new droppable event at the end of the pending output
+/// buffer by removing the oldest droppable events before it. If there isn't
+/// enough room, drop the new event instead. Return true if the new event
+/// should be queued.
+bool RpcConnection::dropPendingEvents(size_t eventSize) {
+  size_t excess = outgoingBufferSize() - server_->outputLimit();
+
+  size_t droppableSize = 0;
+  for (const auto &event : pending_) {
+    if (event.droppable) {
+      droppableSize += event.size;
+    }
+  }
+
+  if (droppableSize < excess) {
+    ++droppedEvents_;
+    ++unreportedDrops_;
+    return false;
+  }
+
+  // Compact the pending buffer in one pass, skipping over the oldest
+  // droppable events until we have freed enough space.
+  ByteList &outgoing = outgoing_[outgoingIdx_];
+  UInt8 *data = outgoing.mutableData();
+  size_t readPos = 0;
+  size_t writePos = 0;
+  size_t freed = 0;
+
+  auto out = pending_.begin();
+  for (const auto &event : pending_) {
+    if (event.droppable && freed < excess) {
+      freed += event.size;
+      ++droppedEvents_;
+      ++unreportedDrops_;
+    } else {
+      if (writePos != readPos) {
+        std::memmove(data + writePos, data + readPos, event.size);
+      }
+      writePos += event.size;
+      *out++ = event;
+    }
+    readPos += event.size;
+  }
+
+  // Move the new event down after the remaining events.
+  assert(readPos + eventSize == outgoing.size());
+  if (writePos != readPos) {
+    std::memmove(data + writePos, data + readPos, eventSize);
+  }
+
+  pending_.erase(out, pending_.end());
+  outgoing.resize(writePos + eventSize);
+
+  return true;
+}
+
+void RpcConnection::reportDroppedEvents() {
+  std::string alert = "RPC output queue full: dropped " +
+                      std::to_string(unreportedDrops_) + " PACKET_IN events";
+  log_warning(alert);
+  unreportedDrops_ = 0;
+
+  rpcAlert(DatapathID{}, 0, alert, {}, Timestamp::now());
 }
 
 void RpcConnection::rpcRequestInvalid(llvm::StringRef errorMsg) {
@@ -164,6 +511,17 @@ void RpcConnection::asyncMetrics(Milliseconds interval) {
   });
 }
 
+void RpcConnection::collectMetrics(RpcEventMetrics *metrics) const {
+  metrics->txEvents = txEvents_;
+  metrics->rxEvents = rxEvents_;
+  metrics->txBytes = txBytes_;
+  metrics->rxBytes = rxBytes_;
+  metrics->droppedEvents = droppedEvents_;
+  metrics->decodeErrors = decodeErrors_;
+  metrics->outputQueue = outgoingBufferSize();
+  metrics->maxOutputQueue = maxOutgoingSize_;
+}
+
 void RpcConnection::logMetrics() {
   struct rusage usage;
   ::getrusage(RUSAGE_SELF, &usage);
@@ -183,5 +541,6 @@ void RpcConnection::logMetrics() {
   // TODO(bfish): Include SO_NREAD and SO_NWRITE?
 
   log_info("Metrics", txEvents_, rxEvents_, txBytes_, rxBytes_,
-           outgoingBufferSize(), utime, stime, kbytes);
+           outgoingBufferSize(), maxOutgoingSize_, droppedEvents_, utime,
+           stime, kbytes);
 }
@@ -0,0 +1,278 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/rpcconnectionshm.h"
+
+#include "ofp/rpc/rpcevents.h"
+#include "ofp/sys/engine.h"
+
+#if HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <new>
+
+using ofp::rpc::RpcConnectionShm;
+
+static std::error_code lastError() {
+  return {errno, std::generic_category()};
+}
+
+RpcConnectionShm::RpcConnectionShm(RpcServer *server,
+                                   sys::unix_domain::socket socket)
+    : RpcConnection{server, true},
+      sock_{std::move(socket)},
+      wakeup_{server->engine()->io()},
+      notify_{server->engine()->io()} {}
+
+RpcConnectionShm::~RpcConnectionShm() {
+  if (header_) {
+    ::munmap(header_, regionSize_);
+  }
+}
+
+void RpcConnectionShm::asyncAccept() {
+  std::error_code err = setUp();
+  if (err) {
+    log_error("RpcConnectionShm: set up failed", err);
+    close();
+    return;
+  }
+
+  asyncWaitClosed();
+  asyncWaitWakeup();
+
+  // Start optional metrics timer.
+  Milliseconds metricInterval = server_->metricInterval();
+  if (metricInterval != 0_ms) {
+    asyncMetrics(metricInterval);
+  }
+}
+
+void RpcConnectionShm::close() {
+  asio::error_code ignore;
+  sock_.close(ignore);
+  wakeup_.close(ignore);
+  notify_.close(ignore);
+}
+
+/// Create the shared memory region and eventfd's, then pass them to the
+/// controller.
+std::error_code RpcConnectionShm::setUp() {
+  int memfd = ::memfd_create("oftr-rpc", MFD_CLOEXEC);
+  if (memfd < 0) {
+    return lastError();
+  }
+
+  regionSize_ = RPC_SHM_DATA_OFFSET + 2 * RPC_SHM_RING_SIZE;
+  if (::ftruncate(memfd, static_cast<off_t>(regionSize_)) < 0) {
+    auto err = lastError();
+    ::close(memfd);
+    return err;
+  }
+
+  void *region = ::mmap(nullptr, regionSize_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, memfd, 0);
+  if (region == MAP_FAILED) {
+    auto err = lastError();
+    ::close(memfd);
+    return err;
+  }
+
+  // The region is zero-filled, so all ring positions start at zero.
+  header_ = new (region) RpcShmHeader{};
+  header_->magic = RPC_SHM_MAGIC;
+  header_->version = RPC_SHM_VERSION;
+  header_->ringSize = RPC_SHM_RING_SIZE;
+  UInt8 *txData = static_cast<UInt8 *>(region) + RPC_SHM_DATA_OFFSET;
+  UInt8 *rxData = txData + RPC_SHM_RING_SIZE;
+  tx_ = {txData, RPC_SHM_RING_SIZE, &header_->txHead, &header_->txTail};
+  rx_ = {rxData, RPC_SHM_RING_SIZE, &header_->rxHead, &header_->rxTail};
+
+  std::error_code err;
+  for (auto *desc : {&wakeup_, &notify_}) {
+    int fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0) {
+      err = lastError();
+      break;
+    }
+    desc->assign(fd, err);
+    if (err) {
+      ::close(fd);
+      break;
+    }
+  }
+
+  if (!err) {
+    err = sendDescriptors(memfd);
+  }
+
+  // The controller has its own copy of the memfd now.
+  ::close(memfd);
+
+  return err;
+}
+
+std::error_code RpcConnectionShm::sendDescriptors(int memfd) {
+  int fds[3] = {memfd, wakeup_.native_handle(), notify_.native_handle()};
+  UInt64 size = regionSize_;
+
+  struct iovec iov;
+  iov.iov_base = &size;
+  iov.iov_len = sizeof(size);
+
+  alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+
+  struct msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  if (::sendmsg(sock_.native_handle(), &msg, MSG_NOSIGNAL) < 0) {
+    return lastError();
+  }
+
+  return {};
+}
+
+void RpcConnectionShm::asyncWaitWakeup() {
+  auto self(shared_from_this());
+
+  wakeup_.async_read_some(
+      asio::buffer(&wakeupCount_, sizeof(wakeupCount_)),
+      [this, self](const asio::error_code &err, size_t bytes_transferred) {
+        if (!err) {
+          // The controller has added requests or freed space for output.
+          if (readRequests() && wakeup_.is_open()) {
+            writePending();
+            asyncWaitWakeup();
+          }
+        } else if (err != asio::error::operation_aborted) {
+          log_error("RpcConnectionShm::asyncWaitWakeup error", err);
+        }
+      });
+}
+
+void RpcConnectionShm::asyncWaitClosed() {
+  auto self(shared_from_this());
+
+  // The controller never sends anything more on the socket. Wait for it to
+  // close its end.
+  sock_.async_read_some(
+      asio::buffer(&sockByte_, sizeof(sockByte_)),
+      [this, self](const asio::error_code &err, size_t bytes_transferred) {
+        if (!err) {
+          asyncWaitClosed();
+        } else if (err != asio::error::operation_aborted) {
+          if (err != asio::error::eof) {
+            log_error("RpcConnectionShm::asyncWaitClosed error", err);
+          }
+          close();
+        }
+      });
+}
+
+/// Handle each complete request in the rx ring. Return false if the
+/// connection was closed due to an invalid request.
+bool RpcConnectionShm::readRequests() {
+  size_t avail = rx_.readable();
+  bool consumed = false;
+
+  while (avail >= sizeof(Big32)) {
+    Big32 hdr;
+    rx_.peek(0, reinterpret_cast<UInt8 *>(&hdr), sizeof(hdr));
+
+    UInt32 tagLen = hdr;
+    UInt8 tag = tagLen & 0x00FFu;
+    UInt32 len = (tagLen >> 8);
+
+    if (tag != RPC_EVENT_BINARY_TAG) {
+      log_error("RPC invalid header:", UInt32_cast(tag));
+      rpcRequestInvalid("RPC invalid header");
+      close();
+      return false;
+    } else if (len > RPC_MAX_MESSAGE_SIZE) {
+      log_error("RPC request is too big:", len);
+      rpcRequestInvalid("RPC request is too big");
+      close();
+      return false;
+    }
+
+    if (avail < sizeof(hdr) + len) {
+      // Wait for rest of request.
+      break;
+    }
+
+    // Pass the request in place unless it wraps around the end of the ring.
+    llvm::StringRef event = rx_.view(sizeof(hdr), len, &eventBuf_);
+
+    log::trace_rpc("Read RPC", 0, event.data(), event.size());
+    handleEvent(event);
+
+    rx_.consume(sizeof(hdr) + len);
+    avail -= sizeof(hdr) + len;
+    consumed = true;
+  }
+
+  if (consumed) {
+    notifyController();
+  }
+
+  return true;
+}
+
+void RpcConnectionShm::asyncWriteData(const UInt8 *data, size_t size) {
+  assert(writeData_ == nullptr);
+
+  log::trace_rpc("Write RPC", 0, data, size);
+
+  writeData_ = data;
+  writeSize_ = size;
+  writeDone_ = 0;
+  writePending();
+}
+
+/// Copy as much pending output as will fit into the tx ring. When all of it
+/// has been copied, complete the write.
+void RpcConnectionShm::writePending() {
+  if (!writeData_)
+    return;
+
+  size_t len = tx_.write(writeData_ + writeDone_, writeSize_ - writeDone_);
+  if (len > 0) {
+    writeDone_ += len;
+    notifyController();
+  }
+
+  if (writeDone_ == writeSize_) {
+    size_t bytesWritten = writeSize_;
+    writeData_ = nullptr;
+    writeSize_ = writeDone_ = 0;
+
+    // Report completion asynchronously, like the socket-based connections.
+    auto self(shared_from_this());
+    asio::post(server_->engine()->io(), [this, self, bytesWritten]() {
+      asyncWriteCompleted(bytesWritten);
+    });
+  }
+}
+
+void RpcConnectionShm::notifyController() {
+  // If the eventfd counter is about to overflow, the controller has plenty of
+  // unread wakeups already; ignore the error.
+  const UInt64 one = 1;
+  asio::error_code ignore;
+  notify_.write_some(asio::buffer(&one, sizeof(one)), ignore);
+}
+
+#endif  // HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H
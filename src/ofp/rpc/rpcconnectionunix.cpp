@@ -10,49 +10,11 @@
 
 using ofp::rpc::RpcConnectionUnix;
 
-// For `OFP.MESSAGE` notification event.
-constexpr llvm::StringLiteral kMsgPrefix{"{\"params\":"};
-constexpr llvm::StringLiteral kMsgSuffix{",\"method\":\"OFP.MESSAGE\"}"};
-
 RpcConnectionUnix::RpcConnectionUnix(RpcServer *server,
                                      sys::unix_domain::socket socket,
                                      bool binaryProtocol)
-    : RpcConnection{server},
-      sock_{std::move(socket)},
-      streambuf_{RPC_MAX_MESSAGE_SIZE},
-      binaryProtocol_{binaryProtocol} {}
-
-void RpcConnectionUnix::writeEvent(llvm::StringRef msg, bool ofp_message) {
-  ++txEvents_;
-
-  size_t msgSize = ofp_message ? msg.size() + 34 : msg.size();
-  txBytes_ += msgSize;
-
-  // TODO(bfish): Make sure the outgoing message doesn't exceed MAX msg size.
-
-  if (binaryProtocol_) {
-    // Add binary header.
-    Big32 hdr = UInt32_narrow_cast((msgSize << 8) | RPC_EVENT_BINARY_TAG);
-    outgoing_[outgoingIdx_].add(&hdr, sizeof(hdr));
-  }
-
-  if (ofp_message) {
-    outgoing_[outgoingIdx_].add(kMsgPrefix.data(), kMsgPrefix.size());
-    outgoing_[outgoingIdx_].add(msg.data(), msg.size());
-    outgoing_[outgoingIdx_].add(kMsgSuffix.data(), kMsgSuffix.size());
-  } else {
-    outgoing_[outgoingIdx_].add(msg.data(), msg.size());
-  }
-
-  if (!binaryProtocol_) {
-    const UInt8 delimiter = RPC_EVENT_DELIMITER_CHAR;
-    outgoing_[outgoingIdx_].add(&delimiter, sizeof(delimiter));
-  }
-
-  if (!writing_) {
-    asyncWrite();
-  }
-}
+    : RpcConnection{server, binaryProtocol},
+      sock_{std::move(socket)} {}
 
 void RpcConnectionUnix::close() {
   sock_.close();
@@ -76,25 +38,22 @@ void RpcConnectionUnix::asyncAccept() {
 void RpcConnectionUnix::asyncReadLine() {
   auto self(shared_from_this());
 
-  asio::async_read_until(
-      sock_, streambuf_, RPC_EVENT_DELIMITER_CHAR,
+  sock_.async_read_some(
+      inputSpace(),
       [this, self](const asio::error_code &err, size_t bytes_transferred) {
         if (!err) {
-          std::istream is(&streambuf_);
-          std::string line;
-          std::getline(is, line, RPC_EVENT_DELIMITER_CHAR);
-          log::trace_rpc("Read RPC", 0, line.data(), line.size());
-          handleEvent(line);
-          asyncReadLine();
-        } else if (err == asio::error::not_found) {
-          // Input line is too big. Send back an error message then allow
-          // connection to close.
-          log_error("RpcConnectionUnix::asyncReadLine: input too large",
-                    RPC_MAX_MESSAGE_SIZE, err);
-          rpcRequestInvalid("RPC request is too big");
+          if (inputReceived(bytes_transferred)) {
+            asyncReadLine();
+          } else {
+            // Input line is too big. Send back an error message then allow
+            // connection to close.
+            log_error("RpcConnectionUnix::asyncReadLine: input too large",
+                      RPC_MAX_MESSAGE_SIZE);
+            rpcRequestInvalid("RPC request is too big");
+          }
         } else if (err == asio::error::eof) {
           // Log warning if there are unread bytes in the buffer.
-          auto bytesUnread = streambuf_.size();
+          auto bytesUnread = inputPending();
           if (bytesUnread > 0) {
             log_warning("RpcConnectionUnix::asyncReadLine: unread bytes at eof",
                         bytesUnread);
@@ -164,16 +123,7 @@ void RpcConnectionUnix::asyncReadMessage(size_t msgLength) {
                    });
 }
 
-void RpcConnectionUnix::asyncWrite() {
-  assert(!writing_);
-
-  int idx = outgoingIdx_;
-  outgoingIdx_ = !outgoingIdx_;
-  writing_ = true;
-
-  const UInt8 *data = outgoing_[idx].data();
-  size_t size = outgoing_[idx].size();
-
+void RpcConnectionUnix::asyncWriteData(const UInt8 *data, size_t size) {
   auto self(shared_from_this());
 
   log::trace_rpc("Write RPC", 0, data, size);
@@ -182,14 +132,7 @@ void RpcConnectionUnix::asyncWrite() {
       sock_, asio::buffer(data, size),
       [this, self](const asio::error_code &err, size_t bytes_transferred) {
         if (!err) {
-          assert(bytes_transferred == outgoing_[!outgoingIdx_].size());
-
-          writing_ = false;
-          outgoing_[!outgoingIdx_].clear();
-          if (!outgoing_[outgoingIdx_].empty()) {
-            // Start another async write for the other output buffer.
-            asyncWrite();
-          }
+          asyncWriteCompleted(bytes_transferred);
         }
       });
 }
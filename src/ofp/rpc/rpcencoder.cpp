@@ -4,6 +4,7 @@
 #include "ofp/rpc/rpcencoder.h"
 
 #include "ofp/rpc/rpcconnection.h"
+#include "ofp/yaml/inputjson.h"
 #include "ofp/yaml/seterror.h"
 
 using namespace ofp;
@@ -13,15 +14,33 @@ inline bool errorFound(llvm::yaml::IO &io) {
   return ofp::yaml::ErrorFound(io);
 }
 
-RpcEncoder::RpcEncoder(const std::string &input, RpcConnection *conn,
-                       yaml::Encoder::ChannelFinder finder)
-    : conn_{conn}, errorStream_{error_}, finder_{finder} {
-  llvm::yaml::Input yin{input, nullptr, RpcEncoder::diagnosticHandler, this};
+// Read the request from the input. Return true if there's no error.
+template <class InputType>
+static bool readInput(InputType &yin, RpcEncoder *encoder) {
   if (!yin.error()) {
-    yin >> *this;
+    yin >> *encoder;
+  }
+  return !yin.error();
+}
+
+RpcEncoder::RpcEncoder(llvm::StringRef input, RpcConnection *conn,
+                       yaml::Encoder::ChannelFinder finder,
+                       yaml::InputJson *parser)
+    : conn_{conn}, errorStream_{error_}, finder_{finder} {
+  // Most requests are JSON objects; only fall back to the YAML parser when
+  // the input is not strict JSON.
+  bool ok;
+  yaml::InputJson local;
+  yaml::InputJson &jin = parser ? *parser : local;
+  jin.reset(input, RpcEncoder::diagnosticHandler, this);
+  if (jin.valid()) {
+    ok = readInput(jin, this);
+  } else {
+    llvm::yaml::Input yin{input, nullptr, RpcEncoder::diagnosticHandler, this};
+    ok = readInput(yin, this);
   }
 
-  if (yin.error() && method_ != METHOD_SEND) {
+  if (!ok && method_ != METHOD_SEND) {
     replyError();
   }
 }
@@ -117,6 +136,38 @@ void RpcEncoder::encodeParams(llvm::yaml::IO &io) {
       }
       break;
     }
+    case METHOD_ADD_TEMPLATE: {
+      RpcAddTemplate add{id_};
+      io.mapRequired("params", add.params);
+      if (!errorFound(io)) {
+        conn_->onRpcAddTemplate(&add);
+      }
+      break;
+    }
+    case METHOD_SEND_TEMPLATE: {
+      RpcSendTemplate send{id_};
+      io.mapRequired("params", send.params);
+      if (!errorFound(io)) {
+        conn_->onRpcSendTemplate(&send);
+      }
+      break;
+    }
+    case METHOD_METRICS: {
+      RpcMetrics metrics{id_};
+      io.mapOptional("params", metrics.params);
+      if (!errorFound(io)) {
+        conn_->onRpcMetrics(&metrics);
+      }
+      break;
+    }
+    case METHOD_SET_ARP_TABLE: {
+      RpcSetArpTable set{id_};
+      io.mapRequired("params", set.params);
+      if (!errorFound(io)) {
+        conn_->onRpcSetArpTable(&set);
+      }
+      break;
+    }
     default:
       break;
   }
@@ -64,13 +64,148 @@ std::string RpcSetFilterResponse::toJson() {
   return toJsonString(this);
 }
 
+std::string RpcAddTemplateResponse::toJson() {
+  return toJsonString(this);
+}
+
+std::string RpcSetArpTableResponse::toJson() {
+  return toJsonString(this);
+}
+
+std::string RpcMetricsResponse::toJson() {
+  return toJsonString(this);
+}
+
+namespace {
+
+/// Append a metric family to Prometheus text output.
+class PrometheusWriter {
+ public:
+  explicit PrometheusWriter(std::string *out) : out_{*out} {}
+
+  void family(const char *name, const char *type, const char *help) {
+    name_ = name;
+    out_ += "# HELP ";
+    out_ += name;
+    out_ += ' ';
+    out_ += help;
+    out_ += "\n# TYPE ";
+    out_ += name;
+    out_ += ' ';
+    out_ += type;
+    out_ += '\n';
+  }
+
+  void sample(const std::string &labels, const std::string &value) {
+    out_ += name_;
+    if (!labels.empty()) {
+      out_ += '{';
+      out_ += labels;
+      out_ += '}';
+    }
+    out_ += ' ';
+    out_ += value;
+    out_ += '\n';
+  }
+
+  void sample(const std::string &labels, ofp::UInt64 value) {
+    sample(labels, std::to_string(value));
+  }
+
+ private:
+  std::string &out_;
+  const char *name_ = "";
+};
+
+std::string channelLabels(const RpcChannelMetrics &channel) {
+  return "conn_id=\"" + std::to_string(channel.connId) + "\",datapath_id=\"" +
+         channel.datapathId.toString() + "\",auxiliary_id=\"" +
+         std::to_string(channel.auxiliaryId) + "\"";
+}
+
+std::string seconds(ofp::UInt64 msec) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(msec) / 1000);
+  return buf;
+}
+
+}  // namespace
+
+std::string RpcMetricsResponse::toPrometheus() const {
+  std::string text;
+  PrometheusWriter out{&text};
+
+  const RpcEventMetrics &rpc = result.rpc;
+  out.family("oftr_rpc_tx_events_total", "counter", "RPC events sent.");
+  out.sample("", rpc.txEvents);
+  out.family("oftr_rpc_rx_events_total", "counter", "RPC events received.");
+  out.sample("", rpc.rxEvents);
+  out.family("oftr_rpc_tx_bytes_total", "counter", "RPC bytes sent.");
+  out.sample("", rpc.txBytes);
+  out.family("oftr_rpc_rx_bytes_total", "counter", "RPC bytes received.");
+  out.sample("", rpc.rxBytes);
+  out.family("oftr_rpc_dropped_events_total", "counter",
+             "RPC events dropped due to output queue overflow.");
+  out.sample("", rpc.droppedEvents);
+  out.family("oftr_rpc_decode_errors_total", "counter",
+             "OpenFlow messages that failed to decode.");
+  out.sample("", rpc.decodeErrors);
+  out.family("oftr_rpc_output_queue_bytes", "gauge",
+             "Bytes in the RPC output queue.");
+  out.sample("", rpc.outputQueue);
+  out.family("oftr_rpc_output_queue_max_bytes", "gauge",
+             "Maximum bytes in the RPC output queue.");
+  out.sample("", rpc.maxOutputQueue);
+
+  out.family("oftr_channel_rx_messages_total", "counter",
+             "OpenFlow messages received.");
+  for (const auto &channel : result.connections) {
+    out.sample(channelLabels(channel), channel.rxMessages);
+  }
+  out.family("oftr_channel_rx_bytes_total", "counter",
+             "OpenFlow bytes received.");
+  for (const auto &channel : result.connections) {
+    out.sample(channelLabels(channel), channel.rxBytes);
+  }
+  out.family("oftr_channel_tx_bytes_total", "counter", "OpenFlow bytes sent.");
+  for (const auto &channel : result.connections) {
+    out.sample(channelLabels(channel), channel.txBytes);
+  }
+
+  out.family("oftr_filter_hits_total", "counter",
+             "PACKET_IN messages matched by each filter table entry.");
+  for (size_t i = 0; i < result.filterHits.size(); ++i) {
+    out.sample("index=\"" + std::to_string(i) + "\"", result.filterHits[i]);
+  }
+
+  out.family("oftr_filter_drops_total", "counter",
+             "PACKET_IN messages not escalated due to a filter limit.");
+  for (const auto &drops : result.filterDrops) {
+    out.sample("index=\"" + std::to_string(drops.index) + "\",datapath_id=\"" +
+                   drops.datapathId.toString() + "\",in_port=\"" +
+                   std::to_string(static_cast<UInt32>(drops.inPort)) + "\"",
+               drops.dropped);
+  }
+
+  out.family("oftr_engine_loop_lag_seconds", "gauge",
+             "Most recent event loop lag.");
+  out.sample("", seconds(result.loopLag));
+  out.family("oftr_engine_loop_lag_max_seconds", "gauge",
+             "Maximum event loop lag.");
+  out.sample("", seconds(result.maxLoopLag));
+
+  return text;
+}
+
 OFP_BEGIN_IGNORE_GLOBAL_CONSTRUCTOR
 
 // N.B. These strings must be in same order as RpcMethod enum.
 static const llvm::StringRef sRpcMethods[] = {
     "OFP.LISTEN",       "OFP.CONNECT",     "OFP.CLOSE",
     "OFP.SEND",         "OFP.MESSAGE",     "OFP.LIST_CONNECTIONS",
-    "OFP.ADD_IDENTITY", "OFP.DESCRIPTION", "OFP.SET_FILTER"};
+    "OFP.ADD_IDENTITY", "OFP.DESCRIPTION", "OFP.SET_FILTER",
+    "OFP.ADD_TEMPLATE", "OFP.SEND_TEMPLATE", "OFP.METRICS",
+    "OFP.SET_ARP_TABLE"};
 
 const ofp::yaml::EnumConverter<ofp::rpc::RpcMethod>
     llvm::yaml::ScalarTraits<ofp::rpc::RpcMethod>::converter{sRpcMethods};
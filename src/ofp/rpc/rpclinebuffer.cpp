@@ -0,0 +1,55 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/rpclinebuffer.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+UInt8 *RpcLineBuffer::prepare(size_t *size) {
+  if (end_ == buf_.size()) {
+    if (start_ > 0) {
+      size_t count = pending();
+      std::memmove(buf_.mutableData(), buf_.data() + start_, count);
+      scan_ -= start_;
+      start_ = 0;
+      end_ = count;
+    }
+
+    if (end_ == buf_.size()) {
+      // Reserve one more byte than the longest line, so we can detect a line
+      // that is too long.
+      size_t newSize = std::max(initialSize_, 2 * buf_.size());
+      buf_.resize(std::min(newSize, maxLineSize_ + 1));
+    }
+  }
+
+  *size = buf_.size() - end_;
+  return buf_.mutableData() + end_;
+}
+
+void RpcLineBuffer::received(size_t size) {
+  end_ += size;
+  assert(end_ <= buf_.size());
+}
+
+bool RpcLineBuffer::nextLine(llvm::StringRef *line) {
+  const char *buf = reinterpret_cast<const char *>(buf_.data());
+
+  if (scan_ < end_) {
+    const void *delim = std::memchr(buf + scan_, delimiter_, end_ - scan_);
+    if (delim) {
+      size_t pos = Unsigned_cast(static_cast<const char *>(delim) - buf);
+      *line = llvm::StringRef{buf + start_, pos - start_};
+      start_ = scan_ = pos + 1;
+      return true;
+    }
+    scan_ = end_;
+  }
+
+  if (start_ == end_) {
+    start_ = scan_ = end_ = 0;
+  }
+
+  return false;
+}
@@ -4,6 +4,7 @@
 #include "ofp/rpc/rpcserver.h"
 
 #include "ofp/rpc/rpcchannellistener.h"
+#include "ofp/rpc/rpcconnectionshm.h"
 #include "ofp/rpc/rpcconnectionstdio.h"
 #include "ofp/rpc/rpcconnectionunix.h"
 #include "ofp/rpc/rpcevents.h"
@@ -20,6 +21,8 @@ RpcServer::RpcServer(bool binaryProtocol, Milliseconds metricInterval,
     : engine_{driver_.engine()},
       acceptor_{driver_.engine()->io()},
       socket_{driver_.engine()->io()},
+      metricsAcceptor_{driver_.engine()->io()},
+      metricsSocket_{driver_.engine()->io()},
       binaryProtocol_{binaryProtocol},
       defaultChannel_{defaultChannel},
       metricInterval_{metricInterval} {
@@ -63,6 +66,32 @@ std::error_code RpcServer::bind(int socketFD) {
 }
 
 std::error_code RpcServer::bind(const std::string &listenPath) {
+  std::error_code err = listen(&acceptor_, listenPath);
+  if (!err) {
+    asyncAccept();
+  }
+  return err;
+}
+
+std::error_code RpcServer::bindSharedMemory(const std::string &listenPath) {
+#if HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H
+  sharedMemory_ = true;
+  return bind(listenPath);
+#else
+  return std::make_error_code(std::errc::function_not_supported);
+#endif
+}
+
+std::error_code RpcServer::bindMetrics(const std::string &listenPath) {
+  std::error_code err = listen(&metricsAcceptor_, listenPath);
+  if (!err) {
+    asyncAcceptMetrics();
+  }
+  return err;
+}
+
+std::error_code RpcServer::listen(sys::unix_domain::acceptor *acceptor,
+                                  const std::string &listenPath) {
   std::error_code err;
   err = deleteExistingSocketFile(listenPath);
   if (err) {
@@ -71,23 +100,17 @@ std::error_code RpcServer::bind(const std::string &listenPath) {
   }
 
   auto endpt = sys::unix_domain::endpoint(listenPath);
-  acceptor_.open(endpt.protocol(), err);
+  acceptor->open(endpt.protocol(), err);
   if (err) {
     return err;
   }
 
-  acceptor_.bind(endpt, err);
+  acceptor->bind(endpt, err);
   if (err) {
     return err;
   }
 
-  acceptor_.listen(asio::socket_base::max_listen_connections, err);
-  if (err) {
-    return err;
-  }
-
-  asyncAccept();
-
+  acceptor->listen(asio::socket_base::max_listen_connections, err);
   return err;
 }
 
@@ -109,8 +132,16 @@ void RpcServer::asyncAccept() {
       return;
     }
 
-    auto conn = std::make_shared<RpcConnectionUnix>(this, std::move(socket_),
-                                                    binaryProtocol_);
+    std::shared_ptr<RpcConnection> conn;
+#if HAVE_MEMFD_CREATE && HAVE_SYS_EVENTFD_H
+    if (sharedMemory_) {
+      conn = std::make_shared<RpcConnectionShm>(this, std::move(socket_));
+    }
+#endif
+    if (!conn) {
+      conn = std::make_shared<RpcConnectionUnix>(this, std::move(socket_),
+                                                 binaryProtocol_);
+    }
     conn->asyncAccept();
 
     // Don't accept any more connections -- only one allowed.
@@ -120,6 +151,48 @@ void RpcServer::asyncAccept() {
   });
 }
 
+void RpcServer::asyncAcceptMetrics() {
+  // Each client connection receives one HTTP response with the current
+  // metrics, then the connection is closed. We don't bother to read the
+  // request, so this works with `curl --unix-socket` or `nc -U`.
+
+  metricsAcceptor_.async_accept(metricsSocket_, [this](
+                                                    const asio::error_code
+                                                        &err) {
+    if (err == asio::error::operation_aborted) {
+      return;
+    }
+
+    if (err) {
+      log_error("Error in RpcServer.asyncAcceptMetrics:", err);
+      return;
+    }
+
+    RpcMetricsResponse response{RpcID::NULL_VALUE};
+    collectMetrics(&response);
+    std::string body = response.toPrometheus();
+
+    auto text = std::make_shared<std::string>(
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " +
+        std::to_string(body.size()) + "\r\n\r\n" + body);
+    auto sock =
+        std::make_shared<sys::unix_domain::socket>(std::move(metricsSocket_));
+
+    asio::async_write(*sock, asio::buffer(*text),
+                      [sock, text](const asio::error_code &err, size_t) {
+                        if (err) {
+                          log_warning("RpcServer: metrics write failed", err);
+                        }
+                        asio::error_code ignore;
+                        sock->close(ignore);
+                      });
+
+    asyncAcceptMetrics();
+  });
+}
+
 void RpcServer::close() {
   log_debug("RpcServer::close");
   if (oneConn_) {
@@ -137,6 +210,10 @@ void RpcServer::onDisconnect(RpcConnection *conn) {
   log_debug("RpcServer::onDisconnect");
   assert(oneConn_ == conn);
 
+  // Reads may have been paused by the BLOCK overflow policy. The output queue
+  // belonged to this connection, so nothing is left to drain.
+  engine_->setReadPaused(false);
+
   // When the one API connection disconnects, shutdown the engine in 1.5 secs.
   // (Only if there are existing channels.)
 
@@ -358,6 +435,10 @@ void RpcServer::onRpcAddIdentity(RpcConnection *conn, RpcAddIdentity *add) {
 }
 
 void RpcServer::onRpcDescription(RpcConnection *conn, RpcDescription *desc) {
+  if (desc->params.base64) {
+    conn->setBase64Bytes(*desc->params.base64);
+  }
+
   if (desc->id.is_missing())
     return;
 
@@ -380,6 +461,173 @@ void RpcServer::onRpcSetFilter(RpcConnection *conn, RpcSetFilter *set) {
   conn->rpcReply(&response);
 }
 
+void RpcServer::onRpcSetArpTable(RpcConnection *conn, RpcSetArpTable *set) {
+  ArpTable &arpTable = filter_.arpTable();
+  if (set->params.replace) {
+    arpTable.clear();
+  }
+
+  for (const auto &ip : set->params.remove) {
+    arpTable.remove(ip);
+  }
+
+  for (const auto &entry : set->params.entries) {
+    arpTable.set(entry.ip, entry.mac);
+  }
+
+  if (set->id.is_missing())
+    return;
+
+  RpcSetArpTableResponse response{set->id};
+  response.result.count = UInt32_narrow_cast(arpTable.size());
+  conn->rpcReply(&response);
+}
+
+void RpcServer::onRpcAddTemplate(RpcConnection *conn, RpcAddTemplate *add) {
+  UInt32 templateId = add->params.templateId;
+  int code = ERROR_CODE_INVALID_REQUEST;
+  std::string error;
+
+  MessageTemplate tmpl;
+  if (templateId > templates_.size()) {
+    code = ERROR_CODE_TEMPLATE_NOT_FOUND;
+    error = "unknown template_id " + std::to_string(templateId);
+  } else if (templateId == 0 && templates_.size() >= RPC_MAX_TEMPLATES) {
+    error = "too many templates: limit is " +
+            std::to_string(RPC_MAX_TEMPLATES);
+  } else {
+    error = tmpl.compile(add->params.message, add->params.slots);
+  }
+
+  if (!error.empty()) {
+    log_warning("RpcServer::onRpcAddTemplate:", error);
+    if (add->id.is_missing())
+      return;
+
+    RpcErrorResponse response{add->id};
+    response.error.code = code;
+    response.error.message = error;
+    TrimErrorMessage(response.error.message);
+    conn->rpcReply(&response);
+    return;
+  }
+
+  if (templateId == 0) {
+    templates_.push_back(std::move(tmpl));
+    templateId = UInt32_narrow_cast(templates_.size());
+  } else {
+    templates_[templateId - 1] = std::move(tmpl);
+  }
+
+  if (add->id.is_missing())
+    return;
+
+  RpcAddTemplateResponse response{add->id};
+  response.result.templateId = templateId;
+  conn->rpcReply(&response);
+}
+
+void RpcServer::onRpcSendTemplate(RpcConnection *conn, RpcSendTemplate *send) {
+  auto &params = send->params;
+
+  if (params.templateId == 0 || params.templateId > templates_.size()) {
+    sendTemplateError(conn, send, ERROR_CODE_TEMPLATE_NOT_FOUND,
+                      "unknown template_id " +
+                          std::to_string(params.templateId));
+    return;
+  }
+
+  Channel *channel = findDatapath(params.connId, params.datapathId);
+  if (!channel) {
+    std::string error;
+    if (params.connId != 0) {
+      error = "unable to locate conn_id " + std::to_string(params.connId);
+    } else if (!params.datapathId.empty()) {
+      error = "unable to locate datapath_id " + params.datapathId.toString();
+    } else {
+      error = "unable to locate connection; no conn_id or datapath_id";
+    }
+    sendTemplateError(conn, send, ERROR_CODE_CONNECTION_NOT_FOUND, error);
+    return;
+  }
+
+  const MessageTemplate &tmpl = templates_[params.templateId - 1];
+  if (tmpl.version() != channel->version()) {
+    sendTemplateError(conn, send, ERROR_CODE_INVALID_REQUEST,
+                      "template version " + std::to_string(tmpl.version()) +
+                          " does not match channel version " +
+                          std::to_string(channel->version()));
+    return;
+  }
+
+  // If the xid is missing, the channel assigns the next one.
+  if (!params.xid) {
+    params.xid = channel->nextXid();
+  }
+
+  std::string error =
+      tmpl.instantiate(params.values, *params.xid, &templateBuf_);
+  if (!error.empty()) {
+    sendTemplateError(conn, send, ERROR_CODE_INVALID_REQUEST, error);
+    return;
+  }
+
+  channel->write(templateBuf_.data(), templateBuf_.size());
+  channel->flush();
+
+  if (!send->id.is_missing()) {
+    RpcSendResponse response{send->id};
+    response.result.data = {templateBuf_.data(),
+                            std::min<std::size_t>(templateBuf_.size(), 8)};
+    conn->rpcReply(&response);
+  }
+}
+
+void RpcServer::onRpcMetrics(RpcConnection *conn, RpcMetrics *metrics) {
+  if (metrics->id.is_missing())
+    return;
+
+  RpcMetricsResponse response{metrics->id};
+  collectMetrics(&response);
+  conn->rpcReply(&response);
+}
+
+void RpcServer::collectMetrics(RpcMetricsResponse *response) {
+  auto &result = response->result;
+
+  if (oneConn_) {
+    oneConn_->collectMetrics(&result.rpc);
+  }
+
+  engine_->forEachConnection([&result](sys::Connection *channel) {
+    result.connections.emplace_back();
+    RpcChannelMetrics &metrics = result.connections.back();
+    metrics.connId = channel->connectionId();
+    metrics.datapathId = channel->datapathId();
+    metrics.auxiliaryId = channel->auxiliaryId();
+    metrics.rxMessages = channel->rxMessages();
+    metrics.rxBytes = channel->rxBytes();
+    metrics.txBytes = channel->txBytes();
+  });
+
+  UInt32 index = 0;
+  for (const auto &entry : filter_.entries()) {
+    result.filterHits.push_back(entry.hits());
+    for (const auto &bucket : entry.limit().buckets()) {
+      result.filterDrops.emplace_back();
+      RpcFilterDrops &drops = result.filterDrops.back();
+      drops.index = index;
+      drops.datapathId = bucket.first.datapathId;
+      drops.inPort = bucket.first.inPort;
+      drops.dropped = bucket.second.dropped();
+    }
+    ++index;
+  }
+
+  result.loopLag = Unsigned_cast(engine_->loopLag().count());
+  result.maxLoopLag = Unsigned_cast(engine_->maxLoopLag().count());
+}
+
 void RpcServer::onChannelUp(Channel *channel) {
   if (oneConn_)
     oneConn_->onChannelUp(channel);
@@ -411,6 +659,23 @@ ofp::Channel *RpcServer::findDatapath(UInt64 connId,
   return engine_->findDatapath(connId, datapathId);
 }
 
+/// Report failure to send a message template. Like `OFP.SEND`, send an error
+/// response if the request has an id; otherwise, send a CHANNEL_ALERT.
+void RpcServer::sendTemplateError(RpcConnection *conn, RpcSendTemplate *send,
+                                  int code, const std::string &message) {
+  log_warning("Failed to send message template:", message);
+
+  if (!send->id.is_missing()) {
+    RpcErrorResponse response{send->id};
+    response.error.code = code;
+    response.error.message = message;
+    conn->rpcReply(&response);
+  } else {
+    conn->rpcAlert(send->params.datapathId, send->params.connId, message, {},
+                   Timestamp::now(), send->params.xid.getValueOr(0));
+  }
+}
+
 void RpcServer::alertCallback(Channel *channel, const std::string &alert,
                               const ByteRange &data, void *context) {
   RpcServer *self = reinterpret_cast<RpcServer *>(context);
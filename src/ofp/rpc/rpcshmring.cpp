@@ -0,0 +1,66 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/rpcshmring.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+size_t RpcShmRing::readable() const {
+  const UInt64 head = head_->load(std::memory_order_acquire);
+  const UInt64 tail = tail_->load(std::memory_order_relaxed);
+  return head - tail;
+}
+
+size_t RpcShmRing::writable() const {
+  const UInt64 head = head_->load(std::memory_order_relaxed);
+  const UInt64 tail = tail_->load(std::memory_order_acquire);
+  return size_ - (head - tail);
+}
+
+size_t RpcShmRing::write(const UInt8 *data, size_t size) {
+  size = std::min(size, writable());
+  if (size == 0)
+    return 0;
+
+  const UInt64 head = head_->load(std::memory_order_relaxed);
+  size_t offset = head & mask();
+  size_t len = std::min(size, size_ - offset);
+  std::memcpy(data_ + offset, data, len);
+  std::memcpy(data_, data + len, size - len);
+
+  head_->store(head + size, std::memory_order_release);
+  return size;
+}
+
+void RpcShmRing::peek(size_t offset, UInt8 *data, size_t size) const {
+  assert(offset + size <= readable());
+
+  const UInt64 pos = tail_->load(std::memory_order_relaxed) + offset;
+  size_t start = pos & mask();
+  size_t len = std::min(size, size_ - start);
+  std::memcpy(data, data_ + start, len);
+  std::memcpy(data + len, data_, size - len);
+}
+
+llvm::StringRef RpcShmRing::view(size_t offset, size_t size,
+                                 std::string *buf) const {
+  assert(offset + size <= readable());
+
+  const UInt64 pos = tail_->load(std::memory_order_relaxed) + offset;
+  size_t start = pos & mask();
+  if (start + size <= size_) {
+    return {reinterpret_cast<const char *>(data_ + start), size};
+  }
+
+  buf->resize(size);
+  peek(offset, reinterpret_cast<UInt8 *>(&(*buf)[0]), size);
+  return *buf;
+}
+
+void RpcShmRing::consume(size_t size) {
+  assert(size <= readable());
+
+  const UInt64 tail = tail_->load(std::memory_order_relaxed);
+  tail_->store(tail + size, std::memory_order_release);
+}
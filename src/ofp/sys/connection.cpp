@@ -92,12 +92,17 @@ void Connection::setMainConnection(Connection *channel, UInt8 auxID) {
 void Connection::postMessage(Message *message) {
   assert(message->source());
 
-  // Assign message timestamp here.
+  // Assign message timestamp here. The message object is reused for each
+  // read, so clear the duplicate count the filter table may have set.
   message->setTime(Timestamp::now());
+  message->setDuplicates(0);
 
   log::trace_msg("Read", message->source()->connectionId(), message->data(),
                  message->size());
 
+  ++rxMessages_;
+  rxBytes_ += message->size();
+
   if (version() >= OFP_VERSION_1 && echoMessageHandled(message)) {
     return;
   }
@@ -136,6 +141,10 @@ void Connection::tickle(TimePoint now) {
     return;
   }
 
+  // Don't time out the channel while we are holding off reads ourselves.
+  if (engine()->isReadPaused())
+    return;
+
   auto age = now - timeReadStarted_;
   if (age < keepAliveTimeout_)
     return;
@@ -201,28 +210,43 @@ void Connection::setFlags(UInt64 securityId, ChannelOptions options) {
   setFlags(newFlags);
 }
 
+bool Connection::postPriorityMessage(Message *message) {
+  if (version() < OFP_VERSION_1 || !isHandledEcho(message)) {
+    return false;
+  }
+
+  postMessage(message);
+  return true;
+}
+
 bool Connection::echoMessageHandled(Message *message) {
-  const UInt8 type = message->type();
+  if (!isHandledEcho(message)) {
+    return false;
+  }
 
-  if (type == OFPT_ECHO_REQUEST) {
-    const EchoRequest *request = EchoRequest::cast(message);
-    if (request && request->isPassThru()) {
-      // Do not handle pass-thru echo requests.
-      return false;
-    }
+  if (message->type() == OFPT_ECHO_REQUEST) {
     // Change the type to echo reply and send it right back.
     message->mutableHeader()->setType(OFPT_ECHO_REPLY);
     write(message->data(), message->size());
     flush();
-    return true;
+  }
+
+  return true;
+}
+
+bool Connection::isHandledEcho(const Message *message) {
+  const UInt8 type = message->type();
+
+  if (type == OFPT_ECHO_REQUEST) {
+    // Do not handle pass-thru echo requests.
+    const EchoRequest *request = EchoRequest::cast(message);
+    return !request || !request->isPassThru();
   }
 
   if (type == OFPT_ECHO_REPLY) {
+    // Handle keep-alive replies by doing nothing.
     const EchoReply *reply = EchoReply::cast(message);
-    if (reply && reply->isKeepAlive()) {
-      // Handle keep-alive replies by doing nothing.
-      return true;
-    }
+    return reply && reply->isKeepAlive();
   }
 
   return false;
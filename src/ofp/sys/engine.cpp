@@ -11,7 +11,11 @@ using namespace ofp;
 using namespace ofp::sys;
 
 Engine::Engine(Driver *driver)
-    : driver_{driver}, signals_{io_}, stopTimer_{io_}, idleTimer_{io_} {
+    : driver_{driver},
+      signals_{io_},
+      stopTimer_{io_},
+      idleTimer_{io_},
+      readResumeTimer_{io_, asio::steady_timer::time_point::max()} {
   log_debug("Engine ready");
 }
 
@@ -200,6 +204,21 @@ void Engine::stop(Milliseconds timeout) {
   }
 }
 
+void Engine::setReadPaused(bool paused) {
+  if (paused == readPaused_)
+    return;
+
+  readPaused_ = paused;
+
+  if (paused) {
+    log_info("Engine: pause reading from channels");
+  } else {
+    log_info("Engine: resume reading from channels");
+    // Wake up all connections waiting to read.
+    readResumeTimer_.cancel();
+  }
+}
+
 bool Engine::registerDatapath(Connection *channel) {
   DatapathID dpid = channel->datapathId();
   UInt8 auxID = channel->auxiliaryId();
@@ -428,6 +447,9 @@ void Engine::asyncIdle() {
   idleTimer_.async_wait([this](const asio::error_code &err) {
     if (!err) {
       TimePoint now = TimeClock::now();
+      loopLag_ =
+          std::chrono::duration_cast<Milliseconds>(now - idleTimer_.expiry());
+      maxLoopLag_ = std::max(maxLoopLag_, loopLag_);
       forEachConnection([&now](Connection *conn) {
         if (conn->flags() & Connection::kConnectionUp) {
           conn->tickle(now);
@@ -11,6 +11,11 @@
 
 #include "ofp/log.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define OFP_HEX_SIMD 1
+#endif
+
 namespace ofp {
 
 static const size_t kTwoGigabytes = 0x80000000UL;
@@ -41,6 +46,187 @@ inline char ToBase64(UInt32 value) {
   return Base64Digits[value];
 }
 
+// Convert `length` bytes to base64 and return a pointer past the end of the
+// output. The output is padded with '=' to a multiple of 4 characters.
+static char *Base64Encode(const UInt8 *src, size_t length, char *dst) {
+  size_t remaining = length;
+  while (remaining >= 3) {
+    UInt32 block24 = (UInt32_cast(src[0]) << 16) | (UInt32_cast(src[1]) << 8) |
+                     UInt32_cast(src[2]);
+    *dst++ = ToBase64((block24 >> 18) & 0x03F);
+    *dst++ = ToBase64((block24 >> 12) & 0x03F);
+    *dst++ = ToBase64((block24 >> 6) & 0x03F);
+    *dst++ = ToBase64(block24 & 0x03F);
+    src += 3;
+    remaining -= 3;
+  }
+
+  if (remaining == 2) {
+    UInt32 block24 = UInt32_cast(src[0] << 16) | (UInt32_cast(src[1]) << 8);
+    *dst++ = ToBase64((block24 >> 18) & 0x03F);
+    *dst++ = ToBase64((block24 >> 12) & 0x03F);
+    *dst++ = ToBase64((block24 >> 6) & 0x03F);
+    *dst++ = '=';
+  } else if (remaining == 1) {
+    UInt32 block24 = UInt32_cast(src[0] << 16);
+    *dst++ = ToBase64((block24 >> 18) & 0x03F);
+    *dst++ = ToBase64((block24 >> 12) & 0x03F);
+    *dst++ = '=';
+    *dst++ = '=';
+  }
+
+  return dst;
+}
+
+// Convert `length` bytes to 2 * `length` upper case hex digits.
+static void HexEncodeScalar(const UInt8 *src, size_t length, char *dst) {
+  for (size_t i = 0; i < length; ++i) {
+    *dst++ = ToHexUpperCase(src[i] >> 4);
+    *dst++ = ToHexUpperCase(src[i] & 0x0F);
+  }
+}
+
+// Convert 2 * `length` hex digits to `length` bytes. Return false if there is
+// a character that is not a hex digit; the output is then undefined.
+static bool HexDecodeScalar(const char *src, size_t length, UInt8 *dst) {
+  for (size_t i = 0; i < length; ++i) {
+    char a = *src++;
+    char b = *src++;
+    if (!std::isxdigit(a) || !std::isxdigit(b))
+      return false;
+    *dst++ = UInt8_narrow_cast((FromHex(a) << 4) | FromHex(b));
+  }
+  return true;
+}
+
+#if OFP_HEX_SIMD
+
+// SSE2 is always available on x86_64. The AVX2 kernels are selected at
+// runtime. Each kernel handles whole blocks, and passes the remainder to the
+// next smaller kernel.
+
+// Convert each byte (0..15) in `v` to an upper case hex digit.
+static inline __m128i HexDigitsSSE2(__m128i v) {
+  __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(9)),
+                                 _mm_set1_epi8('A' - '0' - 10));
+  return _mm_add_epi8(_mm_add_epi8(v, _mm_set1_epi8('0')), letter);
+}
+
+static void HexEncodeSSE2(const UInt8 *src, size_t length, char *dst) {
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  while (length >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i hi = HexDigitsSSE2(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    __m128i lo = HexDigitsSSE2(_mm_and_si128(v, mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+    src += 16;
+    dst += 32;
+    length -= 16;
+  }
+  HexEncodeScalar(src, length, dst);
+}
+
+// Convert 16 hex digits in `v` to their values in the low byte of each 16-bit
+// lane, with the first digit of each pair in the high nibble. Set `*valid` to
+// false if any character is not a hex digit.
+static inline __m128i HexValuesSSE2(__m128i v, bool *valid) {
+  __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+  __m128i isAlpha =
+      _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+  *valid = _mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) == 0xFFFF;
+
+  __m128i digit = _mm_and_si128(isDigit, _mm_sub_epi8(v, _mm_set1_epi8('0')));
+  __m128i alpha = _mm_andnot_si128(
+      isDigit, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+  __m128i nibbles = _mm_or_si128(digit, alpha);
+
+  return _mm_or_si128(
+      _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+      _mm_srli_epi16(nibbles, 8));
+}
+
+static bool HexDecodeSSE2(const char *src, size_t length, UInt8 *dst) {
+  while (length >= 16) {
+    bool valid0, valid1;
+    __m128i a = HexValuesSSE2(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), &valid0);
+    __m128i b = HexValuesSSE2(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16)), &valid1);
+    if (!valid0 || !valid1)
+      return false;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(a, b));
+    src += 32;
+    dst += 16;
+    length -= 16;
+  }
+  return HexDecodeScalar(src, length, dst);
+}
+
+__attribute__((target("avx2"))) static inline __m256i HexDigitsAVX2(
+    __m256i v) {
+  __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(9)),
+                                    _mm256_set1_epi8('A' - '0' - 10));
+  return _mm256_add_epi8(_mm256_add_epi8(v, _mm256_set1_epi8('0')), letter);
+}
+
+__attribute__((target("avx2"))) static void HexEncodeAVX2(const UInt8 *src,
+                                                          size_t length,
+                                                          char *dst) {
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  while (length >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+    __m256i hi = HexDigitsAVX2(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    __m256i lo = HexDigitsAVX2(_mm256_and_si256(v, mask));
+    // Unpack works within each 128-bit lane; put the lanes back in order.
+    __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+    src += 32;
+    dst += 64;
+    length -= 32;
+  }
+  HexEncodeSSE2(src, length, dst);
+}
+
+using HexEncodeFn = void (*)(const UInt8 *, size_t, char *);
+
+static HexEncodeFn SelectHexEncode() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? HexEncodeAVX2 : HexEncodeSSE2;
+}
+
+static void HexEncode(const UInt8 *src, size_t length, char *dst) {
+  // Select the kernel on first use, not during static initialization.
+  static const HexEncodeFn encode = SelectHexEncode();
+  encode(src, length, dst);
+}
+
+// Hex is only decoded from YAML/JSON input, so there is no AVX2 version.
+static bool HexDecode(const char *src, size_t length, UInt8 *dst) {
+  return HexDecodeSSE2(src, length, dst);
+}
+
+#else  // !OFP_HEX_SIMD
+
+static void HexEncode(const UInt8 *src, size_t length, char *dst) {
+  HexEncodeScalar(src, length, dst);
+}
+
+static bool HexDecode(const char *src, size_t length, UInt8 *dst) {
+  return HexDecodeScalar(src, length, dst);
+}
+
+#endif  // !OFP_HEX_SIMD
+
 template <size_t Length>
 char *RawDataToHexDelimitedLowercase(const std::array<UInt8, Length> &data,
                                      char (&buf)[Length * 3]) {
@@ -75,17 +261,8 @@ std::string ofp::RawDataToHex(const void *data, size_t len) {
   }
 
   std::string result;
-  result.reserve(2 * len);
-
-  const UInt8 *pos = static_cast<const UInt8 *>(data);
-  const UInt8 *end = pos + len;
-
-  char buf[2];
-  while (pos < end) {
-    buf[0] = ToHexUpperCase(*pos >> 4);
-    buf[1] = ToHexUpperCase(*pos++ & 0x0F);
-    result.append(buf, sizeof(buf));
-  }
+  result.resize(2 * len);
+  HexEncode(static_cast<const UInt8 *>(data), len, &result[0]);
 
   return result;
 }
@@ -99,23 +276,15 @@ void ofp::RawDataToHex(const void *data, size_t length, llvm::raw_ostream &os) {
   const UInt8 *pos = static_cast<const UInt8 *>(data);
   size_t left = length;
 
-  char buf[256];
-  while (left >= 128) {
-    char *out = buf;
-    for (unsigned i = 0; i < 128; ++i) {
-      *out++ = ToHexUpperCase(*pos >> 4);
-      *out++ = ToHexUpperCase(*pos++ & 0x0F);
-    }
-    os.write(buf, 256);
-    left -= 128;
-  }
-
-  char *out = buf;
-  for (unsigned i = 0; i < left; ++i) {
-    *out++ = ToHexUpperCase(*pos >> 4);
-    *out++ = ToHexUpperCase(*pos++ & 0x0F);
+  // A full Ethernet frame fits in one write.
+  char buf[3072];
+  while (left > 0) {
+    size_t n = std::min(left, sizeof(buf) / 2);
+    HexEncode(pos, n, buf);
+    os.write(buf, 2 * n);
+    pos += n;
+    left -= n;
   }
-  os.write(buf, 2 * left);
 }
 
 std::string ofp::RawDataToHex(const void *data, size_t len, char delimiter,
@@ -145,7 +314,7 @@ std::string ofp::RawDataToHex(const void *data, size_t len, char delimiter,
   return result;
 }
 
-size_t ofp::HexToRawData(const std::string &hex, void *data, size_t maxlen,
+size_t ofp::HexToRawData(llvm::StringRef hex, void *data, size_t maxlen,
                          bool *error) {
   if (maxlen == 0) {
     return 0;
@@ -158,19 +327,39 @@ size_t ofp::HexToRawData(const std::string &hex, void *data, size_t maxlen,
   unsigned ch[2];
   unsigned idx = 0;
   UInt8 *out = begin;
-  for (auto inp = hex.c_str(); *inp; ++inp) {
-    if (std::isxdigit(*inp)) {
-      ch[idx++] = FromHex(*inp);
-      if (idx >= 2) {
-        idx = 0;
-        assert(ch[0] < 16 && ch[1] < 16);
-        *out++ = UInt8_narrow_cast((ch[0] << 4) | ch[1]);
-        if (out >= end)
-          break;
+  const char *inp = hex.begin();
+  const char *inpEnd = hex.end();
+  while (inp < inpEnd && out < end) {
+    // Convert a block of hex digits at a time. If the block contains any
+    // other character, convert it one character at a time instead.
+    size_t n = std::min(Unsigned_cast(inpEnd - inp) / 2,
+                        std::min(Unsigned_cast(end - out), size_t{512}));
+    if (idx == 0 && n > 0 && HexDecode(inp, n, out)) {
+      inp += 2 * n;
+      out += n;
+      continue;
+    }
+
+    const char *blockEnd = inp + std::max(2 * n, size_t{1});
+    for (; inp < blockEnd; ++inp) {
+      if (*inp == '\0') {
+        // Stop at an embedded NUL.
+        inpEnd = inp;
+        break;
+      }
+      if (std::isxdigit(*inp)) {
+        ch[idx++] = FromHex(*inp);
+        if (idx >= 2) {
+          idx = 0;
+          assert(ch[0] < 16 && ch[1] < 16);
+          *out++ = UInt8_narrow_cast((ch[0] << 4) | ch[1]);
+          if (out >= end)
+            break;
+        }
+      } else if (!nonhex && !std::isspace(*inp)) {
+        // Ignore space characters when checking for non-hexadecimal values.
+        nonhex = true;
       }
-    } else if (!nonhex && !std::isspace(*inp)) {
-      // Ignore space characters when checking for non-hexadecimal values.
-      nonhex = true;
     }
   }
 
@@ -308,34 +497,8 @@ std::string ofp::RawDataToBase64(const void *data, size_t length) {
   std::string result;
   result.resize(len);
 
-  const UInt8 *src = BytePtr(data);
-  size_t remaining = length;
-
-  char *dst = &result[0];
-  while (remaining >= 3) {
-    UInt32 block24 = (UInt32_cast(src[0]) << 16) | (UInt32_cast(src[1]) << 8) |
-                     UInt32_cast(src[2]);
-    *dst++ = ToBase64((block24 >> 18) & 0x03F);
-    *dst++ = ToBase64((block24 >> 12) & 0x03F);
-    *dst++ = ToBase64((block24 >> 6) & 0x03F);
-    *dst++ = ToBase64(block24 & 0x03F);
-    src += 3;
-    remaining -= 3;
-  }
-
-  if (remaining == 2) {
-    UInt32 block24 = UInt32_cast(src[0] << 16) | (UInt32_cast(src[1]) << 8);
-    *dst++ = ToBase64((block24 >> 18) & 0x03F);
-    *dst++ = ToBase64((block24 >> 12) & 0x03F);
-    *dst++ = ToBase64((block24 >> 6) & 0x03F);
-    *dst++ = '=';
-  } else if (remaining == 1) {
-    UInt32 block24 = UInt32_cast(src[0] << 16);
-    *dst++ = ToBase64((block24 >> 18) & 0x03F);
-    *dst++ = ToBase64((block24 >> 12) & 0x03F);
-    *dst++ = '=';
-    *dst++ = '=';
-  }
+  char *dst = Base64Encode(BytePtr(data), length, &result[0]);
+  (void)dst;
 
   assert(result.size() == len);
   assert(static_cast<size_t>(dst - &result[0]) == len);
@@ -343,6 +506,27 @@ std::string ofp::RawDataToBase64(const void *data, size_t length) {
   return result;
 }
 
+void ofp::RawDataToBase64(const void *data, size_t length,
+                          llvm::raw_ostream &os) {
+  if (length > kTwoGigabytes) {
+    os << "== base64 too big ==";
+    return;
+  }
+
+  const UInt8 *pos = BytePtr(data);
+  size_t left = length;
+
+  // Convert 3072 bytes at a time; only the last chunk may be padded.
+  char buf[4096];
+  while (left > 0) {
+    size_t n = std::min(left, size_t{3072});
+    char *end = Base64Encode(pos, n, buf);
+    os.write(buf, Unsigned_cast(end - buf));
+    pos += n;
+    left -= n;
+  }
+}
+
 bool ofp::IsMemFilled(const void *data, size_t len, char ch) {
   const UInt8 *p = static_cast<const UInt8 *>(data);
   while (len-- > 0) {
@@ -4,7 +4,7 @@
 #include "ofp/yaml/decoder.h"
 
 #include "ofp/requestforward.h"
-#include "ofp/yaml/outputjson.h"
+#include "ofp/yaml/jsonwriter.h"
 #include "ofp/yaml/ybundleaddmessage.h"
 #include "ofp/yaml/ybundlecontrol.h"
 #include "ofp/yaml/yecho.h"
@@ -38,39 +38,122 @@
 using namespace ofp;
 using namespace ofp::yaml;
 
+Decoder::Decoder(bool useJsonFormat, bool includePktMatch)
+    : context_{this, 0, includePktMatch}, useJsonFormat_{useJsonFormat} {}
+
 Decoder::Decoder(const Message *msg, bool useJsonFormat, bool includePktMatch)
-    : msg_{msg} {
+    : Decoder{useJsonFormat, includePktMatch} {
+  decode(msg);
+}
+
+/// \brief Private constructor used when we need to recursively decode an
+/// inner OpenFlow message, like in RequestForward messages.
+Decoder::Decoder(const Message *msg, const Decoder *decoder)
+    : msg_{msg}, context_{this, msg->version(), false} {
   assert(msg->size() >= sizeof(Header));
+  context_.base64Bytes = decoder->context_.base64Bytes;
+}
 
-  llvm::raw_svector_ostream rss{result_};
-  detail::YamlContext ctxt{this, msg->version(), includePktMatch};
+bool Decoder::decode(const Message *msg) {
+  result_.clear();
+  decodeTo(msg);
 
-  if (useJsonFormat) {
-    ofp::yaml::OutputJson yout{rss, &ctxt};
-    yout << *this;
-  } else {
-    llvm::yaml::Output yout{rss, &ctxt};
-    yout << *this;
+  if (!error_.empty()) {
+    result_.clear();
+    return false;
   }
 
-  (void)rss.str();
+  return true;
+}
+
+bool Decoder::decode(const Message *msg, ByteList *output) {
+  size_t size = output->size();
+  result_.clear();
+
+  stream_.setOutput(output);
+  decodeTo(msg);
+  stream_.setOutput(nullptr);
+
   if (!error_.empty()) {
-    result_.clear();
+    output->resize(size);
+    return false;
   }
+
+  return true;
 }
 
-/// \brief Private constructor used when we need to recursively decode an
-/// inner OpenFlow message, like in RequestForward messages.
-Decoder::Decoder(const Message *msg, const Decoder *decoder) : msg_{msg} {
+/// Decode `msg` to the output stream.
+void Decoder::decodeTo(const Message *msg) {
   assert(msg->size() >= sizeof(Header));
+
+  msg_ = msg;
+  error_.clear();
+  context_.version = msg->version();
+
+  if (useJsonFormat_) {
+    jsonOut_ << *this;
+  } else {
+    yamlOut_ << *this;
+  }
 }
 
 template <class MsgType>
-inline bool decode(llvm::yaml::IO &io, const Message *msg) {
+inline bool decodeType(llvm::yaml::IO &io, const Message *msg) {
   const MsgType *m = MsgType::cast(msg);
   if (m == nullptr)
     return false;
-  io.mapRequired("msg", RemoveConst_cast(*m));
+  if (io.outputtingJson()) {
+    // Message types with JsonTraits bypass the virtual IO interface.
+    JsonWriter json{static_cast<OutputJson &>(io)};
+    json.mapRequired("msg", RemoveConst_cast(*m));
+  } else {
+    io.mapRequired("msg", RemoveConst_cast(*m));
+  }
+  return true;
+}
+
+template <class SeqType>
+inline void decodeReplySeq(llvm::yaml::IO &io, MultipartReply &reply) {
+  SeqType seq{reply};
+  JsonWriter json{static_cast<OutputJson &>(io)};
+  json.mapRequired("msg", seq);
+}
+
+/// Decode the body of a multipart reply. When outputting JSON, the most
+/// common stats replies use JsonWriter.
+inline bool decodeMultipartReply(llvm::yaml::IO &io, const Message *msg) {
+  using ofp::detail::MPReplyFixedSizeSeq;
+  using ofp::detail::MPReplyVariableSizeSeq;
+
+  const MultipartReply *m = MultipartReply::cast(msg);
+  if (m == nullptr)
+    return false;
+
+  MultipartReply &reply = RemoveConst_cast(*m);
+  if (io.outputtingJson()) {
+    switch (reply.replyType()) {
+      case OFPMP_FLOW_DESC:
+        decodeReplySeq<MPReplyVariableSizeSeq<MPFlowStatsReply>>(io, reply);
+        return true;
+      case OFPMP_TABLE_STATS:
+        decodeReplySeq<MPReplyFixedSizeSeq<MPTableStats>>(io, reply);
+        return true;
+      case OFPMP_PORT_STATS:
+        decodeReplySeq<MPReplyVariableSizeSeq<MPPortStats>>(io, reply);
+        return true;
+      case OFPMP_QUEUE_STATS:
+        decodeReplySeq<MPReplyFixedSizeSeq<MPQueueStats>>(io, reply);
+        return true;
+      case OFPMP_PORT_DESC:
+        decodeReplySeq<MPReplyVariableSizeSeq<Port>>(io, reply);
+        return true;
+      default:
+        break;
+    }
+  }
+
+  llvm::yaml::MappingTraits<MultipartReply>::decode(io, reply, msg->subtype(),
+                                                    "msg");
   return true;
 }
 
@@ -87,83 +170,83 @@ inline bool decodeMultipart(llvm::yaml::IO &io, const Message *msg) {
 bool Decoder::decodeMsg(llvm::yaml::IO &io) {
   switch (msg_->type()) {
     case Hello::type():
-      return decode<Hello>(io, msg_);
+      return decodeType<Hello>(io, msg_);
     case Error::type():
-      return decode<Error>(io, msg_);
+      return decodeType<Error>(io, msg_);
     case EchoRequest::type():
-      return decode<EchoRequest>(io, msg_);
+      return decodeType<EchoRequest>(io, msg_);
     case EchoReply::type():
-      return decode<EchoReply>(io, msg_);
+      return decodeType<EchoReply>(io, msg_);
     case Experimenter::type():
-      return decode<Experimenter>(io, msg_);
+      return decodeType<Experimenter>(io, msg_);
     case FlowMod::type():
-      return decode<FlowMod>(io, msg_);
+      return decodeType<FlowMod>(io, msg_);
     case FeaturesRequest::type():
-      return decode<FeaturesRequest>(io, msg_);
+      return decodeType<FeaturesRequest>(io, msg_);
     case FeaturesReply::type():
-      return decode<FeaturesReply>(io, msg_);
+      return decodeType<FeaturesReply>(io, msg_);
     case GetConfigRequest::type():
-      return decode<GetConfigRequest>(io, msg_);
+      return decodeType<GetConfigRequest>(io, msg_);
     case GetConfigReply::type():
-      return decode<GetConfigReply>(io, msg_);
+      return decodeType<GetConfigReply>(io, msg_);
     case MultipartRequest::type():
       return decodeMultipart<MultipartRequest>(io, msg_);
     case MultipartReply::type():
-      return decodeMultipart<MultipartReply>(io, msg_);
+      return decodeMultipartReply(io, msg_);
     case BarrierRequest::type():
-      return decode<BarrierRequest>(io, msg_);
+      return decodeType<BarrierRequest>(io, msg_);
     case BarrierReply::type():
-      return decode<BarrierReply>(io, msg_);
+      return decodeType<BarrierReply>(io, msg_);
     case GetAsyncRequest::type():
-      return decode<GetAsyncRequest>(io, msg_);
+      return decodeType<GetAsyncRequest>(io, msg_);
     case PacketIn::type():
-      return decode<PacketIn>(io, msg_);
+      return decodeType<PacketIn>(io, msg_);
     case PacketOut::type():
       if (msg_->version() < OFP_VERSION_6) {
-        return decode<PacketOut>(io, msg_);
+        return decodeType<PacketOut>(io, msg_);
       } else {
-        return decode<PacketOutV6>(io, msg_);
+        return decodeType<PacketOutV6>(io, msg_);
       }
     case SetConfig::type():
-      return decode<SetConfig>(io, msg_);
+      return decodeType<SetConfig>(io, msg_);
     case PortStatus::type():
-      return decode<PortStatus>(io, msg_);
+      return decodeType<PortStatus>(io, msg_);
     case GroupMod::type():
-      return decode<GroupMod>(io, msg_);
+      return decodeType<GroupMod>(io, msg_);
     case PortMod::type():
-      return decode<PortMod>(io, msg_);
+      return decodeType<PortMod>(io, msg_);
     case TableMod::type():
-      return decode<TableMod>(io, msg_);
+      return decodeType<TableMod>(io, msg_);
     case RoleRequest::type():
-      return decode<RoleRequest>(io, msg_);
+      return decodeType<RoleRequest>(io, msg_);
     case RoleReply::type():
-      return decode<RoleReply>(io, msg_);
+      return decodeType<RoleReply>(io, msg_);
     case GetAsyncReply::type():
-      return decode<GetAsyncReply>(io, msg_);
+      return decodeType<GetAsyncReply>(io, msg_);
     case SetAsync::type():
-      return decode<SetAsync>(io, msg_);
+      return decodeType<SetAsync>(io, msg_);
     case QueueGetConfigRequest::type():
-      return decode<QueueGetConfigRequest>(io, msg_);
+      return decodeType<QueueGetConfigRequest>(io, msg_);
     case QueueGetConfigReply::type():
-      return decode<QueueGetConfigReply>(io, msg_);
+      return decodeType<QueueGetConfigReply>(io, msg_);
     case FlowRemoved::type():
       if (msg_->version() < OFP_VERSION_6) {
-        return decode<FlowRemoved>(io, msg_);
+        return decodeType<FlowRemoved>(io, msg_);
       } else {
-        return decode<FlowRemovedV6>(io, msg_);
+        return decodeType<FlowRemovedV6>(io, msg_);
       }
     case MeterMod::type():
-      return decode<MeterMod>(io, msg_);
+      return decodeType<MeterMod>(io, msg_);
     case RoleStatus::type():
-      return decode<RoleStatus>(io, msg_);
+      return decodeType<RoleStatus>(io, msg_);
     case BundleControl::type():
-      return decode<BundleControl>(io, msg_);
+      return decodeType<BundleControl>(io, msg_);
     case BundleAddMessage::type():
-      return decode<BundleAddMessage>(io, msg_);
+      return decodeType<BundleAddMessage>(io, msg_);
     case RequestForward::type():
       return decodeRequestForward(io, msg_);
     case TableStatus::type():
-      return decode<TableStatus>(io, msg_);
+      return decodeType<TableStatus>(io, msg_);
     default:
       OFPErrorCode error;
       Validation context{msg_, &error};
@@ -196,3 +279,16 @@ void ofp::yaml::DecodeRecursively(llvm::yaml::IO &io, const char *key,
 
   outerDecoder->setError(decoder.error());
 }
+
+void ofp::yaml::detail::DecoderStream::write_impl(const char *ptr,
+                                                  size_t size) {
+  if (output_) {
+    output_->add(ptr, size);
+  } else {
+    result_->append(ptr, ptr + size);
+  }
+}
+
+uint64_t ofp::yaml::detail::DecoderStream::current_pos() const {
+  return output_ ? output_->size() : result_->size();
+}
@@ -4,6 +4,7 @@
 #include "ofp/yaml/encoder.h"
 
 #include "ofp/requestforward.h"
+#include "ofp/yaml/inputjson.h"
 #include "ofp/yaml/ybundleaddmessage.h"
 #include "ofp/yaml/ybundlecontrol.h"
 #include "ofp/yaml/yecho.h"
@@ -38,6 +39,18 @@
 using namespace ofp;
 using namespace ofp::yaml;
 
+// Read the encoder's mapping from the input. Return true if there's no error.
+template <class InputType>
+static bool readInput(InputType &yin, Encoder *encoder) {
+  ofp::yaml::detail::YamlContext ctxt{encoder, &yin};
+  yin.setContext(&ctxt);
+  if (!yin.error()) {
+    yin >> *encoder;
+  }
+  yin.setContext(nullptr);
+  return !yin.error();
+}
+
 Encoder::Encoder(ChannelFinder finder)
     : errorStream_{error_},
       header_{OFPT_UNSUPPORTED},
@@ -57,21 +70,39 @@ Encoder::Encoder(const Encoder *encoder)
 
 Encoder::Encoder(const std::string &input, bool matchPrereqsChecked,
                  int lineNumber, UInt8 defaultVersion, ChannelFinder finder)
+    : Encoder{nullptr,        input,  matchPrereqsChecked, lineNumber,
+              defaultVersion, finder, true} {}
+
+Encoder::Encoder(InputJson *parser, llvm::StringRef input,
+                 bool matchPrereqsChecked, int lineNumber,
+                 UInt8 defaultVersion, ChannelFinder finder,
+                 bool nullTerminated)
     : errorStream_{error_},
       header_{OFPT_UNSUPPORTED},
       finder_{finder},
       lineNumber_{lineNumber},
       defaultVersion_{defaultVersion},
       matchPrereqsChecked_{matchPrereqsChecked} {
-  llvm::yaml::Input yin{input, nullptr, Encoder::diagnosticHandler, this};
-  detail::YamlContext ctxt{this, &yin};
-  yin.setContext(&ctxt);
-  if (!yin.error()) {
-    yin >> *this;
+  // Use the fast JSON reader if the input is a strict JSON object.
+  bool ok;
+  InputJson local;
+  InputJson &jin = parser ? *parser : local;
+  jin.reset(input, Encoder::diagnosticHandler, this);
+  if (jin.valid()) {
+    ok = readInput(jin, this);
+  } else {
+    // llvm::yaml::Input expects a null-terminated buffer. The input may be a
+    // slice of a larger buffer, e.g. a memory-mapped file.
+    std::string copy;
+    if (!nullTerminated) {
+      copy = input.str();
+      input = copy;
+    }
+    llvm::yaml::Input yin{input, nullptr, Encoder::diagnosticHandler, this};
+    ok = readInput(yin, this);
   }
-  yin.setContext(nullptr);
 
-  if (yin.error()) {
+  if (!ok) {
     // Make sure error string is set. There won't be an error string if the
     // document is empty.
     if (error().empty()) {
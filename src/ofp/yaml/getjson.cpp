@@ -3,6 +3,10 @@
 
 #include "ofp/yaml/getjson.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+
 static void scanDoubleQuotes(std::istream &input, std::string &json,
                              int &newlineCount) {
   char ch = 0;
@@ -73,7 +77,7 @@ bool ofp::yaml::getjson(std::istream &input, std::string &json, int &lineNum,
   return false;
 }
 
-static bool isEmptyOrWhitespaceOnly(std::string &s) {
+static bool isEmptyOrWhitespaceOnly(llvm::StringRef s) {
   return std::find_if(s.begin(), s.end(),
                       [](char ch) { return !isspace(ch); }) == s.end();
 }
@@ -140,3 +144,322 @@ bool ofp::yaml::getline(std::istream &input, std::string &line, int &lineNum,
 
   return false;
 }
+
+// The in-memory getjson scans 64-byte blocks at a time. Each block is reduced
+// to bit masks of the characters that matter ('{', '}', '"', '\\' and '\n'),
+// so whole runs of ordinary characters are skipped at once.
+//
+// Backslashes are rare in this input. A block that contains one is scanned a
+// byte at a time, which keeps the escape and line counting rules identical to
+// the stream version.
+
+namespace {
+
+const size_t kBlockSize = 64;
+
+struct BlockMasks {
+  ofp::UInt64 open;
+  ofp::UInt64 close;
+  ofp::UInt64 quote;
+  ofp::UInt64 backslash;
+  ofp::UInt64 newline;
+};
+
+struct ScanState {
+  int depth;
+  bool inString;
+  bool escaped;
+};
+
+}  // namespace
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+static ofp::UInt64 blockMask(const __m128i chunks[4], char ch) {
+  const __m128i val = _mm_set1_epi8(ch);
+  ofp::UInt64 m0 = ofp::Unsigned_cast(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(chunks[0], val)));
+  ofp::UInt64 m1 = ofp::Unsigned_cast(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(chunks[1], val)));
+  ofp::UInt64 m2 = ofp::Unsigned_cast(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(chunks[2], val)));
+  ofp::UInt64 m3 = ofp::Unsigned_cast(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(chunks[3], val)));
+  return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+}
+
+static void scanBlock(const char *block, BlockMasks *masks) {
+  const __m128i *p = reinterpret_cast<const __m128i *>(block);
+  const __m128i chunks[4] = {_mm_loadu_si128(p), _mm_loadu_si128(p + 1),
+                             _mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)};
+
+  masks->open = blockMask(chunks, '{');
+  masks->close = blockMask(chunks, '}');
+  masks->quote = blockMask(chunks, '"');
+  masks->backslash = blockMask(chunks, '\\');
+  masks->newline = blockMask(chunks, '\n');
+}
+
+#else
+
+static void scanBlock(const char *block, BlockMasks *masks) {
+  std::memset(masks, 0, sizeof(BlockMasks));
+
+  for (unsigned i = 0; i < kBlockSize; ++i) {
+    const ofp::UInt64 bit = ofp::UInt64{1} << i;
+    switch (block[i]) {
+      case '{':
+        masks->open |= bit;
+        break;
+      case '}':
+        masks->close |= bit;
+        break;
+      case '"':
+        masks->quote |= bit;
+        break;
+      case '\\':
+        masks->backslash |= bit;
+        break;
+      case '\n':
+        masks->newline |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+#endif  // defined(__x86_64__) && defined(__GNUC__)
+
+// Return the masks for the block at `pos`. If fewer than 64 bytes remain, the
+// block is padded with zeros; `valid` has a bit set for each real byte.
+static void loadBlock(const char *pos, const char *end, BlockMasks *masks,
+                      ofp::UInt64 *valid) {
+  size_t len = ofp::Unsigned_cast(end - pos);
+  if (len >= kBlockSize) {
+    scanBlock(pos, masks);
+    *valid = ~ofp::UInt64{0};
+  } else {
+    char tail[kBlockSize] = {};
+    std::memcpy(tail, pos, len);
+    scanBlock(tail, masks);
+    *valid = (ofp::UInt64{1} << len) - 1;
+  }
+}
+
+// Return a mask with bits set from each unescaped quote up to the next one,
+// i.e. the bytes inside strings.
+static ofp::UInt64 prefixXor(ofp::UInt64 bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+static ofp::UInt64 lowBits(unsigned count) {
+  return count >= kBlockSize ? ~ofp::UInt64{0}
+                             : (ofp::UInt64{1} << count) - 1;
+}
+
+// Scan [pos, end) a byte at a time. Return the position just past the '}' that
+// closes the object, or `end`.
+static const char *scanBytes(const char *pos, const char *end,
+                             ScanState *state, int &newlineCount) {
+  while (pos < end) {
+    char ch = *pos++;
+
+    if (state->inString) {
+      if (state->escaped) {
+        state->escaped = false;
+      } else if (ch == '"') {
+        state->inString = false;
+      } else if (ch == '\\') {
+        state->escaped = true;
+      } else if (ch == '\n') {
+        ++newlineCount;
+      }
+      continue;
+    }
+
+    switch (ch) {
+      case '{':
+        ++state->depth;
+        break;
+      case '}':
+        if (--state->depth == 0) {
+          return pos;
+        }
+        break;
+      case '"':
+        state->inString = true;
+        break;
+      case '\n':
+        ++newlineCount;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return pos;
+}
+
+// Return the position just past the '}' that closes the object whose opening
+// '{' precedes `pos`, or `end` if the object is incomplete.
+static const char *scanObject(const char *pos, const char *end,
+                              int &newlineCount) {
+  ScanState state = {1, false, false};
+
+  while (pos < end) {
+    BlockMasks masks;
+    ofp::UInt64 valid;
+    loadBlock(pos, end, &masks, &valid);
+
+    const char *blockEnd =
+        pos + std::min(kBlockSize, ofp::Unsigned_cast(end - pos));
+
+    if ((masks.backslash & valid) || state.escaped) {
+      const char *result = scanBytes(pos, blockEnd, &state, newlineCount);
+      if (state.depth == 0) {
+        return result;
+      }
+      pos = blockEnd;
+      continue;
+    }
+
+    ofp::UInt64 inString = prefixXor(masks.quote & valid);
+    if (state.inString) {
+      inString = ~inString;
+    }
+
+    ofp::UInt64 braces = (masks.open | masks.close) & ~inString & valid;
+    if ((masks.close & braces) == 0) {
+      state.depth += __builtin_popcountll(braces);
+    } else {
+      while (braces) {
+        unsigned i = ofp::Unsigned_cast(__builtin_ctzll(braces));
+        if (masks.open & (ofp::UInt64{1} << i)) {
+          ++state.depth;
+        } else if (--state.depth == 0) {
+          newlineCount += __builtin_popcountll(masks.newline & lowBits(i));
+          return pos + i + 1;
+        }
+        braces &= braces - 1;
+      }
+    }
+
+    newlineCount += __builtin_popcountll(masks.newline & valid);
+    state.inString = (inString >> (kBlockSize - 1)) != 0;
+    pos = blockEnd;
+  }
+
+  return pos;
+}
+
+bool ofp::yaml::getjson(llvm::StringRef &input, llvm::StringRef &json,
+                        int &lineNum, int &newlineCount) {
+  const char *pos = input.begin();
+  const char *end = input.end();
+
+  json = llvm::StringRef{};
+  lineNum = -1;
+
+  // Look for the '{' that starts the next object.
+  while (pos < end) {
+    BlockMasks masks;
+    UInt64 valid;
+    loadBlock(pos, end, &masks, &valid);
+
+    UInt64 open = masks.open & valid;
+    if (open == 0) {
+      newlineCount += __builtin_popcountll(masks.newline & valid);
+      pos += std::min(kBlockSize, ofp::Unsigned_cast(end - pos));
+      continue;
+    }
+
+    unsigned i = Unsigned_cast(__builtin_ctzll(open));
+    newlineCount += __builtin_popcountll(masks.newline & lowBits(i));
+
+    const char *begin = pos + i;
+    lineNum = newlineCount + 1;
+    pos = scanObject(begin + 1, end, newlineCount);
+    json = llvm::StringRef{begin, Unsigned_cast(pos - begin)};
+    input = llvm::StringRef{pos, Unsigned_cast(end - pos)};
+    return true;
+  }
+
+  input = llvm::StringRef{end, 0};
+  return false;
+}
+
+// Remove the next line from `input` and return it, without the line ending.
+static llvm::StringRef nextLine(llvm::StringRef &input) {
+  size_t eol = input.find('\n');
+  llvm::StringRef line = input.substr(0, eol);
+  input = input.drop_front(eol == llvm::StringRef::npos ? input.size()
+                                                         : eol + 1);
+
+  if (line.endswith("\r")) {
+    line = line.drop_back();
+  }
+
+  return line;
+}
+
+bool ofp::yaml::getyaml(llvm::StringRef &input, llvm::StringRef &yaml,
+                        int &lineNum, int &newlineCount) {
+  int msgSize = 0;
+  const char *begin = input.begin();
+
+  while (!input.empty()) {
+    const char *lineBegin = input.begin();
+    llvm::StringRef line = nextLine(input);
+    ++newlineCount;
+
+    if (line == "---" || line == "...") {
+      yaml = llvm::StringRef{begin, Unsigned_cast(lineBegin - begin)};
+      if (isEmptyOrWhitespaceOnly(yaml)) {
+        // Don't return empty messages.
+        msgSize = 0;
+        begin = input.begin();
+        continue;
+      }
+      lineNum = newlineCount - msgSize;
+      return true;
+    }
+    ++msgSize;
+  }
+
+  yaml = llvm::StringRef{begin, Unsigned_cast(input.begin() - begin)};
+  if (isEmptyOrWhitespaceOnly(yaml)) {
+    yaml = llvm::StringRef{};
+    lineNum = -1;
+    return false;
+  }
+
+  lineNum = newlineCount - msgSize + 1;
+
+  return true;
+}
+
+bool ofp::yaml::getline(llvm::StringRef &input, llvm::StringRef &line,
+                        int &lineNum, int &newlineCount) {
+  while (!input.empty()) {
+    llvm::StringRef lineBuf = nextLine(input);
+    ++newlineCount;
+
+    if (!isEmptyOrWhitespaceOnly(lineBuf)) {
+      line = lineBuf;
+      lineNum = newlineCount;
+      return true;
+    }
+  }
+
+  lineNum = -1;
+  line = llvm::StringRef{};
+
+  return false;
+}
@@ -0,0 +1,568 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/yaml/inputjson.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace ofp;
+using namespace ofp::yaml;
+using namespace llvm;
+
+// Deeper input is handed to llvm::yaml::Input.
+const unsigned kMaxDepth = 256;
+
+static const char *skipWhitespace(const char *pos, const char *end) {
+  while (pos < end &&
+         (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t'))
+    ++pos;
+  return pos;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Append code point to result in UTF-8. Like llvm::yaml::Scanner, each \uXXXX
+// escape is encoded on its own; surrogate pairs are not combined.
+static void encodeUTF8(UInt32 cp, SmallVectorImpl<char> &result) {
+  if (cp <= 0x7F) {
+    result.push_back(static_cast<char>(cp));
+  } else if (cp <= 0x7FF) {
+    result.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    result.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+// Unescape the contents of a validated JSON string (without quotes).
+static void unescape(StringRef s, SmallVectorImpl<char> &result) {
+  for (size_t i = 0; i < s.size(); ++i) {
+    char c = s[i];
+    if (c != '\\') {
+      result.push_back(c);
+      continue;
+    }
+    switch (s[++i]) {
+      case 'b':
+        result.push_back('\b');
+        break;
+      case 'f':
+        result.push_back('\f');
+        break;
+      case 'n':
+        result.push_back('\n');
+        break;
+      case 'r':
+        result.push_back('\r');
+        break;
+      case 't':
+        result.push_back('\t');
+        break;
+      case 'u': {
+        UInt32 cp = 0;
+        for (size_t j = i + 1; j < i + 5; ++j) {
+          cp = (cp << 4) | static_cast<UInt32>(hexValue(s[j]));
+        }
+        encodeUTF8(cp, result);
+        i += 4;
+        break;
+      }
+      default:  // '"', '\\' and '/'
+        result.push_back(s[i]);
+        break;
+    }
+  }
+}
+
+InputJson::InputJson()
+    : IO{nullptr}, diagHandler_{nullptr}, diagHandlerCtxt_{nullptr} {}
+
+InputJson::InputJson(StringRef input, void *ctxt,
+                     SourceMgr::DiagHandlerTy diagHandler,
+                     void *diagHandlerCtxt)
+    : IO{ctxt} {
+  reset(input, diagHandler, diagHandlerCtxt);
+}
+
+void InputJson::reset(StringRef input, SourceMgr::DiagHandlerTy diagHandler,
+                      void *diagHandlerCtxt) {
+  input_ = input;
+  diagHandler_ = diagHandler;
+  diagHandlerCtxt_ = diagHandlerCtxt;
+
+  // Keep the capacity of the token arrays and the allocator's first slab.
+  nodes_.clear();
+  unescaped_.clear();
+  bitValuesUsed_.clear();
+  stringAllocator_.Reset();
+  current_ = 0;
+  error_ = std::error_code{};
+  scalarMatchFound_ = false;
+
+  const char *pos = skipWhitespace(input.begin(), input.end());
+  if (pos == input.end() || *pos != '{' || input.size() > UINT32_MAX)
+    return;
+
+  nodes_.reserve(input.size() / 8);
+  if (!parseValue(pos, 0) || skipWhitespace(pos, input.end()) != input.end()) {
+    nodes_.clear();
+  }
+}
+
+InputJson::~InputJson() {}
+
+bool InputJson::setCurrentDocument() {
+  current_ = 0;
+  return valid() && !error_;
+}
+
+unsigned InputJson::beginSequence() {
+  const Node &node = nodes_[current_];
+  if (node.kind == kSeq)
+    return node.count;
+  // Treat case where there's a scalar "null" value as an empty sequence.
+  if (isScalar(current_) && llvm::yaml::isNull(value(current_)))
+    return 0;
+  setError(current_, "not a sequence");
+  return 0;
+}
+
+bool InputJson::preflightElement(unsigned Index, void *&SaveInfo) {
+  if (error_ || nodes_[current_].kind != kSeq)
+    return false;
+  SaveInfo = toSaveInfo(current_);
+  current_ = element(current_, Index);
+  return true;
+}
+
+void InputJson::postflightElement(void *SaveInfo) {
+  current_ = fromSaveInfo(SaveInfo);
+}
+
+void InputJson::beginMapping() {
+  if (error_ || nodes_[current_].kind != kMap)
+    return;
+  for (size_t key = current_ + 1; key < nodes_[current_].next;
+       key = nodes_[key + 1].next) {
+    nodes_[key].used = false;
+  }
+}
+
+void InputJson::endMapping() {
+  if (error_ || nodes_[current_].kind != kMap)
+    return;
+  for (size_t key = current_ + 1; key < nodes_[current_].next;
+       key = nodes_[key + 1].next) {
+    if (!nodes_[key].used) {
+      setError(key + 1, Twine("unknown key '") + value(key) + "'");
+      break;
+    }
+  }
+}
+
+bool InputJson::preflightKey(const char *Key, bool Required, bool,
+                             bool &UseDefault, void *&SaveInfo) {
+  UseDefault = false;
+  if (error_)
+    return false;
+
+  if (nodes_[current_].kind != kMap) {
+    setError(current_, "not a mapping");
+    return false;
+  }
+
+  size_t key = findKey(current_, Key);
+  if (!key) {
+    if (Required)
+      setError(current_, Twine("missing required key '") + Key + "'");
+    else
+      UseDefault = true;
+    return false;
+  }
+
+  SaveInfo = toSaveInfo(current_);
+  current_ = key + 1;
+  return true;
+}
+
+void InputJson::postflightKey(void *SaveInfo) {
+  current_ = fromSaveInfo(SaveInfo);
+}
+
+std::vector<StringRef> InputJson::keys() {
+  std::vector<StringRef> result;
+  if (nodes_[current_].kind != kMap) {
+    setError(current_, "not a mapping");
+    return result;
+  }
+  for (size_t key = current_ + 1; key < nodes_[current_].next;
+       key = nodes_[key + 1].next) {
+    result.push_back(value(key));
+  }
+  return result;
+}
+
+bool InputJson::matchEnumScalar(const char *Str, bool) {
+  if (scalarMatchFound_)
+    return false;
+  if (isScalar(current_) && value(current_).equals(Str)) {
+    scalarMatchFound_ = true;
+    return true;
+  }
+  return false;
+}
+
+bool InputJson::matchEnumFallback() {
+  if (scalarMatchFound_)
+    return false;
+  scalarMatchFound_ = true;
+  return true;
+}
+
+void InputJson::endEnumScalar() {
+  if (!scalarMatchFound_) {
+    setError(current_, "unknown enumerated scalar");
+  }
+}
+
+bool InputJson::beginBitSetScalar(bool &DoClear) {
+  bitValuesUsed_.clear();
+  if (nodes_[current_].kind == kSeq) {
+    bitValuesUsed_.resize(nodes_[current_].count, false);
+  } else {
+    setError(current_, "expected sequence of bit values");
+  }
+  DoClear = true;
+  return true;
+}
+
+bool InputJson::bitSetMatch(const char *Str, bool) {
+  if (error_)
+    return false;
+  if (nodes_[current_].kind != kSeq) {
+    setError(current_, "expected sequence of bit values");
+    return false;
+  }
+  unsigned index = 0;
+  for (size_t elem = current_ + 1; elem < nodes_[current_].next;
+       elem = nodes_[elem].next, ++index) {
+    if (!isScalar(elem)) {
+      setError(current_, "unexpected scalar in sequence of bit values");
+    } else if (value(elem).equals(Str)) {
+      bitValuesUsed_[index] = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void InputJson::endBitSetScalar() {
+  if (error_ || nodes_[current_].kind != kSeq)
+    return;
+  unsigned index = 0;
+  for (size_t elem = current_ + 1; elem < nodes_[current_].next;
+       elem = nodes_[elem].next, ++index) {
+    if (!bitValuesUsed_[index]) {
+      setError(elem, "unknown bit value");
+      return;
+    }
+  }
+}
+
+bool InputJson::bitSetMatchOther(uint32_t &Val) {
+  if (error_)
+    return false;
+  if (nodes_[current_].kind != kSeq) {
+    setError(current_, "expected sequence of bit values");
+    return false;
+  }
+  unsigned index = 0;
+  for (size_t elem = current_ + 1; elem < nodes_[current_].next;
+       elem = nodes_[elem].next, ++index) {
+    if (!isScalar(elem)) {
+      setError(current_, "unexpected scalar in sequence of bit values");
+      continue;
+    }
+    StringRef s = value(elem);
+    if (!s.empty() && isDigit(s.front()) && !s.getAsInteger(0, Val)) {
+      bitValuesUsed_[index] = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+StringRef InputJson::bitSetCaseUnmatched() {
+  if (error_ || nodes_[current_].kind != kSeq)
+    return "";
+  unsigned index = 0;
+  for (size_t elem = current_ + 1; elem < nodes_[current_].next;
+       elem = nodes_[elem].next, ++index) {
+    if (!bitValuesUsed_[index] && isScalar(elem))
+      return value(elem);
+  }
+  return "";
+}
+
+void InputJson::scalarString(StringRef &S, llvm::yaml::QuotingType) {
+  if (isScalar(current_)) {
+    S = value(current_);
+  } else {
+    setError(current_, "unexpected scalar");
+  }
+}
+
+llvm::yaml::NodeKind InputJson::getNodeKind() {
+  switch (nodes_[current_].kind) {
+    case kMap:
+      return llvm::yaml::NodeKind::Map;
+    case kSeq:
+      return llvm::yaml::NodeKind::Sequence;
+    default:
+      return llvm::yaml::NodeKind::Scalar;
+  }
+}
+
+void InputJson::setError(const Twine &message) {
+  setError(current_, message);
+}
+
+void InputJson::setError(size_t index, const Twine &message) {
+  // The SourceMgr is only needed to format the diagnostic.
+  SourceMgr sourceMgr;
+  if (diagHandler_)
+    sourceMgr.setDiagHandler(diagHandler_, diagHandlerCtxt_);
+  sourceMgr.AddNewSourceBuffer(MemoryBuffer::getMemBuffer(input_, "YAML", false),
+                               SMLoc());
+
+  const Node &node = nodes_[index];
+  const char *begin = input_.begin() + node.begin;
+  if (node.kind == kMap || node.kind == kSeq) {
+    // Like llvm::yaml::Input, report a flow collection at its first token.
+    SMLoc loc = SMLoc::getFromPointer(skipWhitespace(begin + 1, input_.end()));
+    sourceMgr.PrintMessage(loc, SourceMgr::DK_Error, message);
+  } else {
+    SMLoc loc = SMLoc::getFromPointer(begin);
+    SMRange range{loc, SMLoc::getFromPointer(input_.begin() + node.end)};
+    sourceMgr.PrintMessage(loc, SourceMgr::DK_Error, message, range);
+  }
+
+  error_ = std::make_error_code(std::errc::invalid_argument);
+}
+
+bool InputJson::parseValue(const char *&pos, unsigned depth) {
+  const char *end = input_.end();
+  switch (*pos) {
+    case '{':
+    case '[': {
+      if (depth >= kMaxDepth)
+        return false;
+
+      bool isMap = (*pos == '{');
+      char close = isMap ? '}' : ']';
+      size_t index = addNode(isMap ? kMap : kSeq, pos);
+      UInt32 count = 0;
+
+      pos = skipWhitespace(pos + 1, end);
+      if (pos < end && *pos == close) {
+        ++pos;
+      } else {
+        for (;;) {
+          if (isMap) {
+            if (pos == end || *pos != '"' || !parseString(pos))
+              return false;
+            pos = skipWhitespace(pos, end);
+            if (pos == end || *pos != ':')
+              return false;
+            pos = skipWhitespace(pos + 1, end);
+          }
+          if (pos == end || !parseValue(pos, depth + 1))
+            return false;
+          ++count;
+          pos = skipWhitespace(pos, end);
+          if (pos == end)
+            return false;
+          if (*pos == close) {
+            ++pos;
+            break;
+          }
+          if (*pos != ',')
+            return false;
+          pos = skipWhitespace(pos + 1, end);
+        }
+      }
+
+      Node &node = nodes_[index];
+      node.end = static_cast<UInt32>(pos - input_.begin());
+      node.next = static_cast<UInt32>(nodes_.size());
+      node.count = count;
+      return true;
+    }
+    case '"':
+      return parseString(pos);
+    case 't':
+    case 'f':
+    case 'n': {
+      StringRef literal = (*pos == 't') ? "true" : (*pos == 'f') ? "false"
+                                                                 : "null";
+      if (!StringRef{pos, static_cast<size_t>(end - pos)}.startswith(literal))
+        return false;
+      size_t index = addNode(kScalar, pos);
+      pos += literal.size();
+      nodes_[index].end = static_cast<UInt32>(pos - input_.begin());
+      return true;
+    }
+    default:
+      return parseNumber(pos);
+  }
+}
+
+bool InputJson::parseString(const char *&pos) {
+  const char *begin = pos;
+  const char *end = input_.end();
+  bool escaped = false;
+
+  for (++pos; pos < end; ++pos) {
+    unsigned char c = static_cast<unsigned char>(*pos);
+    if (c == '"')
+      break;
+    if (c < 0x20)
+      return false;
+    if (c == '\\') {
+      if (++pos == end)
+        return false;
+      escaped = true;
+      switch (*pos) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+          break;
+        case 'u':
+          if (end - pos < 5)
+            return false;
+          for (int i = 1; i <= 4; ++i) {
+            if (hexValue(pos[i]) < 0)
+              return false;
+          }
+          pos += 4;
+          break;
+        default:
+          return false;
+      }
+    }
+  }
+
+  if (pos == end)
+    return false;
+
+  size_t index = addNode(kString, begin);
+  Node &node = nodes_[index];
+  node.end = static_cast<UInt32>(++pos - input_.begin());
+
+  if (escaped) {
+    // Unescape the string now so value() never has to.
+    SmallString<64> buf;
+    unescape(StringRef{begin + 1, static_cast<size_t>(pos - begin - 2)}, buf);
+    node.escaped = true;
+    node.count = static_cast<UInt32>(unescaped_.size());
+    unescaped_.push_back(buf.str().copy(stringAllocator_));
+  }
+
+  return true;
+}
+
+bool InputJson::parseNumber(const char *&pos) {
+  const char *begin = pos;
+  const char *end = input_.end();
+
+  if (*pos == '-')
+    ++pos;
+  if (pos == end || !isDigit(*pos))
+    return false;
+  if (*pos++ != '0') {
+    while (pos < end && isDigit(*pos))
+      ++pos;
+  }
+  if (pos < end && *pos == '.') {
+    if (++pos == end || !isDigit(*pos))
+      return false;
+    while (pos < end && isDigit(*pos))
+      ++pos;
+  }
+  if (pos < end && (*pos == 'e' || *pos == 'E')) {
+    if (++pos < end && (*pos == '+' || *pos == '-'))
+      ++pos;
+    if (pos == end || !isDigit(*pos))
+      return false;
+    while (pos < end && isDigit(*pos))
+      ++pos;
+  }
+
+  size_t index = addNode(kScalar, begin);
+  nodes_[index].end = static_cast<UInt32>(pos - input_.begin());
+  return true;
+}
+
+size_t InputJson::addNode(NodeKind kind, const char *begin) {
+  size_t index = nodes_.size();
+  UInt32 offset = static_cast<UInt32>(begin - input_.begin());
+  nodes_.push_back(Node{kind, false, false, offset, offset,
+                        static_cast<UInt32>(index + 1), 0, 0, 0});
+  return index;
+}
+
+StringRef InputJson::value(size_t index) {
+  const Node &node = nodes_[index];
+  assert(node.kind == kScalar || node.kind == kString);
+  if (node.escaped)
+    return unescaped_[node.count];
+  if (node.kind == kString)
+    return input_.slice(node.begin + 1, node.end - 1);
+  return input_.slice(node.begin, node.end);
+}
+
+size_t InputJson::findKey(size_t map, StringRef key) {
+  // Like llvm::yaml::Input, the last duplicate key wins. Every duplicate is
+  // marked as used.
+  size_t result = 0;
+  for (size_t k = map + 1; k < nodes_[map].next; k = nodes_[k + 1].next) {
+    if (value(k) == key) {
+      nodes_[k].used = true;
+      result = k;
+    }
+  }
+  return result;
+}
+
+size_t InputJson::element(size_t seq, unsigned index) {
+  // Elements are usually visited in order; resume from the last one.
+  Node &node = nodes_[seq];
+  assert(index < node.count);
+  size_t elem = seq + 1;
+  unsigned i = 0;
+  if (node.cursorNode && node.cursorIndex <= index) {
+    elem = node.cursorNode;
+    i = node.cursorIndex;
+  }
+  for (; i < index; ++i) {
+    elem = nodes_[elem].next;
+  }
+  node.cursorIndex = index;
+  node.cursorNode = static_cast<UInt32>(elem);
+  return elem;
+}
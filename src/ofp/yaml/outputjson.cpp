@@ -206,6 +206,16 @@ void OutputJson::scalarString(StringRef &S, llvm::yaml::QuotingType) {
   output("\"");  // closing quote
 }
 
+void OutputJson::scalarBytes(const void *data, size_t length) {
+  output("\"");
+  if (GetBase64BytesFromContext(*this)) {
+    ofp::RawDataToBase64(data, length, Out);
+  } else {
+    ofp::RawDataToHex(data, length, Out);
+  }
+  output("\"");
+}
+
 void OutputJson::setError(const Twine &message) {}
 
 bool OutputJson::canElideEmptySequence() {
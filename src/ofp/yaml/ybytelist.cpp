@@ -3,6 +3,8 @@
 
 #include "ofp/yaml/ybytelist.h"
 
+#include "ofp/yaml/outputjson.h"
+
 namespace llvm {
 namespace yaml {
 
@@ -13,5 +15,23 @@ void primitive_to_json(JsonByteRange r, llvm::raw_ostream &os) {
   os << '"';
 }
 
+void yamlize(IO &io, ofp::ByteRange &value, bool required, EmptyContext &ctx) {
+  if (io.outputtingJson()) {
+    static_cast<ofp::yaml::OutputJson &>(io).scalarBytes(value.data(),
+                                                         value.size());
+  } else {
+    yamlize<ofp::ByteRange>(io, value, required, ctx);
+  }
+}
+
+void yamlize(IO &io, ofp::ByteList &value, bool required, EmptyContext &ctx) {
+  if (io.outputtingJson()) {
+    static_cast<ofp::yaml::OutputJson &>(io).scalarBytes(value.data(),
+                                                         value.size());
+  } else {
+    yamlize<ofp::ByteList>(io, value, required, ctx);
+  }
+}
+
 }  // namespace yaml
 }  // namespace llvm
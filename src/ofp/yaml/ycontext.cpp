@@ -43,6 +43,15 @@ bool ofp::yaml::GetIncludePktMatchFromContext(llvm::yaml::IO &io) {
   return false;
 }
 
+bool ofp::yaml::GetBase64BytesFromContext(llvm::yaml::IO &io) {
+  YamlContext *ctxt = reinterpret_cast<YamlContext *>(io.getContext());
+  if (ctxt) {
+    assert(ctxt->validate());
+    return ctxt->base64Bytes;
+  }
+  return false;
+}
+
 ofp::yaml::Encoder *YamlContext::GetEncoder(void *context) {
   YamlContext *ctxt = reinterpret_cast<YamlContext *>(context);
   if (ctxt) {
@@ -2110,6 +2110,16 @@ TEST(decoder, tablemodv5) {
       "0xAAAAAAA1\n      data:            0000000100000002\n...\n");
 }
 
+TEST(decoder, tablemod_vacancy_only_v5) {
+  testDecodeEncode(
+      "0511001800000000 FF00000000000000 0003000811223300",
+      "---\ntype:            TABLE_MOD\nxid:             0x00000000\nversion:  "
+      "       0x05\nmsg:             \n  table_id:        ALL\n  config:       "
+      "   [  ]\n  vacancy:         \n    vacancy_down:    0x11\n    "
+      "vacancy_up:      0x22\n    vacancy:         0x33\n  properties:      "
+      "[]\n...\n");
+}
+
 TEST(decoder, tablemod_unrecognized_prop_v5) {
   testDecodeEncode(
       "0511002000000000 FF00000000000000 0001001011223344 5566778899AABBCC",
@@ -2483,3 +2493,133 @@ TEST(decoder, tablefeatures_request) {
       "          IPV4_DST, TCP_SRC, TCP_DST, UDP_SRC, UDP_DST ]\n    "
       "properties:      []\n...\n");
 }
+
+TEST(decoder, reuse) {
+  const char *hexes[] = {
+      // Long TABLE_FEATURES_REQUEST with wrapped flow sequences.
+      "0412018800000001000C0000000000000178000000000000506F72742041434C00000000"
+      "000000000000000000000000000000000000000000000000000000000000000000000000"
+      "00000003000000320000001800010004000300040004000400050004000600040002000B"
+      "0102030405060700000000000004001C0000000400110004001200040016000400170004"
+      "00190004000000000006001C000000040011000400120004001600040017000400190004"
+      "00000000000800348000000480000A028000070C8000090C80000C028000140180001908"
+      "8000372080001E028000200280001A0280001C0200000000000A00348000000480000A02"
+      "800006068000080680000C0280001401800018048000361080001E028000200280001A02"
+      "80001C0200000000000C0030800006068000080680000C0280000E018000100180001604"
+      "8000180480001A0280001C0280001E0280002002000E0030800006068000080680000C02"
+      "80000E0180001001800016048000180480001A0280001C0280001E0280002002",
+      "0100000800000001",
+      // Invalid PACKET_IN.
+      "040a00940000000000000002 002a 010100010203000000000001 "
+      "0058800020240000000680000aa0080680000606ffffffffbfff80000806f20ba47df8ea"
+      "80002a02000180002c140a00000180002e040a00000300003006f20ba47df8ea80003206"
+      "0000000084040000fffffffffffff20ba47df8ea08060001080206040001f20ba47df8ea"
+      "0a0000030000000000000a000003",
+      "0102000E00000007AABBCCDDEEFF",
+  };
+
+  Decoder yamlDecoder{false};
+  Decoder jsonDecoder{true};
+
+  // Decode the list twice, so each message follows a different one.
+  for (size_t i = 0; i < 2 * ArrayLength(hexes); ++i) {
+    auto s = HexToRawData(hexes[i % ArrayLength(hexes)]);
+    Message msg{s.data(), s.size()};
+    msg.normalize();
+
+    // Reusing a decoder produces the same output as a new decoder.
+    Decoder yaml{&msg, false};
+    EXPECT_EQ(yaml.error().empty(), yamlDecoder.decode(&msg));
+    EXPECT_EQ(yaml.error(), yamlDecoder.error());
+    EXPECT_EQ(yaml.result(), yamlDecoder.result());
+
+    Decoder json{&msg, true};
+    EXPECT_EQ(json.error().empty(), jsonDecoder.decode(&msg));
+    EXPECT_EQ(json.error(), jsonDecoder.error());
+    EXPECT_EQ(json.result(), jsonDecoder.result());
+  }
+}
+
+TEST(decoder, decode_bytelist) {
+  auto features = HexToRawData("0405000800000001");
+  Message msg{features.data(), features.size()};
+  msg.normalize();
+
+  auto invalid = HexToRawData("040500090000000100");
+  Message badMsg{invalid.data(), invalid.size()};
+
+  Decoder decoder{true};
+  ByteList output{"[", 1};
+  EXPECT_TRUE(decoder.decode(&msg, &output));
+  EXPECT_EQ("", decoder.result());
+
+  // On error, the output is unchanged.
+  EXPECT_FALSE(decoder.decode(&badMsg, &output));
+  EXPECT_NE("", decoder.error());
+
+  output.add("]", 1);
+  llvm::StringRef text{reinterpret_cast<const char *>(output.data()),
+                       output.size()};
+  EXPECT_EQ(
+      "[{\"type\":\"FEATURES_REQUEST\",\"xid\":1,\"version\":4,\"msg\":{}}]",
+      text);
+
+  // The result buffer is used again when no output is given.
+  EXPECT_TRUE(decoder.decode(&msg));
+  EXPECT_EQ(
+      "{\"type\":\"FEATURES_REQUEST\",\"xid\":1,\"version\":4,\"msg\":{}}",
+      decoder.result());
+}
+
+TEST(decoder, base64_bytes) {
+  Encoder encoder{R"""(
+      version: 4
+      type: PACKET_IN
+      xid: 1
+      msg:
+        buffer_id: 2
+        total_len: 5
+        in_port: 3
+        in_phy_port: 3
+        metadata: 0
+        reason: APPLY_ACTION
+        table_id: 4
+        cookie: 5
+        match: []
+        data: 0102030405
+      )"""};
+  ASSERT_EQ("", encoder.error());
+
+  Message msg{encoder.data(), encoder.size()};
+  msg.normalize();
+
+  Decoder decoder{true};
+  EXPECT_TRUE(decoder.decode(&msg));
+  EXPECT_NE(llvm::StringRef::npos,
+            decoder.result().find("\"data\":\"0102030405\""));
+
+  decoder.setBase64Bytes(true);
+  EXPECT_TRUE(decoder.decode(&msg));
+  EXPECT_NE(llvm::StringRef::npos,
+            decoder.result().find("\"data\":\"AQIDBAU=\""));
+
+  // Byte fields written by the generic JSON output use base64 too.
+  Encoder experimenter{R"""(
+      version: 4
+      type: EXPERIMENTER
+      xid: 1
+      msg:
+        experimenter: 0x12345678
+        exp_type: 1
+        data: 0102030405
+      )"""};
+  ASSERT_EQ("", experimenter.error());
+
+  Message expMsg{experimenter.data(), experimenter.size()};
+  expMsg.normalize();
+  EXPECT_TRUE(decoder.decode(&expMsg));
+  EXPECT_EQ(
+      "{\"type\":\"EXPERIMENTER\",\"xid\":1,\"version\":4,\"msg\":{"
+      "\"experimenter\":305419896,\"exp_type\":1,\"data\":\"AQIDBAU=\"}}",
+      decoder.result());
+}
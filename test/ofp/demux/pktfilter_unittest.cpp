@@ -70,3 +70,34 @@ TEST(pktfilter, setFilter) {
   EXPECT_TRUE(filter.setFilter("icmp"));
   EXPECT_EQ(filter.filter(), "icmp");
 }
+
+TEST(pktfilter, filterset) {
+  demux::PktFilter filters[4];
+  ASSERT_TRUE(filters[0].setFilter("ether src 00:00:00:00:00:03"));
+  ASSERT_TRUE(filters[1].setFilter("ip"));
+  // filters[2] is empty; it never matches.
+  ASSERT_TRUE(filters[3].setFilter("ether src 00:00:00:00:00:01"));
+
+  demux::PktFilterSet filterSet;
+  EXPECT_EQ(filterSet.size(), 0);
+  EXPECT_FALSE(filterSet.isMerged());
+
+  filterSet.setFilters({&filters[0], &filters[1], &filters[2], &filters[3]});
+  EXPECT_EQ(filterSet.size(), 4);
+  EXPECT_TRUE(filterSet.isMerged());
+
+  ByteList ip{HexToRawData("000000000002 000000000001 0800")};
+  EXPECT_EQ(filterSet.match(ip.toRange()), 1);
+  EXPECT_EQ(filterSet.match(ip.toRange(), ip.size(), 2), 3);
+  EXPECT_EQ(filterSet.match(ip.toRange(), ip.size(), 4),
+            demux::PktFilterSet::npos);
+
+  ByteList arp{HexToRawData("000000000002 000000000003 0806")};
+  EXPECT_EQ(filterSet.match(arp.toRange()), 0);
+  EXPECT_EQ(filterSet.match(arp.toRange(), arp.size(), 1),
+            demux::PktFilterSet::npos);
+
+  filterSet.clear();
+  EXPECT_EQ(filterSet.size(), 0);
+  EXPECT_EQ(filterSet.match(ip.toRange()), demux::PktFilterSet::npos);
+}
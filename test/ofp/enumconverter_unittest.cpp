@@ -48,3 +48,82 @@ TEST(enumconverter, convert_case_senstive) {
   EXPECT_TRUE(converter.convert(B, &n));
   EXPECT_EQ("B", n.str());
 }
+
+TEST(enumconverter, convert_all) {
+  enum Kind { K0, K1, K2, K3, K4, K5, K6, K7, K8 };
+
+  const llvm::StringRef names[] = {"ZERO",  "ONE",  "TWO",   "THREE", "FOUR",
+                                   "FIVE",  "SIX",  "SEVEN", "EIGHT"};
+  ofp::yaml::EnumConverter<Kind> converter{names, "MAX"};
+
+  for (size_t i = 0; i < ArrayLength(names); ++i) {
+    Kind k = K0;
+    EXPECT_TRUE(converter.convert(names[i], &k));
+    EXPECT_EQ(i, k);
+  }
+
+  Kind k = K0;
+  EXPECT_FALSE(converter.convert("", &k));
+  EXPECT_FALSE(converter.convert("NINE", &k));
+  EXPECT_FALSE(converter.convert("ZERO ", &k));
+
+  // Integer values are still accepted.
+  EXPECT_TRUE(converter.convert("7", &k));
+  EXPECT_EQ(K7, k);
+}
+
+TEST(enumconverter, convert_sparse) {
+  enum Kind : UInt32 { A = 1, B = 0xFFFFFFF0, C = 0x10000, UNK = 0 };
+
+  const std::pair<Kind, llvm::StringRef> entries[] = {
+      {A, "A"}, {B, "B"}, {C, "C"}, {A, "A2"}};
+  ofp::yaml::EnumConverterSparse<Kind> converter{entries};
+
+  Kind k = UNK;
+  EXPECT_TRUE(converter.convert("B", &k));
+  EXPECT_EQ(B, k);
+  EXPECT_TRUE(converter.convert("A2", &k));
+  EXPECT_EQ(A, k);
+  EXPECT_FALSE(converter.convert("D", &k));
+
+  // The first name is used for a duplicate value.
+  llvm::StringRef n;
+  EXPECT_TRUE(converter.convert(A, &n));
+  EXPECT_EQ("A", n.str());
+  EXPECT_TRUE(converter.convert(C, &n));
+  EXPECT_EQ("C", n.str());
+  EXPECT_FALSE(converter.convert(UNK, &n));
+}
+
+TEST(enumconverter, hash_table_fallback) {
+  // There are too many keys for a perfect hash table, so `find` falls back
+  // to a linear search.
+  std::vector<UInt32> keys(hash::PerfectHashEmpty);
+  for (UInt32 i = 0; i < keys.size(); ++i) {
+    keys[i] = i * 3;
+  }
+  keys.push_back(15);
+
+  ofp::yaml::detail::EnumHashTable<UInt32> table{keys};
+  EXPECT_FALSE(table.hashed());
+  EXPECT_EQ(0, table.find(0));
+  EXPECT_EQ(5, table.find(15));
+  EXPECT_EQ(hash::PerfectHashEmpty - 1, table.find(3 * 65534));
+  EXPECT_EQ(hash::PerfectHashEmpty, table.find(1));
+
+  ofp::yaml::detail::EnumHashTable<UInt32> small{{7, 8, 9, 7}};
+  EXPECT_TRUE(small.hashed());
+  EXPECT_EQ(0, small.find(7));
+  EXPECT_EQ(2, small.find(9));
+}
+
+TEST(enumconverter, name_table) {
+  ofp::yaml::detail::EnumNameTable table{{"AB", "C", "", "AC", "AB", "DEF"}};
+  EXPECT_EQ(0, table.find("AB"));
+  EXPECT_EQ(1, table.find("C"));
+  EXPECT_EQ(2, table.find(""));
+  EXPECT_EQ(3, table.find("AC"));
+  EXPECT_EQ(5, table.find("DEF"));
+  EXPECT_EQ(hash::PerfectHashEmpty, table.find("AD"));
+  EXPECT_EQ(hash::PerfectHashEmpty, table.find("DEFG"));
+}
@@ -5,6 +5,8 @@
 
 #include "ofp/unittest.h"
 
+#include <random>
+
 using namespace ofp::yaml;
 
 TEST(getjson, testOne) {
@@ -213,3 +215,108 @@ TEST(getjson, testLine) {
   EXPECT_EQ(-1, lineNum);
   EXPECT_EQ(6, newlines);
 }
+
+// Split `input` using both the stream and in-memory versions of `getmsg`, and
+// check that the results are the same.
+template <class StreamFn, class RangeFn>
+static void testInMemory(const char *input, StreamFn streamFn,
+                         RangeFn rangeFn) {
+  std::istringstream iss{input};
+  llvm::StringRef range{input};
+  int streamNewlines = 0;
+  int rangeNewlines = 0;
+  int streamLineNum = 0;
+  int rangeLineNum = 0;
+  std::string streamMsg;
+  llvm::StringRef rangeMsg;
+
+  for (;;) {
+    bool streamResult =
+        streamFn(iss, streamMsg, streamLineNum, streamNewlines);
+    bool rangeResult = rangeFn(range, rangeMsg, rangeLineNum, rangeNewlines);
+    EXPECT_EQ(streamResult, rangeResult);
+    EXPECT_EQ(streamMsg, rangeMsg);
+    EXPECT_EQ(streamLineNum, rangeLineNum);
+    EXPECT_EQ(streamNewlines, rangeNewlines);
+    if (!streamResult || !rangeResult)
+      break;
+  }
+
+  EXPECT_TRUE(range.empty());
+}
+
+TEST(getjson, inMemory) {
+  using GetMsg = bool (*)(std::istream &, std::string &, int &, int &);
+  using GetRange = bool (*)(llvm::StringRef &, llvm::StringRef &, int &, int &);
+
+  const char *inputs[] = {
+      "",
+      " { a } ",
+      "ignore {a}\n{{b}}\n{{{c}}}\n []",
+      " {{ a }}\n{{ b }  ",
+      " } { a }",
+      " { \"}\n\" }, { \"\\\"}\" } ",
+      " { \"\\",
+      "  \ntest 1\n\ntest 2\r\ntest 3\n\n",
+  };
+
+  for (const char *input : inputs) {
+    testInMemory(input, static_cast<GetMsg>(getjson),
+                 static_cast<GetRange>(getjson));
+    testInMemory(input, static_cast<GetMsg>(ofp::yaml::getline),
+                 static_cast<GetRange>(ofp::yaml::getline));
+  }
+}
+
+TEST(getjson, inMemoryBlocks) {
+  using GetMsg = bool (*)(std::istream &, std::string &, int &, int &);
+  using GetRange = bool (*)(llvm::StringRef &, llvm::StringRef &, int &, int &);
+
+  // The in-memory getjson scans 64 bytes at a time. Compare it to the stream
+  // version on random input, where quotes, braces and newlines fall on both
+  // sides of block boundaries. Only some inputs contain backslashes, since a
+  // block with a backslash is scanned differently.
+  const char chars[] = "{}\"\nabcdefgh\\";
+  std::mt19937 rng{1234};
+
+  for (int i = 0; i < 400; ++i) {
+    size_t charCount = sizeof(chars) - (i % 2 ? 1 : 2);
+    std::string input;
+    size_t len = 1 + rng() % 1000;
+    for (size_t j = 0; j < len; ++j) {
+      input.push_back(chars[rng() % charCount]);
+    }
+    testInMemory(input.c_str(), static_cast<GetMsg>(getjson),
+                 static_cast<GetRange>(getjson));
+  }
+}
+
+TEST(getjson, inMemoryYaml) {
+  llvm::StringRef input{"   \n---\ntest: 1\r\n---\n---\ntest: 2\ntest: 3\n\n"};
+  int newlines = 0;
+  int lineNum = 0;
+  llvm::StringRef msg;
+
+  EXPECT_TRUE(getyaml(input, msg, lineNum, newlines));
+  EXPECT_EQ("test: 1\r\n", msg);
+  EXPECT_EQ(3, lineNum);
+  EXPECT_EQ(4, newlines);
+
+  EXPECT_TRUE(getyaml(input, msg, lineNum, newlines));
+  EXPECT_EQ("test: 2\ntest: 3\n\n", msg);
+  EXPECT_EQ(6, lineNum);
+  EXPECT_EQ(8, newlines);
+
+  EXPECT_FALSE(getyaml(input, msg, lineNum, newlines));
+  EXPECT_EQ("", msg);
+  EXPECT_EQ(-1, lineNum);
+  EXPECT_EQ(8, newlines);
+
+  // The last line doesn't need a line ending.
+  input = "...\ntest: 4";
+  newlines = 0;
+  EXPECT_TRUE(getyaml(input, msg, lineNum, newlines));
+  EXPECT_EQ("test: 4", msg);
+  EXPECT_EQ(2, lineNum);
+  EXPECT_EQ(2, newlines);
+}
@@ -51,3 +51,35 @@ TEST(hash, MurmurHash32) {
   std::array<UInt8, 8> t8 = {{1, 2, 3, 4, 5, 6, 7, 8}};
   EXPECT_EQ(0xd82dd722, ofp::hash::MurmurHash32(&t8));
 }
+
+TEST(hash, PerfectHash) {
+  std::vector<llvm::StringRef> names = {"IN_PORT", "ETH_DST", "ETH_SRC",
+                                        "ETH_TYPE", "VLAN_VID", "IP_PROTO"};
+  std::vector<UInt16> seeds;
+  std::vector<UInt16> slots;
+  ASSERT_TRUE(hash::PerfectHashBuild(names, 8, &seeds, &slots));
+  EXPECT_EQ(8, seeds.size());
+  EXPECT_EQ(8, slots.size());
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    EXPECT_EQ(i, hash::PerfectHashFind(names[i], seeds.data(), slots.data(),
+                                       slots.size()));
+  }
+
+  UInt16 idx = hash::PerfectHashFind(llvm::StringRef{"IN_PHY_PORT"},
+                                     seeds.data(), slots.data(), slots.size());
+  EXPECT_TRUE(idx == hash::PerfectHashEmpty || names[idx] != "IN_PHY_PORT");
+
+  std::vector<UInt32> values;
+  for (UInt32 i = 0; i < 100; ++i) {
+    values.push_back(i * 0x10000);
+  }
+  ASSERT_TRUE(hash::PerfectHashBuild(values, 128, &seeds, &slots));
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(i, hash::PerfectHashFind(values[i], seeds.data(), slots.data(),
+                                       slots.size()));
+  }
+
+  // Too many keys for the table.
+  EXPECT_FALSE(hash::PerfectHashBuild(values, 64, &seeds, &slots));
+}
@@ -0,0 +1,226 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/yaml/inputjson.h"
+
+#include "ofp/unittest.h"
+#include "ofp/yaml/encoder.h"
+
+using namespace ofp;
+using namespace yaml;
+
+OFP_BEGIN_IGNORE_PADDING
+
+struct TestInner {
+  std::string name;
+  std::vector<UInt32> values;
+};
+
+struct TestStruct {
+  int a = 0;
+  std::string b;
+  bool c = false;
+  std::vector<TestInner> d;
+  llvm::Optional<UInt16> e;
+};
+
+OFP_END_IGNORE_PADDING
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(TestInner)
+
+namespace llvm {
+namespace yaml {
+
+template <>
+struct MappingTraits<TestInner> {
+  static void mapping(llvm::yaml::IO &io, TestInner &item) {
+    io.mapRequired("name", item.name);
+    io.mapOptional("values", item.values);
+  }
+};
+
+template <>
+struct MappingTraits<TestStruct> {
+  static void mapping(llvm::yaml::IO &io, TestStruct &item) {
+    io.mapRequired("a", item.a);
+    io.mapRequired("b", item.b);
+    io.mapOptional("c", item.c);
+    io.mapOptional("d", item.d);
+    io.mapOptional("e", item.e);
+  }
+};
+
+}  // namespace yaml
+}  // namespace llvm
+
+static void diagHandler(const llvm::SMDiagnostic &diag, void *context) {
+  llvm::raw_string_ostream os{*reinterpret_cast<std::string *>(context)};
+  diag.print("", os, false);
+}
+
+// Read `input` with InputJson. Return the error message.
+static std::string readJson(llvm::StringRef input, TestStruct *result) {
+  std::string error;
+  InputJson jin{input, nullptr, diagHandler, &error};
+  EXPECT_TRUE(jin.valid());
+  jin >> *result;
+  EXPECT_EQ(error.empty(), !jin.error());
+  return error;
+}
+
+// Read `input` with llvm::yaml::Input. Return the error message.
+static std::string readYaml(llvm::StringRef input, TestStruct *result) {
+  std::string error;
+  llvm::yaml::Input yin{input, nullptr, diagHandler, &error};
+  yin >> *result;
+  EXPECT_EQ(error.empty(), !yin.error());
+  return error;
+}
+
+TEST(inputjson, valid) {
+  EXPECT_TRUE(InputJson{"{}"}.valid());
+  EXPECT_TRUE(InputJson{" \r\n\t{ } \n"}.valid());
+  EXPECT_TRUE(InputJson{R"({"a":[1,-2.5e+3,true,false,null,{}],"b":"é"})"}
+                  .valid());
+
+  EXPECT_FALSE(InputJson{""}.valid());
+  EXPECT_FALSE(InputJson{"[]"}.valid());
+  EXPECT_FALSE(InputJson{"a: 1"}.valid());
+  EXPECT_FALSE(InputJson{"{a: 1}"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": 0x10})"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": 01})"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": 1,})"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": 'b'})"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": "\x"})"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": "\u12"})"}.valid());
+  EXPECT_FALSE(InputJson{"{\"a\": \"\t\"}"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": 1} x)"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": 1)"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a" 1})"}.valid());
+  EXPECT_FALSE(InputJson{R"({"a": nul})"}.valid());
+}
+
+TEST(inputjson, read) {
+  const char *input =
+      R"({"e": 7, "d": [{"name": "x\"\\\/\b\f\n\r\tAé€"}, )"
+      R"({"values": [1, 2, 3], "name": "y"}], "b": "hello", "a": -5})";
+
+  TestStruct jresult;
+  EXPECT_EQ("", readJson(input, &jresult));
+  EXPECT_EQ(-5, jresult.a);
+  EXPECT_EQ("hello", jresult.b);
+  EXPECT_FALSE(jresult.c);
+  ASSERT_EQ(2, jresult.d.size());
+  EXPECT_EQ("x\"\\/\b\f\n\r\tA\xC3\xA9\xE2\x82\xAC", jresult.d[0].name);
+  EXPECT_EQ(0, jresult.d[0].values.size());
+  EXPECT_EQ("y", jresult.d[1].name);
+  EXPECT_EQ((std::vector<UInt32>{1, 2, 3}), jresult.d[1].values);
+  ASSERT_TRUE(jresult.e.hasValue());
+  EXPECT_EQ(7, *jresult.e);
+
+  TestStruct yresult;
+  EXPECT_EQ("", readYaml(input, &yresult));
+  EXPECT_EQ(yresult.d[0].name, jresult.d[0].name);
+}
+
+TEST(inputjson, null_sequence) {
+  TestStruct result;
+  EXPECT_EQ("", readJson(R"({"a": 1, "b": "", "d": null})", &result));
+  EXPECT_EQ(0, result.d.size());
+}
+
+TEST(inputjson, duplicate_key) {
+  TestStruct result;
+  EXPECT_EQ("", readJson(R"({"a": 1, "b": "", "a": 2})", &result));
+  EXPECT_EQ(2, result.a);
+}
+
+TEST(inputjson, errors) {
+  // InputJson reports the same diagnostics as llvm::yaml::Input.
+  const char *inputs[] = {
+      R"({"a": 1})",
+      R"({"a": 1, "b": "x", "z": 2})",
+      R"({"a": "one", "b": "x"})",
+      R"({"a": 1, "b": [1]})",
+      R"({"a": 1, "b": "x", "c": "maybe"})",
+      R"({"a": 1, "b": "x", "d": {}})",
+      R"({"a": 1, "b": "x", "d": [5]})",
+      R"({"a": 1, "b": "x", "d": [{"name": "y", "values": 1}]})",
+      R"({"a": 1, "b": "x", "e": 65536})",
+      "{\n  \"a\": 1,\n  \"b\": \"x\",\n  \"d\": [{\"values\": []}]\n}",
+  };
+
+  for (auto input : inputs) {
+    TestStruct jresult;
+    TestStruct yresult;
+    std::string error = readYaml(input, &yresult);
+    EXPECT_NE("", error);
+    EXPECT_EQ(error, readJson(input, &jresult));
+  }
+}
+
+TEST(inputjson, encoder) {
+  Encoder json{
+      R"({"type": "FEATURES_REQUEST", "version": 4, "xid": 9, "msg": {}})"};
+  EXPECT_EQ("", json.error());
+  Encoder yaml{"type: FEATURES_REQUEST\nversion: 4\nxid: 9\nmsg: {}"};
+  EXPECT_EQ("", yaml.error());
+  EXPECT_HEX("0405000800000009", json.data(), json.size());
+  EXPECT_HEX("0405000800000009", yaml.data(), yaml.size());
+
+  Encoder invalid{R"({"type": "FEATURES_REQUEST", "version": 4, "x": 1})"};
+  EXPECT_EQ(
+      "YAML:1:49: error: unknown key 'x'\n{\"type\": \"FEATURES_REQUEST\", "
+      "\"version\": 4, \"x\": 1}\n                                            "
+      "    ^\n",
+      invalid.error());
+}
+
+TEST(inputjson, reset) {
+  std::string error;
+  InputJson jin;
+  EXPECT_FALSE(jin.valid());
+
+  // An error in one input doesn't carry over to the next.
+  jin.reset(R"({"a": 1, "b": "x\ty", "z": 2})", diagHandler, &error);
+  TestStruct result1;
+  jin >> result1;
+  EXPECT_TRUE(jin.error());
+  EXPECT_NE("", error);
+
+  error.clear();
+  jin.reset(R"({"a": 2, "b": "x\ny", "d": [{"name": "né"}]})",
+            diagHandler, &error);
+  TestStruct result2;
+  jin >> result2;
+  EXPECT_FALSE(jin.error());
+  EXPECT_EQ("", error);
+  EXPECT_EQ(2, result2.a);
+  EXPECT_EQ("x\ny", result2.b);
+  ASSERT_EQ(1, result2.d.size());
+  EXPECT_EQ("n\xC3\xA9", result2.d[0].name);
+
+  jin.reset("a: 1");
+  EXPECT_FALSE(jin.valid());
+}
+
+TEST(inputjson, encoder_reuse) {
+  InputJson parser;
+  for (UInt32 xid = 1; xid <= 3; ++xid) {
+    std::string input = R"({"type": "FEATURES_REQUEST", "version": 4, )"
+                        R"("xid": )" +
+                        std::to_string(xid) + R"(, "msg": {}})";
+    Encoder encoder{&parser, input};
+    EXPECT_EQ("", encoder.error());
+    EXPECT_EQ(xid, encoder.xid());
+  }
+
+  // YAML input falls back to llvm::yaml::Input.
+  Encoder yaml{&parser, "type: FEATURES_REQUEST\nversion: 4\nxid: 9\nmsg: {}"};
+  EXPECT_EQ("", yaml.error());
+  EXPECT_HEX("0405000800000009", yaml.data(), yaml.size());
+
+  Encoder invalid{&parser,
+                  R"({"type": "FEATURES_REQUEST", "version": 4, "x": 1})"};
+  EXPECT_NE("", invalid.error());
+}
@@ -0,0 +1,284 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/yaml/jsonwriter.h"
+
+#include "ofp/unittest.h"
+#include "ofp/yaml/decoder.h"
+#include "ofp/yaml/encoder.h"
+#include "ofp/yaml/yfeaturesreply.h"
+#include "ofp/yaml/yflowmod.h"
+#include "ofp/yaml/yflowremoved.h"
+#include "ofp/yaml/ygroupmod.h"
+#include "ofp/yaml/ymetermod.h"
+#include "ofp/yaml/ymultipartreply.h"
+#include "ofp/yaml/ypacketin.h"
+#include "ofp/yaml/yportstatus.h"
+
+using namespace ofp;
+using namespace yaml;
+
+// Return the `msg` value of `message` as written by the generic OutputJson
+// path.
+template <class MsgType>
+static std::string genericJson(const Message &message) {
+  ofp::yaml::detail::YamlContext ctx{nullptr, message.version(), true};
+  std::string result;
+  llvm::raw_string_ostream os{result};
+  OutputJson out{os, &ctx};
+
+  MsgType &msg = RemoveConst_cast(*MsgType::cast(&message));
+  out.beginMapping();
+  out.mapRequired("msg", msg);
+  out.endMapping();
+
+  return os.str();
+}
+
+template <>
+std::string genericJson<MultipartReply>(const Message &message) {
+  ofp::yaml::detail::YamlContext ctx{nullptr, message.version(), true};
+  std::string result;
+  llvm::raw_string_ostream os{result};
+  OutputJson out{os, &ctx};
+
+  MultipartReply &msg = RemoveConst_cast(*MultipartReply::cast(&message));
+  out.beginMapping();
+  llvm::yaml::MappingTraits<MultipartReply>::decode(out, msg, msg.replyType(),
+                                                    "msg");
+  out.endMapping();
+
+  return os.str();
+}
+
+// Check that the Decoder writes the same `msg` value as the generic path.
+template <class MsgType>
+static void testSameJson(const char *input) {
+  Encoder encoder{input};
+  ASSERT_EQ("", encoder.error());
+
+  Message message{encoder.data(), encoder.size()};
+  message.normalize();
+  ASSERT_TRUE(MsgType::cast(&message) != nullptr);
+
+  Decoder decoder{&message, true, true};
+  ASSERT_EQ("", decoder.error());
+
+  // The `msg` attribute is last.
+  std::string expected = genericJson<MsgType>(message);
+  llvm::StringRef actual = decoder.result();
+  size_t pos = actual.find(",\"msg\":");
+  ASSERT_NE(llvm::StringRef::npos, pos);
+  EXPECT_EQ(expected, "{" + actual.substr(pos + 1).str());
+}
+
+TEST(jsonwriter, packetin) {
+  testSameJson<PacketIn>(R"""(
+      version: 4
+      type: PACKET_IN
+      xid: 0x11111111
+      msg:
+        buffer_id: 0x22222222
+        total_len: 0x3333
+        in_port: 0x44444444
+        in_phy_port: 0x55555555
+        metadata: 0x6666666666666666
+        reason: APPLY_ACTION
+        table_id: 0x88
+        cookie: 0x9999999999999999
+        match:
+          - field: ETH_TYPE
+            value: 0x0800
+        data: 0102030405060708090A0B0C080045000014000000004006000001020304050607
+      )""");
+}
+
+TEST(jsonwriter, flowremoved) {
+  testSameJson<FlowRemoved>(R"""(
+      version: 4
+      type: FLOW_REMOVED
+      xid: 0x11111111
+      msg:
+        cookie: 0x2222222222222222
+        priority: 0x3333
+        reason: 0x44
+        table_id: 0x55
+        duration: 1717986918.x77777777
+        idle_timeout: 0x8888
+        hard_timeout: 0x9999
+        packet_count: 0xAAAAAAAAAAAAAAAA
+        byte_count: 0xBBBBBBBBBBBBBBBB
+        match:
+          - field: IN_PORT
+            value: 0x12345678
+      )""");
+}
+
+TEST(jsonwriter, portstatus) {
+  testSameJson<PortStatus>(R"""(
+      version: 4
+      type: PORT_STATUS
+      xid: 0x11111111
+      msg:
+        reason: 0x22
+        port_no: 0x33333333
+        hw_addr: 'aabbccddeeff'
+        name: "Port \"1\"\t"
+        config: [ 0x44444444 ]
+        state: [ 0x55555555 ]
+        curr: [ '0x66666666' ]
+        advertised: [ '0x77777777' ]
+        supported: [ '0x88888888' ]
+        peer: [ '0x99999999' ]
+        curr_speed: 0xAAAAAAAA
+        max_speed: 0xBBBBBBBB
+      )""");
+}
+
+TEST(jsonwriter, portstats) {
+  testSameJson<MultipartReply>(R"""(
+      version: 5
+      type: PORT_STATS_REPLY
+      xid: 0x11111111
+      flags: [ MORE ]
+      msg:
+        - port_no: 1
+          duration: 2.000000003
+          rx_packets: 4
+          tx_packets: 5
+          rx_bytes: 6
+          tx_bytes: 7
+          rx_dropped: 8
+          tx_dropped: 9
+          rx_errors: 10
+          tx_errors: 11
+          rx_frame_err: 12
+          rx_over_err: 13
+          rx_crc_err: 14
+          collisions: 15
+          optical:
+            flags: 16
+            tx_freq_lmda: 17
+            tx_offset: 18
+            tx_grid_span: 19
+            rx_freq_lmda: 20
+            rx_offset: 21
+            rx_grid_span: 22
+            tx_pwr: 23
+            rx_pwr: 24
+            bias_current: 25
+            temperature: 26
+          properties: []
+        - port_no: 2
+          duration: 3.000000004
+          rx_packets: 5
+          tx_packets: 6
+          rx_bytes: 7
+          tx_bytes: 8
+          rx_dropped: 9
+          tx_dropped: 10
+          rx_errors: 11
+          tx_errors: 12
+          rx_frame_err: 13
+          rx_over_err: 14
+          rx_crc_err: 15
+          collisions: 16
+          properties: []
+      )""");
+}
+
+TEST(jsonwriter, queuestats) {
+  testSameJson<MultipartReply>(R"""(
+      version: 4
+      type: QUEUE_STATS_REPLY
+      xid: 0x11111111
+      msg:
+        - port_no: 1
+          queue_id: 2
+          tx_packets: 3
+          tx_bytes: 4
+          tx_errors: 5
+          duration: 6.000000007
+        - port_no: CONTROLLER
+          queue_id: 3
+          tx_packets: 4
+          tx_bytes: 5
+          tx_errors: 6
+          duration: 7.000000008
+      )""");
+}
+
+TEST(jsonwriter, tablestats) {
+  testSameJson<MultipartReply>(R"""(
+      version: 4
+      type: TABLE_STATS_REPLY
+      xid: 0x11111111
+      msg:
+        - table_id: 1
+          active_count: 2
+          lookup_count: 3
+          matched_count: 4
+        - table_id: 0xFE
+          active_count: 5
+          lookup_count: 6
+          matched_count: 7
+      )""");
+}
+
+TEST(jsonwriter, flowdesc) {
+  testSameJson<MultipartReply>(R"""(
+      version: 4
+      type: FLOW_DESC_REPLY
+      xid: 0x11111111
+      msg:
+        - table_id: 1
+          duration: 2.000000003
+          priority: 4
+          idle_timeout: 5
+          hard_timeout: 6
+          flags: [ SEND_FLOW_REM ]
+          cookie: 7
+          packet_count: 8
+          byte_count: 9
+          match:
+            - field: IN_PORT
+              value: 10
+          instructions:
+            - instruction: APPLY_ACTIONS
+              actions:
+                - action: OUTPUT
+                  port_no: 11
+                  max_len: 12
+      )""");
+}
+
+TEST(jsonwriter, portdesc) {
+  testSameJson<MultipartReply>(R"""(
+      version: 4
+      type: PORT_DESC_REPLY
+      xid: 0x11111111
+      msg:
+        - port_no: 1
+          hw_addr: 'aabbccddeeff'
+          name: 'Port 1'
+          config: [ PORT_DOWN ]
+          state: [ LINK_DOWN ]
+          curr: [ 10MB_HD ]
+          advertised: [ ]
+          supported: [ ]
+          peer: [ ]
+          curr_speed: 2
+          max_speed: 3
+        - port_no: 4
+          hw_addr: '010203040506'
+          name: 'Port 4'
+          config: [ ]
+          state: [ ]
+          curr: [ ]
+          advertised: [ ]
+          supported: [ ]
+          peer: [ ]
+          curr_speed: 5
+          max_speed: 6
+      )""");
+}
@@ -31,3 +31,22 @@ TEST(oxmfulltype, x_experimenter_01) {
 
   EXPECT_EQ(OXMInternalID::X_EXPERIMENTER_01, type.internalID());
 }
+
+TEST(oxmfulltype, parse_all) {
+  for (llvm::StringRef name : OXMFullType::listAll()) {
+    OXMFullType type;
+    ASSERT_TRUE(type.parse(name));
+
+    const OXMTypeInfo *info = type.lookupInfo();
+    ASSERT_TRUE(info != nullptr);
+    EXPECT_EQ(name, info->name);
+
+    // Look up the same field by type.
+    OXMFullType other{type.type(), type.experimenter()};
+    EXPECT_EQ(type.internalID(), other.internalID());
+  }
+
+  OXMFullType type;
+  EXPECT_FALSE(type.parse("IN_PORTX"));
+  EXPECT_FALSE(type.parse(""));
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/dedupcache.h"
+
+#include "ofp/unittest.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+// UDP 10.0.0.1:4500 -> 10.100.0.254:4567 on VLAN 100.
+const char *const kUdpFrame =
+    "0E00000000010AC2BB024296810000640800450005DC0518200040113AA70A0000010A6400"
+    "FE11941197001C00000000000000000000000000000000000000000000";
+
+// Same flow with a different IP TTL and ID.
+const char *const kUdpFrameTtl =
+    "0E00000000010AC2BB024296810000640800450005DC0519200030113AA70A0000010A6400"
+    "FE11941197001C00000000000000000000000000000000000000000000";
+
+// Same addresses with a different UDP destination port.
+const char *const kUdpFramePort =
+    "0E00000000010AC2BB024296810000640800450005DC0518200040113AA70A0000010A6400"
+    "FE11941198001C00000000000000000000000000000000000000000000";
+
+TEST(dedupcache, key) {
+  ByteList frame{HexToRawData(kUdpFrame)};
+  ByteList frameTtl{HexToRawData(kUdpFrameTtl)};
+  ByteList framePort{HexToRawData(kUdpFramePort)};
+  DatapathID dpid{"00:00:00:00:00:00:00:01"};
+
+  std::string key1, key2;
+  DedupCache::makeKey(dpid, PortNumber{1}, frame, &key1);
+  DedupCache::makeKey(dpid, PortNumber{1}, frameTtl, &key2);
+  EXPECT_EQ(key1, key2);
+
+  DedupCache::makeKey(dpid, PortNumber{1}, framePort, &key2);
+  EXPECT_NE(key1, key2);
+
+  DedupCache::makeKey(dpid, PortNumber{2}, frame, &key2);
+  EXPECT_NE(key1, key2);
+
+  DedupCache::makeKey(DatapathID{}, PortNumber{1}, frame, &key2);
+  EXPECT_NE(key1, key2);
+}
+
+TEST(dedupcache, allow) {
+  ByteList frame{HexToRawData(kUdpFrame)};
+  ByteList framePort{HexToRawData(kUdpFramePort)};
+  DatapathID dpid{"00:00:00:00:00:00:00:01"};
+
+  RateLimiter limiter{false};
+  ASSERT_TRUE(limiter.parse("1/1"));
+
+  DedupCache dedup;
+  EXPECT_FALSE(dedup.enabled());
+  dedup.setLimiter(limiter);
+  EXPECT_TRUE(dedup.enabled());
+
+  Timestamp now = Timestamp::now();
+  UInt32 suppressed = 99;
+
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame, now, &suppressed));
+  EXPECT_EQ(suppressed, 0);
+
+  // Duplicates within the window are suppressed; other flows are not.
+  EXPECT_FALSE(dedup.allow(dpid, PortNumber{1}, frame,
+                           now + TimeInterval{0.25}, &suppressed));
+  EXPECT_FALSE(dedup.allow(dpid, PortNumber{1}, frame,
+                           now + TimeInterval{0.5}, &suppressed));
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, framePort,
+                          now + TimeInterval{0.5}, &suppressed));
+  EXPECT_EQ(suppressed, 0);
+  EXPECT_EQ(dedup.size(), 2);
+
+  // The next packet after the window reports the suppressed count.
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame,
+                          now + TimeInterval{1.5}, &suppressed));
+  EXPECT_EQ(suppressed, 2);
+  dedup.escalated();
+
+  EXPECT_FALSE(dedup.allow(dpid, PortNumber{1}, frame,
+                           now + TimeInterval{2.0}, &suppressed));
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame,
+                          now + TimeInterval{2.6}, &suppressed));
+  EXPECT_EQ(suppressed, 1);
+  dedup.escalated();
+}
+
+TEST(dedupcache, not_escalated) {
+  ByteList frame{HexToRawData(kUdpFrame)};
+  DatapathID dpid{"00:00:00:00:00:00:00:01"};
+
+  DedupCache dedup;
+  dedup.setLimiter(RateLimiter{1, TimeInterval{1, 0}});
+
+  Timestamp now = Timestamp::now();
+  UInt32 suppressed = 99;
+
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame, now, &suppressed));
+  EXPECT_EQ(suppressed, 0);
+  dedup.escalated();
+
+  EXPECT_FALSE(dedup.allow(dpid, PortNumber{1}, frame,
+                           now + TimeInterval{0.5}, &suppressed));
+
+  // The packet is allowed, but not escalated. The count is kept.
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame,
+                          now + TimeInterval{1.5}, &suppressed));
+  EXPECT_EQ(suppressed, 1);
+
+  EXPECT_FALSE(dedup.allow(dpid, PortNumber{1}, frame,
+                           now + TimeInterval{2.0}, &suppressed));
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame,
+                          now + TimeInterval{3.0}, &suppressed));
+  EXPECT_EQ(suppressed, 2);
+  dedup.escalated();
+
+  EXPECT_TRUE(dedup.allow(dpid, PortNumber{1}, frame,
+                          now + TimeInterval{4.5}, &suppressed));
+  EXPECT_EQ(suppressed, 0);
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/filteractionarpreply.h"
+
+#include "ofp/message.h"
+#include "ofp/mockchannel.h"
+#include "ofp/packetin.h"
+#include "ofp/unittest.h"
+#include "ofp/yaml/decoder.h"
+#include "ofp/yaml/encoder.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+static Message encodeMessage(llvm::StringRef yaml) {
+  ofp::yaml::Encoder encoder{yaml};
+  assert(encoder.error() == "");
+  return Message{encoder.data(), encoder.size()};
+}
+
+static std::string decodeMessage(ByteRange data) {
+  Message message{data.data(), data.size()};
+  message.normalize();
+
+  ofp::yaml::Decoder decoder{&message, false, true};
+  return decoder.result();
+}
+
+// ARP request on VLAN 100: who-has 10.100.0.254 tell 10.0.0.1.
+const char *const kArpRequest = R"""(
+    type:            PACKET_IN
+    xid:             0x00000000
+    version:         0x04
+    msg:             
+      buffer_id:       NO_BUFFER
+      total_len:       0x0040
+      in_port:         0x00000001
+      in_phy_port:     0x00000001
+      metadata:        0x0000000000000000
+      reason:          APPLY_ACTION
+      table_id:        0x06
+      cookie:          0x00000000FFFFFFFF
+      match:           
+        - field:           IN_PORT
+          value:           0x00000001
+      data:            FFFFFFFFFFFF0E000000000181000064080600010800060400010E00000000010A0000010000000000000A6400FE000000000000000000000000000000000000
+  )""";
+
+TEST(rpcfilteractionarpreply, test_arp_request) {
+  Message message = encodeMessage(kArpRequest);
+  ASSERT_TRUE(message.type() == OFPT_PACKET_IN);
+  message.normalize();
+
+  MockChannel outputChannel{OFP_VERSION_4};
+  message.setSource(&outputChannel);
+
+  const PacketIn *packetIn = PacketIn::cast(&message);
+  ASSERT_TRUE(packetIn != nullptr);
+  ByteRange enetFrame = packetIn->enetFrame();
+  PortNumber inPort = packetIn->inPort();
+  UInt64 metadata = packetIn->metadata();
+
+  ArpTable arpTable;
+  arpTable.set(IPv4Address{"10.100.0.254"}, MacAddress{"0a:c2:bb:02:42:96"});
+
+  FilterActionArpReply action{&arpTable};
+  bool result = action.apply(enetFrame, inPort, metadata, &message);
+  EXPECT_TRUE(result);
+
+  EXPECT_NE(message.msgFlags() & OFP_REPLIED, 0);
+
+  std::string output =
+      decodeMessage({outputChannel.data(), outputChannel.size()});
+  EXPECT_EQ(
+      output,
+      "---\ntype:            PACKET_OUT\nxid:             0x00000001\nversion: "
+      "        0x04\nmsg:             \n  buffer_id:       NO_BUFFER\n  "
+      "in_port:         CONTROLLER\n  actions:         \n    - action:         "
+      " OUTPUT\n      port_no:         0x00000001\n      max_len:         "
+      "0x0000\n  data:            "
+      "0E00000000010AC2BB02429681000064080600010800060400020AC2BB0242960A6400FE"
+      "0E00000000010A0000010000000000000000000000000000\n  _pkt:            \n"
+      "    - field:           ETH_DST\n      value:           "
+      "'0e:00:00:00:00:01'\n    - field:           ETH_SRC\n      value:      "
+      "     '0a:c2:bb:02:42:96'\n    - field:           VLAN_VID\n      "
+      "value:           0x1064\n    - field:           ETH_TYPE\n      value: "
+      "          0x0806\n    - field:           ARP_OP\n      value:         "
+      "  0x0002\n    - field:           ARP_SPA\n      value:           "
+      "10.100.0.254\n    - field:           ARP_TPA\n      value:           "
+      "10.0.0.1\n    - field:           ARP_SHA\n      value:           "
+      "'0a:c2:bb:02:42:96'\n    - field:           ARP_THA\n      value:     "
+      "      '0e:00:00:00:00:01'\n...\n");
+}
+
+TEST(rpcfilteractionarpreply, test_arp_unknown) {
+  Message message = encodeMessage(kArpRequest);
+  message.normalize();
+
+  MockChannel outputChannel{OFP_VERSION_4};
+  message.setSource(&outputChannel);
+
+  const PacketIn *packetIn = PacketIn::cast(&message);
+  ASSERT_TRUE(packetIn != nullptr);
+
+  ArpTable arpTable;
+  arpTable.set(IPv4Address{"10.100.0.253"}, MacAddress{"0a:c2:bb:02:42:96"});
+
+  FilterActionArpReply action{&arpTable};
+  bool result = action.apply(packetIn->enetFrame(), packetIn->inPort(),
+                             packetIn->metadata(), &message);
+  EXPECT_FALSE(result);
+
+  EXPECT_EQ(message.msgFlags() & OFP_REPLIED, 0);
+  EXPECT_EQ(outputChannel.size(), 0);
+
+  // Without an ARP table, the action never matches.
+  FilterActionArpReply unbound;
+  EXPECT_FALSE(unbound.apply(packetIn->enetFrame(), packetIn->inPort(),
+                             packetIn->metadata(), &message));
+}
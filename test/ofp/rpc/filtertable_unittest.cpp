@@ -5,6 +5,7 @@
 
 #include "ofp/message.h"
 #include "ofp/mockchannel.h"
+#include "ofp/rpc/filteractionarpreply.h"
 #include "ofp/rpc/filteractiongenericreply.h"
 #include "ofp/unittest.h"
 #include "ofp/yaml/decoder.h"
@@ -97,3 +98,263 @@ TEST(filtertable, test) {
       "ICMPV4_CODE\n      value:           0x00\n    - field:           "
       "X_PKT_POS\n      value:           0x002A\n...\n");
 }
+
+TEST(filtertable, first_match) {
+  std::vector<FilterTableEntry> params;
+  params.emplace_back();
+  params.back().setFilter("arp");
+  params.emplace_back();
+  params.back().setFilter("vlan and ip");
+  params.back().setAction(MakeUniquePtr<FilterActionGenericReply>());
+  params.emplace_back();
+  params.back().setFilter("vlan and ip");
+  params.emplace_back();
+  params.back().setFilter("ip");
+
+  FilterTable filters;
+  filters.setFilters(std::move(params));
+  EXPECT_EQ(filters.size(), 4);
+
+  // UDP packet: The GENERIC_REPLY action doesn't apply, so the next entry
+  // that matches is used.
+  const char *input = R"""(
+    type:            PACKET_IN
+    version:         0x04
+    msg:             
+      buffer_id:       NO_BUFFER
+      total_len:       0x05EE
+      in_port:         0x00000001
+      metadata:        0x0000000000000000
+      reason:          APPLY_ACTION
+      table_id:        0x06
+      cookie:          0x00000000FFFFFFFF
+      match:           
+        - field:           IN_PORT
+          value:           0x00000001
+      data:            0E00000000010AC2BB024296810000640800450005DC0518200040113AA70A0000010A6400FE080014572C2400059DA8FC590000000046D5060000000000101112131415161718191A1B1C1D1E1F202122232425
+  )""";
+
+  Message message = encodeMessage(input);
+  message.normalize();
+
+  MockChannel outputChannel{OFP_VERSION_4};
+  message.setSource(&outputChannel);
+
+  bool escalate = true;
+  EXPECT_TRUE(filters.apply(&message, &escalate));
+  EXPECT_FALSE(escalate);
+  EXPECT_EQ(outputChannel.size(), 0);
+
+  const auto &entries = filters.entries();
+  EXPECT_EQ(entries[0].hits(), 0);
+  EXPECT_EQ(entries[1].hits(), 0);
+  EXPECT_EQ(entries[2].hits(), 1);
+  EXPECT_EQ(entries[3].hits(), 0);
+}
+
+TEST(filtertable, arp_reply) {
+  std::vector<FilterTableEntry> params;
+  params.emplace_back();
+  params.back().setFilter("vlan and arp");
+  params.back().setAction(MakeUniquePtr<FilterActionArpReply>());
+
+  FilterTable filters;
+  filters.setFilters(std::move(params));
+
+  const char *input = R"""(
+    type:            PACKET_IN
+    version:         0x04
+    msg:             
+      buffer_id:       NO_BUFFER
+      total_len:       0x0040
+      in_port:         0x00000001
+      metadata:        0x0000000000000000
+      reason:          APPLY_ACTION
+      table_id:        0x06
+      cookie:          0x00000000FFFFFFFF
+      match:           
+        - field:           IN_PORT
+          value:           0x00000001
+      data:            FFFFFFFFFFFF0E000000000181000064080600010800060400010E00000000010A0000010000000000000A6400FE000000000000000000000000000000000000
+  )""";
+
+  Message message = encodeMessage(input);
+  message.normalize();
+
+  MockChannel outputChannel{OFP_VERSION_4};
+  message.setSource(&outputChannel);
+
+  // The ARP table is empty, so the request is not answered.
+  bool escalate = true;
+  EXPECT_FALSE(filters.apply(&message, &escalate));
+  EXPECT_EQ(outputChannel.size(), 0);
+
+  filters.arpTable().set(IPv4Address{"10.100.0.254"},
+                         MacAddress{"0a:c2:bb:02:42:96"});
+
+  EXPECT_TRUE(filters.apply(&message, &escalate));
+  EXPECT_FALSE(escalate);
+  EXPECT_NE(message.msgFlags() & OFP_REPLIED, 0);
+  EXPECT_GT(outputChannel.size(), 0);
+  EXPECT_EQ(filters.entries()[0].hits(), 1);
+}
+
+TEST(filtertable, dedup) {
+  std::vector<FilterTableEntry> params;
+  params.emplace_back();
+  params.back().setFilter("vlan and ip");
+  params.back().setEscalate(RateLimiter{true});
+  params.back().setDedup(RateLimiter{1, TimeInterval{10, 0}});
+
+  FilterTable filters;
+  filters.setFilters(std::move(params));
+
+  const char *input = R"""(
+    type:            PACKET_IN
+    version:         0x04
+    msg:             
+      buffer_id:       NO_BUFFER
+      total_len:       0x05EE
+      in_port:         0x00000001
+      metadata:        0x0000000000000000
+      reason:          APPLY_ACTION
+      table_id:        0x06
+      cookie:          0x00000000FFFFFFFF
+      match:           
+        - field:           IN_PORT
+          value:           0x00000001
+      data:            0E00000000010AC2BB024296810000640800450005DC0518200040113AA70A0000010A6400FE080014572C2400059DA8FC590000000046D5060000000000101112131415161718191A1B1C1D1E1F202122232425
+  )""";
+
+  Message message = encodeMessage(input);
+  message.normalize();
+
+  Timestamp now = Timestamp::now();
+  std::vector<bool> actual;
+  double events[] = {0.0, 1.0, 2.0, 12.0};
+  for (auto ts : events) {
+    bool escalate = false;
+    message.setTime(now + TimeInterval{ts});
+    EXPECT_TRUE(filters.apply(&message, &escalate));
+    actual.push_back(escalate);
+  }
+
+  std::vector<bool> expected = {true, false, false, true};
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(message.duplicates(), 2);
+  EXPECT_EQ(filters.entries()[0].hits(), 4);
+}
+
+TEST(filtertable, dedup_limit) {
+  std::vector<FilterTableEntry> params;
+  params.emplace_back();
+  params.back().setFilter("vlan and ip");
+  params.back().setEscalate(RateLimiter{true});
+  params.back().setDedup(RateLimiter{1, TimeInterval{1, 0}});
+  params.back().setLimit(0.1, 1, false);
+
+  FilterTable filters;
+  filters.setFilters(std::move(params));
+
+  const char *input = R"""(
+    type:            PACKET_IN
+    version:         0x04
+    msg:             
+      buffer_id:       NO_BUFFER
+      total_len:       0x05EE
+      in_port:         0x00000001
+      metadata:        0x0000000000000000
+      reason:          APPLY_ACTION
+      table_id:        0x06
+      cookie:          0x00000000FFFFFFFF
+      match:           
+        - field:           IN_PORT
+          value:           0x00000001
+      data:            0E00000000010AC2BB024296810000640800450005DC0518200040113AA70A0000010A6400FE080014572C2400059DA8FC590000000046D5060000000000101112131415161718191A1B1C1D1E1F202122232425
+  )""";
+
+  Message message = encodeMessage(input);
+  message.normalize();
+
+  Timestamp now = Timestamp::now();
+  std::vector<bool> actual;
+  std::vector<UInt32> duplicates;
+
+  // At 0.5, a duplicate is suppressed. At 1.5, the dedup window allows the
+  // packet, but the rate limit denies it; the suppressed count must be kept
+  // for the packet escalated at 11.0.
+  double events[] = {0.0, 0.5, 1.5, 11.0};
+  for (auto ts : events) {
+    bool escalate = false;
+    message.setTime(now + TimeInterval{ts});
+    message.setDuplicates(99);
+    EXPECT_TRUE(filters.apply(&message, &escalate));
+    actual.push_back(escalate);
+    duplicates.push_back(escalate ? message.duplicates() : 99);
+  }
+
+  std::vector<bool> expected = {true, false, false, true};
+  EXPECT_EQ(actual, expected);
+  std::vector<UInt32> expectedDuplicates = {0, 99, 99, 1};
+  EXPECT_EQ(duplicates, expectedDuplicates);
+  EXPECT_EQ(filters.entries()[0].limit().buckets().begin()->second.dropped(),
+            1);
+}
+
+TEST(filtertable, limit_order) {
+  std::vector<FilterTableEntry> params;
+  params.emplace_back();
+  params.back().setFilter("vlan and ip");
+  params.back().setEscalate(RateLimiter{2, TimeInterval{10, 0}});
+  params.back().setLimit(0.01, 1, true);
+
+  FilterTable filters;
+  filters.setFilters(std::move(params));
+
+  const char *input = R"""(
+    type:            PACKET_IN
+    version:         0x04
+    msg:
+      buffer_id:       NO_BUFFER
+      total_len:       0x05EE
+      in_port:         %PORT%
+      metadata:        0x0000000000000000
+      reason:          APPLY_ACTION
+      table_id:        0x06
+      cookie:          0x00000000FFFFFFFF
+      match:
+        - field:           IN_PORT
+          value:           %PORT%
+      data:            0E00000000010AC2BB024296810000640800450005DC0518200040113AA70A0000010A6400FE080014572C2400059DA8FC590000000046D5060000000000101112131415161718191A1B1C1D1E1F202122232425
+  )""";
+
+  auto packetIn = [input](const char *port) {
+    std::string text = input;
+    size_t pos;
+    while ((pos = text.find("%PORT%")) != std::string::npos) {
+      text.replace(pos, 6, port);
+    }
+    Message message = encodeMessage(text);
+    message.normalize();
+    return message;
+  };
+
+  Message message1 = packetIn("1");
+  Message message2 = packetIn("2");
+
+  // The second packet on port 1 is denied by the per-port limit, so it must
+  // not use up the shared escalate limit of 2 per 10 seconds.
+  Timestamp now = Timestamp::now();
+  std::vector<bool> actual;
+  std::pair<Message *, double> events[] = {
+      {&message1, 0.0}, {&message1, 1.0}, {&message2, 2.0}, {&message2, 3.0}};
+  for (auto &event : events) {
+    bool escalate = false;
+    event.first->setTime(now + TimeInterval{event.second});
+    EXPECT_TRUE(filters.apply(event.first, &escalate));
+    actual.push_back(escalate);
+  }
+
+  std::vector<bool> expected = {true, false, true, false};
+  EXPECT_EQ(actual, expected);
+}
@@ -0,0 +1,199 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/messagetemplate.h"
+
+#include "ofp/unittest.h"
+#include "ofp/yaml/encoder.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+const char *const kFlowModTemplate = R"""(
+      type:            FLOW_MOD
+      version:         4
+      xid:             1
+      msg:
+        cookie:          $cookie
+        table_id:        0
+        command:         ADD
+        priority:        $priority
+        match:
+          - field:           IN_PORT
+            value:           $port
+          - field:           ETH_DST
+            value:           $mac
+          - field:           ETH_TYPE
+            value:           0x0800
+          - field:           IPV4_DST
+            value:           $ip
+        instructions:
+          - instruction:    APPLY_ACTIONS
+            actions:
+               - action: OUTPUT
+                 port_no: $port
+      )""";
+
+const char *const kFlowModExpected = R"""(
+      type:            FLOW_MOD
+      version:         4
+      xid:             0x12345678
+      msg:
+        cookie:          0xABCDEF0123456789
+        table_id:        0
+        command:         ADD
+        priority:        300
+        match:
+          - field:           IN_PORT
+            value:           7
+          - field:           ETH_DST
+            value:           01:02:03:04:05:06
+          - field:           ETH_TYPE
+            value:           0x0800
+          - field:           IPV4_DST
+            value:           10.1.2.3
+        instructions:
+          - instruction:    APPLY_ACTIONS
+            actions:
+               - action: OUTPUT
+                 port_no: 7
+      )""";
+
+TEST(messagetemplate, flowmod) {
+  MessageTemplate tmpl;
+  std::string error = tmpl.compile(kFlowModTemplate,
+                                   {{"cookie", "0"},
+                                    {"priority", "100"},
+                                    {"port", "1"},
+                                    {"mac", "00:00:00:00:00:01"},
+                                    {"ip", "192.168.1.1"}});
+  EXPECT_EQ("", error);
+  EXPECT_EQ(4, tmpl.version());
+  EXPECT_EQ(5, tmpl.slotCount());
+
+  ByteList msg;
+  error = tmpl.instantiate(
+      {"0xABCDEF0123456789", "300", "7", "01:02:03:04:05:06", "10.1.2.3"},
+      0x12345678, &msg);
+  EXPECT_EQ("", error);
+
+  yaml::Encoder expected{kFlowModExpected};
+  EXPECT_EQ("", expected.error());
+  EXPECT_EQ(RawDataToHex(expected.data(), expected.size()),
+            RawDataToHex(msg.data(), msg.size()));
+}
+
+TEST(messagetemplate, sample_values) {
+  MessageTemplate tmpl;
+  std::string error = tmpl.compile(kFlowModTemplate,
+                                   {{"cookie", "0xABCDEF0123456789"},
+                                    {"priority", "300"},
+                                    {"port", "7"},
+                                    {"mac", "01:02:03:04:05:06"},
+                                    {"ip", "10.1.2.3"}});
+  EXPECT_EQ("", error);
+
+  // Slots without values use their sample values.
+  ByteList msg;
+  error = tmpl.instantiate({}, 0x12345678, &msg);
+  EXPECT_EQ("", error);
+
+  yaml::Encoder expected{kFlowModExpected};
+  EXPECT_EQ(RawDataToHex(expected.data(), expected.size()),
+            RawDataToHex(msg.data(), msg.size()));
+}
+
+TEST(messagetemplate, invalid_template) {
+  MessageTemplate tmpl;
+
+  EXPECT_EQ("unknown slot '$priority'",
+            tmpl.compile(kFlowModTemplate, {{"cookie", "0"}}));
+
+  EXPECT_EQ("slot '$unused' is not used",
+            tmpl.compile("{type: HELLO, version: 4}", {{"unused", "1"}}));
+
+  EXPECT_EQ(
+      "slot '$data' must be a fixed size integer, MAC address or IP address "
+      "field",
+      tmpl.compile("{type: PACKET_OUT, version: 4, msg: {buffer_id: 0, "
+                   "in_port: 1, actions: [], data: $data}}",
+                   {{"data", "0102"}}));
+  EXPECT_EQ(0, tmpl.size());
+}
+
+TEST(messagetemplate, invalid_value) {
+  MessageTemplate tmpl;
+  std::string error =
+      tmpl.compile("{type: FLOW_MOD, version: 4, msg: {command: ADD, "
+                   "table_id: 0, priority: $priority}}",
+                   {{"priority", "100"}});
+  EXPECT_EQ("", error);
+
+  ByteList msg;
+  EXPECT_EQ("invalid value for slot '$priority': 65536",
+            tmpl.instantiate({"65536"}, 1, &msg));
+  EXPECT_EQ("invalid value for slot '$priority': abc",
+            tmpl.instantiate({"abc"}, 1, &msg));
+  EXPECT_EQ("too many slot values: expected 1",
+            tmpl.instantiate({"1", "2"}, 1, &msg));
+}
+
+TEST(messagetemplate, multibyte_value) {
+  MessageTemplate tmpl;
+  std::string error = tmpl.compile(
+      "{type: FLOW_MOD, version: 4, xid: 1, msg: {command: ADD, table_id: 0, "
+      "priority: $priority, idle_timeout: $idle, match: [{field: IN_PORT, "
+      "value: $port}]}}",
+      {{"priority", "1"}, {"idle", "2"}, {"port", "3"}});
+  EXPECT_EQ("", error);
+
+  // Each value uses every byte of its field.
+  ByteList msg;
+  error = tmpl.instantiate({"0xABCD", "65535", "0x12345678"}, 7, &msg);
+  EXPECT_EQ("", error);
+
+  yaml::Encoder expected{
+      "{type: FLOW_MOD, version: 4, xid: 7, msg: {command: ADD, table_id: 0, "
+      "priority: 0xABCD, idle_timeout: 65535, match: [{field: IN_PORT, "
+      "value: 0x12345678}]}}"};
+  EXPECT_EQ("", expected.error());
+  EXPECT_EQ(RawDataToHex(expected.data(), expected.size()),
+            RawDataToHex(msg.data(), msg.size()));
+
+  EXPECT_EQ("invalid value for slot '$idle': 65536",
+            tmpl.instantiate({"1", "65536"}, 7, &msg));
+}
+
+static std::string vlanFlowMod(int version, const std::string &vlan) {
+  return "{type: FLOW_MOD, version: " + std::to_string(version) +
+         ", xid: 1, msg: {command: ADD, table_id: 0, match: [{field: "
+         "VLAN_VID, value: " +
+         vlan + "}]}}";
+}
+
+TEST(messagetemplate, vlan_vid) {
+  // In OpenFlow 1.3, VLAN_VID is stored as is, including OFPVID_PRESENT.
+  MessageTemplate tmpl;
+  std::string error =
+      tmpl.compile(vlanFlowMod(4, "$vlan"),
+                   {{"vlan", "0x1001"}});
+  EXPECT_EQ("", error);
+
+  ByteList msg;
+  error = tmpl.instantiate({"0x1ABC"}, 1, &msg);
+  EXPECT_EQ("", error);
+
+  yaml::Encoder expected{vlanFlowMod(4, "0x1ABC")};
+  EXPECT_EQ("", expected.error());
+  EXPECT_EQ(RawDataToHex(expected.data(), expected.size()),
+            RawDataToHex(msg.data(), msg.size()));
+
+  // An OpenFlow 1.0 match clears OFPVID_PRESENT, so only the low byte of the
+  // value is stored as is. The slot can't be patched in place.
+  EXPECT_EQ(
+      "slot '$vlan' is not stored exactly as its value in the encoded message",
+      tmpl.compile(vlanFlowMod(1, "$vlan"),
+                   {{"vlan", "0x1001"}}));
+  EXPECT_EQ(0, tmpl.size());
+  EXPECT_EQ(0, tmpl.slotCount());
+}
@@ -0,0 +1,192 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/multipartassembler.h"
+
+#include "ofp/unittest.h"
+#include "ofp/yaml/decoder.h"
+#include "ofp/yaml/encoder.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+// Return JSON for a QUEUE_STATS_REPLY message with the given queue_ids.
+static std::string queueReply(UInt32 xid, bool more,
+                              const std::vector<int> &queueIds) {
+  std::string input = "type: QUEUE_STATS_REPLY\nversion: 4\nxid: " +
+                      std::to_string(xid) + "\nflags: [" +
+                      (more ? "MORE" : "") + "]\nmsg:\n";
+  for (int queueId : queueIds) {
+    input += "  - port_no: 1\n    queue_id: " + std::to_string(queueId) +
+             "\n    tx_packets: 0\n    tx_bytes: 0\n    tx_errors: 0\n"
+             "    duration: 0\n";
+  }
+  if (queueIds.empty()) {
+    input += "  []\n";
+  }
+
+  yaml::Encoder encoder{input};
+  EXPECT_EQ("", encoder.error());
+
+  Message message{encoder.data(), encoder.size()};
+  message.normalize();
+  yaml::Decoder decoder{&message, true};
+  EXPECT_EQ("", decoder.error());
+
+  return decoder.result().str();
+}
+
+// Return the queue_ids in a QUEUE_STATS_REPLY message, followed by '+' if the
+// MORE flag is set. The message must encode without error.
+static std::string queueIds(llvm::StringRef json) {
+  yaml::Encoder encoder{json};
+  EXPECT_EQ("", encoder.error());
+
+  const llvm::StringRef key = "\"queue_id\":";
+  std::string result;
+  for (size_t pos = json.find(key); pos != llvm::StringRef::npos;
+       pos = json.find(key, pos + 1)) {
+    if (!result.empty())
+      result += ',';
+    result += json.substr(pos + key.size()).take_while(isdigit);
+  }
+  if (json.contains("\"flags\":[\"MORE\"]"))
+    result += '+';
+
+  return result;
+}
+
+TEST(multipartassembler, merge) {
+  MultipartAssembler mp{100000, 1000_ms};
+  TimePoint now = TimeClock::now();
+  std::vector<std::string> events;
+
+  EXPECT_TRUE(mp.add(1, 7, true, queueReply(7, true, {1, 2}), now, &events));
+  EXPECT_TRUE(mp.add(1, 8, true, queueReply(8, true, {10}), now, &events));
+  EXPECT_TRUE(mp.add(1, 7, true, queueReply(7, true, {}), now, &events));
+  EXPECT_TRUE(mp.add(1, 7, true, queueReply(7, true, {3}), now, &events));
+  EXPECT_EQ(0, events.size());
+  EXPECT_EQ(2, mp.pending());
+
+  EXPECT_TRUE(mp.add(1, 7, false, queueReply(7, false, {4}), now, &events));
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ("1,2,3,4", queueIds(events[0]));
+  EXPECT_EQ(1, mp.pending());
+
+  // A reply that fits in one message is not changed.
+  EXPECT_FALSE(mp.add(1, 9, false, queueReply(9, false, {5}), now, &events));
+  EXPECT_FALSE(mp.add(2, 8, false, queueReply(8, false, {6}), now, &events));
+  EXPECT_EQ(1, events.size());
+
+  EXPECT_TRUE(mp.add(1, 8, false, queueReply(8, false, {}), now, &events));
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("10", queueIds(events[1]));
+  EXPECT_EQ(0, mp.pending());
+  EXPECT_EQ(0, mp.bufferedBytes());
+}
+
+TEST(multipartassembler, limit) {
+  std::string fragment = queueReply(7, true, {1});
+  MultipartAssembler mp{fragment.size() + 150, 1000_ms};
+  TimePoint now = TimeClock::now();
+  std::vector<std::string> events;
+
+  EXPECT_TRUE(mp.add(1, 7, true, fragment, now, &events));
+  EXPECT_TRUE(mp.add(1, 7, true, queueReply(7, true, {2}), now, &events));
+  EXPECT_EQ(0, events.size());
+
+  // The third fragment doesn't fit; flush a partial reply.
+  EXPECT_TRUE(mp.add(1, 7, true, queueReply(7, true, {3}), now, &events));
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ("1,2+", queueIds(events[0]));
+
+  EXPECT_TRUE(mp.add(1, 7, false, queueReply(7, false, {4}), now, &events));
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("3,4", queueIds(events[1]));
+  EXPECT_EQ(0, mp.bufferedBytes());
+
+  // A fragment bigger than the limit is not buffered.
+  MultipartAssembler small{fragment.size() - 1, 1000_ms};
+  EXPECT_FALSE(small.add(1, 7, true, fragment, now, &events));
+  EXPECT_EQ(0, small.pending());
+}
+
+TEST(multipartassembler, max_event_size) {
+  std::string first = queueReply(7, true, {1});
+  std::string last = queueReply(7, false, {2});
+  TimePoint now = TimeClock::now();
+  std::vector<std::string> events;
+
+  MultipartAssembler mp{100000, 1000_ms};
+  EXPECT_TRUE(mp.add(1, 7, true, first, now, &events));
+  EXPECT_TRUE(mp.add(1, 7, false, last, now, &events));
+  ASSERT_EQ(1, events.size());
+  const std::string merged = events[0];
+  EXPECT_EQ("1,2", queueIds(merged));
+
+  // A merged event of exactly the maximum size is sent.
+  events.clear();
+  MultipartAssembler exact{100000, 1000_ms, merged.size()};
+  EXPECT_TRUE(exact.add(1, 7, true, first, now, &events));
+  EXPECT_TRUE(exact.add(1, 7, false, last, now, &events));
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(merged, events[0]);
+
+  // One byte less, and the first fragment is flushed as a partial reply. The
+  // last fragment is not reassembled.
+  events.clear();
+  MultipartAssembler under{100000, 1000_ms, merged.size() - 1};
+  EXPECT_TRUE(under.add(1, 7, true, first, now, &events));
+  EXPECT_FALSE(under.add(1, 7, false, last, now, &events));
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ("1+", queueIds(events[0]));
+  EXPECT_LE(events[0].size(), merged.size() - 1);
+  EXPECT_EQ(0, under.pending());
+  EXPECT_EQ(0, under.bufferedBytes());
+
+  // A fragment bigger than the maximum event size is not buffered.
+  MultipartAssembler small{100000, 1000_ms, first.size() - 1};
+  EXPECT_FALSE(small.add(1, 7, true, first, now, &events));
+  EXPECT_EQ(0, small.pending());
+}
+
+TEST(multipartassembler, expire) {
+  MultipartAssembler mp{100000, 1000_ms};
+  TimePoint now = TimeClock::now();
+  std::vector<std::string> events;
+
+  EXPECT_TRUE(mp.add(1, 7, true, queueReply(7, true, {1}), now, &events));
+  EXPECT_TRUE(mp.add(2, 7, true, queueReply(7, true, {2}), now + 500_ms,
+                     &events));
+  EXPECT_TRUE(mp.add(3, 7, true, queueReply(7, true, {3}), now, &events));
+  EXPECT_TRUE(now + 1000_ms == mp.nextExpiry());
+
+  mp.expire(now + 999_ms, &events);
+  EXPECT_EQ(0, events.size());
+
+  mp.flush(3, &events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ("3+", queueIds(events[0]));
+
+  mp.expire(now + 1000_ms, &events);
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("1+", queueIds(events[1]));
+  EXPECT_EQ(1, mp.pending());
+  EXPECT_TRUE(now + 1500_ms == mp.nextExpiry());
+}
+
+TEST(multipartassembler, not_list) {
+  MultipartAssembler mp{100000, 1000_ms};
+  std::vector<std::string> events;
+
+  yaml::Encoder encoder{
+      "type: AGGREGATE_STATS_REPLY\nversion: 4\nflags: [MORE]\nmsg:\n"
+      "  packet_count: 1\n  byte_count: 2\n  flow_count: 3\n"};
+  EXPECT_EQ("", encoder.error());
+  Message message{encoder.data(), encoder.size()};
+  message.normalize();
+  yaml::Decoder decoder{&message, true};
+
+  EXPECT_FALSE(mp.add(1, 7, true, decoder.result(), TimeClock::now(), &events));
+  EXPECT_EQ(0, mp.pending());
+}
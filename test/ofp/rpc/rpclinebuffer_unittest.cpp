@@ -0,0 +1,111 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/rpclinebuffer.h"
+
+#include "ofp/unittest.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+// Read `input` into the buffer, at most `readSize` bytes at a time, and append
+// each complete line to `lines`. Return false if the buffer overflows.
+static bool feed(RpcLineBuffer &buf, llvm::StringRef input, size_t readSize,
+                 std::vector<std::string> *lines) {
+  while (!input.empty()) {
+    size_t size;
+    UInt8 *space = buf.prepare(&size);
+    EXPECT_LT(0, size);
+
+    size = std::min({size, readSize, input.size()});
+    std::memcpy(space, input.data(), size);
+    input = input.drop_front(size);
+    buf.received(size);
+
+    llvm::StringRef line;
+    while (buf.nextLine(&line)) {
+      lines->push_back(line.str());
+    }
+
+    if (buf.overflow())
+      return false;
+  }
+
+  return true;
+}
+
+TEST(rpclinebuffer, splitAcrossReads) {
+  RpcLineBuffer buf{100};
+  std::vector<std::string> lines;
+
+  EXPECT_TRUE(feed(buf, "abc", 100, &lines));
+  EXPECT_TRUE(lines.empty());
+  EXPECT_EQ(3, buf.pending());
+
+  EXPECT_TRUE(feed(buf, "def\ngh", 100, &lines));
+  EXPECT_EQ(std::vector<std::string>({"abcdef"}), lines);
+  EXPECT_EQ(2, buf.pending());
+
+  EXPECT_TRUE(feed(buf, "i\n", 100, &lines));
+  EXPECT_EQ(std::vector<std::string>({"abcdef", "ghi"}), lines);
+  EXPECT_EQ(0, buf.pending());
+}
+
+TEST(rpclinebuffer, severalInOneRead) {
+  RpcLineBuffer buf{100};
+  std::vector<std::string> lines;
+
+  EXPECT_TRUE(feed(buf, "a\nbb\n\nccc\nd", 100, &lines));
+  EXPECT_EQ(std::vector<std::string>({"a", "bb", "", "ccc"}), lines);
+  EXPECT_EQ(1, buf.pending());
+}
+
+TEST(rpclinebuffer, delimiter) {
+  RpcLineBuffer buf{100, '\0'};
+  std::vector<std::string> lines;
+
+  EXPECT_TRUE(feed(buf, llvm::StringRef{"a\nb\0c\0", 6}, 100, &lines));
+  EXPECT_EQ(std::vector<std::string>({"a\nb", "c"}), lines);
+}
+
+TEST(rpclinebuffer, compact) {
+  // A partial line is moved to the front when the buffer is full; the buffer
+  // doesn't need to grow.
+  RpcLineBuffer buf{100, '\n', 16};
+  std::vector<std::string> lines;
+
+  EXPECT_TRUE(feed(buf, "0123456789\n01234", 100, &lines));
+  EXPECT_EQ(16, buf.capacity());
+  EXPECT_EQ(5, buf.pending());
+
+  EXPECT_TRUE(feed(buf, "56789\nabcdef\n", 100, &lines));
+  EXPECT_EQ(16, buf.capacity());
+  EXPECT_EQ(std::vector<std::string>({"0123456789", "0123456789", "abcdef"}),
+            lines);
+  EXPECT_EQ(0, buf.pending());
+}
+
+TEST(rpclinebuffer, largerThanBuffer) {
+  RpcLineBuffer buf{1000, '\n', 16};
+  std::vector<std::string> lines;
+
+  std::string longLine(100, 'x');
+  EXPECT_TRUE(feed(buf, "a\n" + longLine + "\nb\n", 7, &lines));
+  EXPECT_EQ(std::vector<std::string>({"a", longLine, "b"}), lines);
+  EXPECT_LE(101, buf.capacity());
+  EXPECT_EQ(0, buf.pending());
+}
+
+TEST(rpclinebuffer, overflow) {
+  RpcLineBuffer buf{32, '\n', 16};
+  std::vector<std::string> lines;
+
+  // A line of exactly `maxLineSize` bytes is allowed.
+  std::string maxLine(32, 'x');
+  EXPECT_TRUE(feed(buf, maxLine + "\n", 100, &lines));
+  EXPECT_EQ(std::vector<std::string>({maxLine}), lines);
+
+  EXPECT_FALSE(feed(buf, maxLine + "y", 100, &lines));
+  EXPECT_EQ(33, buf.capacity());
+  EXPECT_EQ(33, buf.pending());
+}
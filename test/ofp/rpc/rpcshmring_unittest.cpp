@@ -0,0 +1,110 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/rpcshmring.h"
+
+#include "ofp/unittest.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+const size_t kRingSize = 16;
+
+static size_t write(RpcShmRing &ring, llvm::StringRef s) {
+  return ring.write(reinterpret_cast<const UInt8 *>(s.data()), s.size());
+}
+
+static std::string peek(const RpcShmRing &ring, size_t offset, size_t size) {
+  std::string result(size, '\0');
+  ring.peek(offset, reinterpret_cast<UInt8 *>(&result[0]), size);
+  return result;
+}
+
+TEST(rpcshmring, wrapAround) {
+  UInt8 data[kRingSize] = {};
+  std::atomic<UInt64> head{0};
+  std::atomic<UInt64> tail{0};
+  RpcShmRing ring{data, kRingSize, &head, &tail};
+
+  EXPECT_EQ(10, write(ring, "0123456789"));
+  EXPECT_EQ(10, ring.readable());
+  ring.consume(10);
+  EXPECT_EQ(0, ring.readable());
+  EXPECT_EQ(kRingSize, ring.writable());
+
+  // This write wraps around the end of the data area.
+  EXPECT_EQ(12, write(ring, "abcdefghijkl"));
+  EXPECT_EQ(22, head);
+  EXPECT_EQ(10, tail);
+  EXPECT_EQ(12, ring.readable());
+  EXPECT_EQ(0, std::memcmp(data, "ghijkl", 6));
+  EXPECT_EQ(0, std::memcmp(data + 10, "abcdef", 6));
+
+  EXPECT_EQ("abcdefghijkl", peek(ring, 0, 12));
+  EXPECT_EQ("efgh", peek(ring, 4, 4));
+
+  // A view that doesn't wrap is returned in place.
+  std::string buf;
+  llvm::StringRef view = ring.view(1, 4, &buf);
+  EXPECT_EQ("bcde", view);
+  EXPECT_EQ(reinterpret_cast<const char *>(data + 11), view.data());
+  EXPECT_TRUE(buf.empty());
+
+  // A view that wraps is copied.
+  view = ring.view(4, 6, &buf);
+  EXPECT_EQ("efghij", view);
+  EXPECT_EQ(buf.data(), view.data());
+
+  // A view that starts after the wrap is returned in place.
+  view = ring.view(6, 6, &buf);
+  EXPECT_EQ("ghijkl", view);
+  EXPECT_EQ(reinterpret_cast<const char *>(data), view.data());
+
+  ring.consume(12);
+  EXPECT_EQ(0, ring.readable());
+  EXPECT_EQ(kRingSize, ring.writable());
+}
+
+TEST(rpcshmring, full) {
+  UInt8 data[kRingSize] = {};
+  std::atomic<UInt64> head{0};
+  std::atomic<UInt64> tail{0};
+  RpcShmRing ring{data, kRingSize, &head, &tail};
+
+  // Only as much as fits is written.
+  EXPECT_EQ(kRingSize, write(ring, "0123456789abcdefXYZ"));
+  EXPECT_EQ(kRingSize, ring.readable());
+  EXPECT_EQ(0, ring.writable());
+  EXPECT_EQ(0, write(ring, "XYZ"));
+  EXPECT_EQ(kRingSize, head);
+
+  // Freeing space lets the rest be written, wrapping around.
+  ring.consume(3);
+  EXPECT_EQ(3, ring.writable());
+  EXPECT_EQ(3, write(ring, "XYZ!"));
+  EXPECT_EQ(0, ring.writable());
+  EXPECT_EQ("3456789abcdefXYZ", peek(ring, 0, kRingSize));
+
+  ring.consume(kRingSize);
+  EXPECT_EQ(0, ring.readable());
+  EXPECT_EQ(kRingSize, ring.writable());
+}
+
+TEST(rpcshmring, runningCounts) {
+  // `head` and `tail` are running counts; only their difference matters.
+  UInt8 data[kRingSize] = {};
+  std::atomic<UInt64> head{0xFFFFFFFFFFFFFFF8};
+  std::atomic<UInt64> tail{0xFFFFFFFFFFFFFFF8};
+  RpcShmRing ring{data, kRingSize, &head, &tail};
+
+  EXPECT_EQ(kRingSize, ring.writable());
+  EXPECT_EQ(12, write(ring, "abcdefghijkl"));
+  EXPECT_EQ(4, head);
+  EXPECT_EQ(12, ring.readable());
+  EXPECT_EQ(4, ring.writable());
+  EXPECT_EQ("abcdefghijkl", peek(ring, 0, 12));
+
+  ring.consume(12);
+  EXPECT_EQ(4, tail);
+  EXPECT_EQ(0, ring.readable());
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2017-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include "ofp/rpc/tokenbucket.h"
+
+#include "ofp/unittest.h"
+
+using namespace ofp;
+using namespace ofp::rpc;
+
+TEST(tokenbucket, test_2_per_sec_burst_3) {
+  TokenBucket bucket{2.0, 3};
+  Timestamp now = Timestamp::now();
+
+  std::vector<bool> actual;
+  double events[] = {0.0, 0.1, 0.2, 0.3, 0.4, 0.8, 0.9, 3.0, 3.0, 3.0, 3.0};
+  for (auto ts : events) {
+    actual.push_back(bucket.allow(now + TimeInterval{ts}));
+  }
+
+  std::vector<bool> expected = {true, true,  true, false, false, true,
+                                false, true, true, true,  false};
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(bucket.dropped(), 4);
+}
+
+TEST(tokenbucket, map) {
+  DatapathID dpid1{"00:00:00:00:00:00:00:01"};
+  DatapathID dpid2{"00:00:00:00:00:00:00:02"};
+  Timestamp now = Timestamp::now();
+
+  TokenBucketMap buckets;
+  EXPECT_FALSE(buckets.enabled());
+
+  // One bucket per datapath.
+  buckets.setLimit(1.0, 1, false);
+  EXPECT_TRUE(buckets.enabled());
+  EXPECT_TRUE(buckets.allow(dpid1, 1, now));
+  EXPECT_FALSE(buckets.allow(dpid1, 2, now));
+  EXPECT_TRUE(buckets.allow(dpid2, 1, now));
+  EXPECT_FALSE(buckets.allow(dpid2, 1, now));
+  EXPECT_EQ(buckets.buckets().size(), 2);
+
+  // One bucket per in_port.
+  buckets.setLimit(1.0, 1, true);
+  EXPECT_EQ(buckets.buckets().size(), 0);
+  EXPECT_TRUE(buckets.allow(dpid1, 1, now));
+  EXPECT_TRUE(buckets.allow(dpid1, 2, now));
+  EXPECT_FALSE(buckets.allow(dpid1, 2, now));
+  EXPECT_EQ(buckets.buckets().size(), 2);
+
+  UInt64 dropped = 0;
+  for (const auto &bucket : buckets.buckets()) {
+    dropped += bucket.second.dropped();
+  }
+  EXPECT_EQ(dropped, 1);
+}
+
+TEST(tokenbucket, idle) {
+  TokenBucket bucket{2.0, 2};
+  Timestamp now = Timestamp::now();
+
+  EXPECT_TRUE(bucket.idle(now));
+  EXPECT_TRUE(bucket.allow(now));
+  EXPECT_FALSE(bucket.idle(now));
+  EXPECT_FALSE(bucket.idle(now + TimeInterval{0.25}));
+  EXPECT_TRUE(bucket.idle(now + TimeInterval{0.5}));
+}
+
+TEST(tokenbucket, map_expire) {
+  DatapathID dpid{"00:00:00:00:00:00:00:01"};
+  Timestamp now = Timestamp::now();
+
+  TokenBucketMap buckets;
+  buckets.setLimit(1.0, 1, true);
+
+  const UInt32 maxBuckets = UInt32_narrow_cast(kMaxTokenBuckets);
+  for (UInt32 port = 1; port <= maxBuckets; ++port) {
+    EXPECT_TRUE(buckets.allow(dpid, port, now));
+  }
+  EXPECT_EQ(buckets.buckets().size(), kMaxTokenBuckets);
+
+  // Ports 1 and 2 are busy again. The other buckets are idle, so they are
+  // removed to make room for a new port.
+  EXPECT_TRUE(buckets.allow(dpid, 1, now + TimeInterval{1.5}));
+  EXPECT_TRUE(buckets.allow(dpid, 2, now + TimeInterval{1.5}));
+  EXPECT_TRUE(buckets.allow(dpid, maxBuckets + 1, now + TimeInterval{2.0}));
+  EXPECT_EQ(buckets.buckets().size(), 3);
+
+  // Port 1 keeps its state.
+  EXPECT_FALSE(buckets.allow(dpid, 1, now + TimeInterval{2.0}));
+}
@@ -18,3 +18,48 @@ TEST(rpcevents, test_TrimErrorMessage) {
   ofp::rpc::TrimErrorMessage(msg3);
   EXPECT_EQ(msg3, "abc");
 }
+
+TEST(rpcevents, test_RpcMetricsResponse) {
+  using namespace ofp::rpc;
+
+  RpcMetricsResponse response{RpcID{7}};
+  response.result.rpc.txEvents = 3;
+  response.result.connections.emplace_back();
+  RpcChannelMetrics &channel = response.result.connections.back();
+  channel.connId = 2;
+  channel.datapathId = ofp::DatapathID{"00:00:00:00:00:00:00:01"};
+  channel.rxMessages = 5;
+  response.result.filterHits = {4, 0};
+  response.result.filterDrops.emplace_back();
+  RpcFilterDrops &drops = response.result.filterDrops.back();
+  drops.index = 1;
+  drops.datapathId = ofp::DatapathID{"00:00:00:00:00:00:00:01"};
+  drops.inPort = 3;
+  drops.dropped = 6;
+  response.result.loopLag = 12;
+
+  EXPECT_EQ(
+      "{\"id\":7,\"result\":{\"rpc\":{\"tx_events\":3,\"rx_events\":0,\"tx_"
+      "bytes\":0,\"rx_bytes\":0,\"dropped_events\":0,\"decode_errors\":0,"
+      "\"output_queue\":0,\"max_output_queue\":0},\"connections\":[{\"conn_"
+      "id\":2,\"datapath_id\":\"00:00:00:00:00:00:00:01\",\"auxiliary_id\":0,"
+      "\"rx_messages\":5,\"rx_bytes\":0,\"tx_bytes\":0}],\"filter_hits\":[4,0]"
+      ",\"filter_drops\":[{\"index\":1,\"datapath_id\":\"00:00:00:00:00:00:"
+      "00:01\",\"in_port\":3,\"dropped\":6}],\"loop_lag\":12,\"max_loop_"
+      "lag\":0}}",
+      response.toJson());
+
+  std::string text = response.toPrometheus();
+  EXPECT_NE(std::string::npos, text.find("\noftr_rpc_tx_events_total 3\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("\noftr_channel_rx_messages_total{conn_id=\"2\","
+                      "datapath_id=\"00:00:00:00:00:00:00:01\",auxiliary_id="
+                      "\"0\"} 5\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("\noftr_filter_hits_total{index=\"1\"} 0\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("\noftr_filter_drops_total{index=\"1\",datapath_id="
+                      "\"00:00:00:00:00:00:00:01\",in_port=\"3\"} 6\n"));
+  EXPECT_NE(std::string::npos,
+            text.find("\noftr_engine_loop_lag_seconds 0.012\n"));
+}
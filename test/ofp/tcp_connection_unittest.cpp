@@ -0,0 +1,310 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#include <numeric>
+
+#include "ofp/ofp.h"
+#include "ofp/sys/engine.h"
+#include "ofp/unittest.h"
+#include "ofp/yaml/decoder.h"
+
+using namespace ofp;
+
+// These tests check how a TCP connection holds messages while the engine has
+// paused reads. The peer is a raw socket, so it is not affected by the pause.
+
+const UInt16 kHoldTestingPort = 6667;
+
+// Size of the hold queue in TCP_Connection (kHoldLimit).
+const size_t kHoldLimit = 65535;
+
+static ByteList makeMessage(OFPType type, UInt32 xid) {
+  Header hdr{type};
+  hdr.setVersion(OFP_VERSION_4);
+  hdr.setLength(sizeof(Header));
+  hdr.setXid(xid);
+  return ByteList{&hdr, sizeof(hdr)};
+}
+
+class HoldTest {
+ public:
+  explicit HoldTest(UInt32 barrierCount)
+      : engine_{driver_.engine()},
+        sock_{engine_->io()},
+        timer_{engine_->io()},
+        barrierCount_{barrierCount} {}
+
+  // Run the test until every barrier is delivered, or until time runs out.
+  void run();
+
+  // Called by HoldListener.
+  void onChannelUp(Channel *channel);
+  void onMessage(Message *message);
+
+  const std::vector<UInt32> &delivered() const { return delivered_; }
+  bool echoWhilePaused() const { return echoWhilePaused_; }
+  size_t deliveredBeforeEcho() const { return deliveredBeforeEcho_; }
+
+  static HoldTest *GLOBAL_test;
+
+ private:
+  Driver driver_;
+  sys::Engine *engine_;
+  asio::ip::tcp::socket sock_;
+  asio::steady_timer timer_;
+  UInt32 barrierCount_;
+  ByteList output_;
+  Header header_{OFPT_UNSUPPORTED};
+  ByteList body_;
+  std::vector<UInt32> delivered_;
+  bool echoReceived_ = false;
+  bool echoWhilePaused_ = false;
+  size_t deliveredBeforeEcho_ = 0;
+
+  void asyncReadMessage(std::function<void(const Header &)> handler);
+  void onEchoReply(const Header &hdr);
+  void maybeStop();
+};
+
+HoldTest *HoldTest::GLOBAL_test = nullptr;
+
+class HoldListener : public ChannelListener {
+ public:
+  void onChannelUp(Channel *channel) override {
+    HoldTest::GLOBAL_test->onChannelUp(channel);
+  }
+  void onChannelDown(Channel *channel) override {}
+  void onMessage(Message *message) override {
+    HoldTest::GLOBAL_test->onMessage(message);
+  }
+
+  static ChannelListener *factory() { return new HoldListener; }
+};
+
+void HoldTest::run() {
+  GLOBAL_test = this;
+
+  std::error_code err;
+  (void)driver_.listen(ChannelOptions::NONE, 0,
+                       {IPv6Address{"127.0.0.1"}, kHoldTestingPort},
+                       ProtocolVersions::All, HoldListener::factory, err);
+  EXPECT_FALSE(err);
+
+  asio::ip::tcp::endpoint endpt{asio::ip::address_v4::loopback(),
+                                kHoldTestingPort};
+  sock_.async_connect(endpt, [this](const asio::error_code &err) {
+    EXPECT_FALSE(err);
+    output_ = makeMessage(OFPT_HELLO, 1);
+    asio::write(sock_, asio::buffer(output_.data(), output_.size()));
+
+    // Skip the HELLO from the other side.
+    asyncReadMessage([](const Header &hdr) {
+      EXPECT_EQ(OFPT_HELLO, hdr.type());
+    });
+  });
+
+  // Fail the test if it takes too long.
+  driver_.stop(5000_ms);
+  driver_.run();
+
+  GLOBAL_test = nullptr;
+}
+
+void HoldTest::onChannelUp(Channel *channel) {
+  // Pause reads, then send the barriers followed by an echo request.
+  engine_->setReadPaused(true);
+
+  output_.clear();
+  for (UInt32 xid = 1; xid <= barrierCount_; ++xid) {
+    ByteList msg = makeMessage(OFPT_BARRIER_REQUEST, xid);
+    output_.add(msg.data(), msg.size());
+  }
+  ByteList echo = makeMessage(OFPT_ECHO_REQUEST, 0xECECECEC);
+  output_.add(echo.data(), echo.size());
+
+  asio::async_write(sock_, asio::buffer(output_.data(), output_.size()),
+                    [](const asio::error_code &err, size_t) {
+                      EXPECT_FALSE(err);
+                    });
+
+  asyncReadMessage([this](const Header &hdr) { onEchoReply(hdr); });
+
+  // If the echo reply doesn't arrive while reads are paused, resume reads
+  // after a while.
+  timer_.expires_after(std::chrono::milliseconds(250));
+  timer_.async_wait([this](const asio::error_code &err) {
+    if (!err) {
+      engine_->setReadPaused(false);
+    }
+  });
+}
+
+void HoldTest::onMessage(Message *message) {
+  EXPECT_FALSE(engine_->isReadPaused());
+  EXPECT_EQ(OFPT_BARRIER_REQUEST, message->type());
+  delivered_.push_back(message->xid());
+  maybeStop();
+}
+
+void HoldTest::onEchoReply(const Header &hdr) {
+  EXPECT_EQ(OFPT_ECHO_REPLY, hdr.type());
+  EXPECT_EQ(0xECECECEC, hdr.xid());
+
+  echoWhilePaused_ = engine_->isReadPaused();
+  deliveredBeforeEcho_ = delivered_.size();
+
+  if (echoWhilePaused_) {
+    timer_.cancel();
+    engine_->setReadPaused(false);
+  }
+
+  echoReceived_ = true;
+  maybeStop();
+}
+
+void HoldTest::maybeStop() {
+  if (echoReceived_ && delivered_.size() == barrierCount_) {
+    driver_.stop();
+  }
+}
+
+void HoldTest::asyncReadMessage(std::function<void(const Header &)> handler) {
+  asio::async_read(
+      sock_, asio::buffer(&header_, sizeof(header_)),
+      [this, handler](const asio::error_code &err, size_t) {
+        ASSERT_FALSE(err);
+        size_t bodyLen = header_.length() - sizeof(Header);
+        body_.resize(bodyLen);
+        asio::async_read(sock_, asio::buffer(body_.mutableData(), bodyLen),
+                         [this, handler](const asio::error_code &err, size_t) {
+                           ASSERT_FALSE(err);
+                           handler(header_);
+                         });
+      });
+}
+
+TEST(tcp_connection, echo_ahead_of_held) {
+  HoldTest test{3};
+  test.run();
+
+  // The echo request is answered while reads are paused, before the barriers
+  // that arrived ahead of it are delivered.
+  EXPECT_TRUE(test.echoWhilePaused());
+  EXPECT_EQ(0, test.deliveredBeforeEcho());
+
+  // The held barriers are delivered in order when reads resume.
+  std::vector<UInt32> expected = {1, 2, 3};
+  EXPECT_EQ(expected, test.delivered());
+}
+
+TEST(tcp_connection, hold_limit) {
+  // Send more barriers than the hold queue can take.
+  const UInt32 count = UInt32_narrow_cast(kHoldLimit / sizeof(Header) + 1000);
+  HoldTest test{count};
+  test.run();
+
+  // Once the hold queue is full, the connection stops reading. The echo
+  // request behind it is not answered until reads resume and every barrier
+  // ahead of it has been delivered.
+  EXPECT_FALSE(test.echoWhilePaused());
+  EXPECT_EQ(count, test.deliveredBeforeEcho());
+
+  std::vector<UInt32> expected(count);
+  std::iota(expected.begin(), expected.end(), 1);
+  EXPECT_EQ(expected, test.delivered());
+}
+
+// Reads two messages into the connection's Message object. The listener sets
+// a duplicate count on the first message, the way the filter table does when
+// it escalates a deduplicated PacketIn.
+class DuplicatesTest {
+ public:
+  DuplicatesTest() : sock_{driver_.engine()->io()} {}
+
+  void run();
+
+  // Called by DuplicatesListener.
+  void onChannelUp(Channel *channel);
+  void onMessage(Message *message);
+
+  const std::vector<std::string> &decoded() const { return decoded_; }
+
+  static DuplicatesTest *GLOBAL_test;
+
+ private:
+  Driver driver_;
+  asio::ip::tcp::socket sock_;
+  ByteList output_;
+  std::vector<std::string> decoded_;
+};
+
+DuplicatesTest *DuplicatesTest::GLOBAL_test = nullptr;
+
+class DuplicatesListener : public ChannelListener {
+ public:
+  void onChannelUp(Channel *channel) override {
+    DuplicatesTest::GLOBAL_test->onChannelUp(channel);
+  }
+  void onChannelDown(Channel *channel) override {}
+  void onMessage(Message *message) override {
+    DuplicatesTest::GLOBAL_test->onMessage(message);
+  }
+
+  static ChannelListener *factory() { return new DuplicatesListener; }
+};
+
+void DuplicatesTest::run() {
+  GLOBAL_test = this;
+
+  std::error_code err;
+  (void)driver_.listen(ChannelOptions::NONE, 0,
+                       {IPv6Address{"127.0.0.1"}, kHoldTestingPort},
+                       ProtocolVersions::All, DuplicatesListener::factory, err);
+  EXPECT_FALSE(err);
+
+  asio::ip::tcp::endpoint endpt{asio::ip::address_v4::loopback(),
+                                kHoldTestingPort};
+  sock_.async_connect(endpt, [this](const asio::error_code &err) {
+    EXPECT_FALSE(err);
+    output_ = makeMessage(OFPT_HELLO, 1);
+    asio::write(sock_, asio::buffer(output_.data(), output_.size()));
+  });
+
+  // Fail the test if it takes too long.
+  driver_.stop(5000_ms);
+  driver_.run();
+
+  GLOBAL_test = nullptr;
+}
+
+void DuplicatesTest::onChannelUp(Channel *channel) {
+  output_ = makeMessage(OFPT_BARRIER_REQUEST, 1);
+  ByteList msg = makeMessage(OFPT_BARRIER_REQUEST, 2);
+  output_.add(msg.data(), msg.size());
+
+  asio::async_write(sock_, asio::buffer(output_.data(), output_.size()),
+                    [](const asio::error_code &err, size_t) {
+                      EXPECT_FALSE(err);
+                    });
+}
+
+void DuplicatesTest::onMessage(Message *message) {
+  yaml::Decoder decoder{message, true};
+  EXPECT_EQ("", decoder.error());
+  decoded_.push_back(decoder.result().str());
+
+  message->setDuplicates(3);
+  if (decoded_.size() == 2) {
+    driver_.stop();
+  }
+}
+
+TEST(tcp_connection, duplicates_reset) {
+  DuplicatesTest test;
+  test.run();
+
+  // The second message doesn't report the first message's duplicate count.
+  ASSERT_EQ(2, test.decoded().size());
+  EXPECT_EQ(std::string::npos, test.decoded()[0].find("duplicates"));
+  EXPECT_EQ(std::string::npos, test.decoded()[1].find("duplicates"));
+}
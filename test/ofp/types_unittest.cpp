@@ -158,6 +158,74 @@ TEST(types, HexToRawData3) {
   EXPECT_TRUE(error);
 }
 
+// Check the hex kernels against a simple reference, for sizes that cover the
+// block and tail cases.
+TEST(types, RawDataToHex_Blocks) {
+  std::string raw;
+  for (unsigned i = 0; i < 700; ++i) {
+    raw.push_back(static_cast<char>(i * 7));
+  }
+
+  for (size_t len : {1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 700}) {
+    std::string expected;
+    for (size_t i = 0; i < len; ++i) {
+      expected += "0123456789ABCDEF"[UInt8_cast(raw[i]) >> 4];
+      expected += "0123456789ABCDEF"[UInt8_cast(raw[i]) & 0x0F];
+    }
+
+    std::string hex = RawDataToHex(raw.data(), len);
+    EXPECT_EQ(expected, hex);
+
+    std::string buf;
+    llvm::raw_string_ostream oss{buf};
+    RawDataToHex(raw.data(), len, oss);
+    EXPECT_EQ(expected, oss.str());
+
+    // Decode upper and lower case.
+    std::string out(len, '\xFF');
+    bool error = true;
+    EXPECT_EQ(len, HexToRawData(hex, &out[0], len, &error));
+    EXPECT_FALSE(error);
+    EXPECT_EQ(raw.substr(0, len), out);
+
+    std::transform(hex.begin(), hex.end(), hex.begin(), ::tolower);
+    EXPECT_EQ(len, HexToRawData(hex, &out[0], len, &error));
+    EXPECT_FALSE(error);
+    EXPECT_EQ(raw.substr(0, len), out);
+  }
+}
+
+TEST(types, HexToRawData_Blocks) {
+  std::string hex(64, '0');
+  hex += "0102 0304";
+  hex += std::string(62, 'F');
+  hex += "\n";
+
+  char buf[80];
+  bool error = true;
+  EXPECT_EQ(67, HexToRawData(hex, buf, sizeof(buf), &error));
+  EXPECT_FALSE(error);
+  EXPECT_TRUE(IsMemFilled(buf, 32, 0));
+  EXPECT_EQ(0, std::memcmp(buf + 32, "\1\2\3\4", 4));
+  EXPECT_TRUE(IsMemFilled(buf + 36, 31, '\xFF'));
+  EXPECT_TRUE(IsMemFilled(buf + 67, sizeof(buf) - 67, 0));
+
+  // A character in the middle of a block that's not hex or space.
+  hex[40] = 'g';
+  EXPECT_EQ(66, HexToRawData(hex, buf, sizeof(buf), &error));
+  EXPECT_TRUE(error);
+
+  // Output is limited to the buffer size.
+  EXPECT_EQ(20, HexToRawData(std::string(100, 'a'), buf, 20, &error));
+  EXPECT_TRUE(IsMemFilled(buf, 20, '\xAA'));
+
+  // Input stops at an embedded NUL.
+  std::string nul(64, '1');
+  nul[34] = '\0';
+  EXPECT_EQ(17, HexToRawData(nul, buf, sizeof(buf), &error));
+  EXPECT_FALSE(error);
+}
+
 TEST(types, RawDataToBase64) {
   std::string s{"abcdef7890abcdef7890abcdef7890"};
   EXPECT_EQ("", RawDataToBase64(s.data(), 0));
@@ -171,6 +239,20 @@ TEST(types, RawDataToBase64) {
   EXPECT_EQ("== base64 too big ==", RawDataToBase64(s.data(), 0x80000001UL));
 }
 
+TEST(types, RawDataToBase64_Stream) {
+  std::string s;
+  for (unsigned i = 0; i < 5000; ++i) {
+    s.push_back(static_cast<char>(i));
+  }
+
+  for (size_t len : {0, 1, 2, 3, 3072, 3073, 5000}) {
+    std::string buf;
+    llvm::raw_string_ostream oss{buf};
+    RawDataToBase64(s.data(), len, oss);
+    EXPECT_EQ(RawDataToBase64(s.data(), len), oss.str());
+  }
+}
+
 TEST(types, MemCopyMasked) {
   UInt32 a = 0x12345678;
   UInt32 b = 0xFFFF000F;
@@ -8,7 +8,9 @@
 #include <fstream>
 #include <iostream>
 
+#include "./oftr_pipeline.h"
 #include "./oftr_util.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "ofp/log.h"
 #include "ofp/yaml/decoder.h"
@@ -25,6 +27,31 @@ using ExitStatus = Decode::ExitStatus;
 
 static size_t findDiffOffset(const UInt8 *lhs, const UInt8 *rhs, size_t size);
 
+// Size of the output buffer. When the input is a memory-mapped file, output is
+// only flushed when this buffer fills.
+const size_t kOutputBufferSize = 64 * 1024;
+
+/// A batch of raw messages read from the input, along with the decoded output
+/// for the messages. Used by the parallel decoder (--jobs).
+///
+/// `data` refers to `buffer` when the messages are read from a stream, or to
+/// the input file itself when it is memory-mapped.
+struct Decode::Batch {
+  struct Item {
+    size_t size;
+    ofp::Timestamp time;
+  };
+
+  ofp::ByteRange data;
+  ofp::ByteList buffer;
+  std::vector<Item> items;
+  std::string output;
+  std::string errors;
+  ExitStatus result = ExitStatus::Success;
+  std::string readErrors;
+  ExitStatus readResult = ExitStatus::Success;
+};
+
 int Decode::run(int argc, const char *const *argv) {
   parseCommandLineOptions(argc, argv,
                           "Translate binary OpenFlow messages in the input "
@@ -42,6 +69,10 @@ int Decode::run(int argc, const char *const *argv) {
     llvm::errs() << "Error: opening file for output " << outputFile_ << '\n';
     return static_cast<int>(ExitStatus::FileOpenFailed);
   }
+  output_->SetBufferSize(kOutputBufferSize);
+
+  // Reuse one decoder (and its output buffer) for all messages.
+  decoder_.reset(new ofp::yaml::Decoder{json_, pktDecode_});
 
   // Put opening '[' only if format is json array.
   if (!silent_ && jsonArray_) {
@@ -150,6 +181,13 @@ ExitStatus Decode::decodeFile(const std::string &filename) {
       llvm::errs() << "Error: can't open directory: " << filename << '\n';
       return ExitStatus::FileOpenFailed;
     }
+
+    // Map a regular file into memory. Pipes and other special files are
+    // read as a stream.
+    if (llvm::sys::fs::is_regular_file(filename)) {
+      return decodeMappedFile(filename);
+    }
+
     file.open(filename, std::ifstream::binary);
     input = &file;
   } else {
@@ -162,17 +200,36 @@ ExitStatus Decode::decodeFile(const std::string &filename) {
   }
 
   setCurrentFilename(filename);
-  ExitStatus result = decodeMessages(*input);
+  ExitStatus result = parallelDecode()
+                          ? decodeMessagesParallel(input, ofp::ByteRange{})
+                          : decodeMessages(*input);
 
   setCurrentFilename("");
 
   return result;
 }
 
+ExitStatus Decode::decodeMappedFile(const std::string &filename) {
+  auto buffer = llvm::MemoryBuffer::getFile(filename, -1, false);
+  if (!buffer) {
+    llvm::errs() << "Error: opening file " << filename << '\n';
+    return ExitStatus::FileOpenFailed;
+  }
+
+  ofp::ByteRange data{(*buffer)->getBufferStart(), (*buffer)->getBufferSize()};
+
+  setCurrentFilename(filename);
+  ExitStatus result = parallelDecode() ? decodeMessagesParallel(nullptr, data)
+                                       : decodeBuffer(data);
+  setCurrentFilename("");
+
+  return result;
+}
+
 ExitStatus Decode::decodeMessages(std::istream &input) {
   // Create message buffers.
   ofp::Message message{nullptr};
-  ofp::Message originalMessage{nullptr};
+  ofp::ByteList original;
   ofp::Timestamp timestamp;
 
   message.setInfo(&sessionInfo_);
@@ -184,7 +241,7 @@ ExitStatus Decode::decodeMessages(std::istream &input) {
 
     input.read(msg, sizeof(ofp::Header));
     if (!input) {
-      return checkError(input, sizeof(ofp::Header), true);
+      return checkError(input, sizeof(ofp::Header), true, llvm::errs());
     }
 
     if (timestampFormat_ > kTimestampNone) {
@@ -204,18 +261,24 @@ ExitStatus Decode::decodeMessages(std::istream &input) {
 
     input.read(msg + sizeof(ofp::Header), bodyLen);
     if (!input) {
-      return checkError(input, bodyLen, false);
+      return checkError(input, bodyLen, false, llvm::errs());
+    }
+
+    // Skip filtered messages before we copy and normalize them.
+    if (!isMsgTypeAllowed({message.data(), message.size()}, &sessionInfo_) ||
+        !isPacketInAllowed(&message)) {
+      continue;
     }
 
     // Save a copy of the original message binary before we normalize it
     // for parsing. After we decode the message, we'll re-encode it and
     // compare it to this original.
 
-    originalMessage.assign(message);
+    original.set(message.data(), message.size());
     message.normalize();
     message.setTime(timestamp);
 
-    ExitStatus result = decodeOneMessage(&message, &originalMessage);
+    ExitStatus result = decodeOneMessage(&message, original.toRange());
     if (result != ExitStatus::Success && !keepGoing_) {
       return result;
     }
@@ -224,6 +287,266 @@ ExitStatus Decode::decodeMessages(std::istream &input) {
   return ExitStatus::Success;
 }
 
+// Decode messages that are already in memory. The output is flushed only when
+// the output buffer fills, or when all the messages are decoded. The original
+// message binary is still in `data`, so only the copy to normalize is made.
+ExitStatus Decode::decodeBuffer(ofp::ByteRange data) {
+  ofp::Message message{nullptr};
+  ofp::Timestamp timestamp;
+  ofp::ByteRange msg;
+
+  message.setInfo(&sessionInfo_);
+  flushEachMessage_ = false;
+
+  ExitStatus result = ExitStatus::Success;
+  while (!data.empty()) {
+    result = frameMessage(&data, &msg, llvm::errs());
+    if (result != ExitStatus::Success) {
+      break;
+    }
+
+    if (timestampFormat_ > kTimestampNone) {
+      timestamp = ofp::Timestamp::now();
+    }
+
+    if (!isMsgTypeAllowed(msg, &sessionInfo_)) {
+      continue;
+    }
+
+    message.setData(msg.data(), msg.size());
+    if (!isPacketInAllowed(&message)) {
+      continue;
+    }
+
+    message.normalize();
+    message.setTime(timestamp);
+
+    result = decodeOneMessage(&message, msg);
+    if (result != ExitStatus::Success && !keepGoing_) {
+      break;
+    }
+    result = ExitStatus::Success;
+  }
+
+  flushEachMessage_ = true;
+  output_->flush();
+
+  return result;
+}
+
+// Remove the next message from the front of `data` and return it in `msg`.
+ExitStatus Decode::frameMessage(ofp::ByteRange *data, ofp::ByteRange *msg,
+                                llvm::raw_ostream &errs) const {
+  if (data->size() < sizeof(ofp::Header)) {
+    reportShortRead(errs, data->size(), sizeof(ofp::Header), true);
+    *data = ofp::ByteRange{};
+    return ExitStatus::MessageReadFailed;
+  }
+
+  // If the header says the length is less than 8 bytes, the entire message
+  // *must* still be 8 bytes in length.
+  size_t msgLen = ofp::Interpret_cast<ofp::Header>(data->data())->length();
+  if (msgLen < sizeof(ofp::Header)) {
+    msgLen = sizeof(ofp::Header);
+  }
+
+  if (data->size() < msgLen) {
+    reportShortRead(errs, data->size() - sizeof(ofp::Header),
+                    msgLen - sizeof(ofp::Header), false);
+    *data = ofp::ByteRange{};
+    return ExitStatus::MessageReadFailed;
+  }
+
+  *msg = ofp::ByteRange{data->data(), msgLen};
+  *data = ofp::ByteRange{data->data() + msgLen, data->end()};
+
+  return ExitStatus::Success;
+}
+
+// Decode messages using a pipeline of threads. A reader thread frames the
+// input into batches of messages; `jobs_` worker threads decode the batches
+// into text; and the calling thread writes the text of each batch in input
+// order. If `input` is null, the messages are framed in place from `data`.
+ExitStatus Decode::decodeMessagesParallel(std::istream *input,
+                                          ofp::ByteRange data) {
+  return RunOrderedPipeline<Batch, ExitStatus, ofp::yaml::Decoder>(
+      jobs_,
+      [&](Batch *batch) {
+        if (input) {
+          batch->readResult = readBatch(*input, batch);
+          return !*input;
+        }
+        batch->readResult = frameBatch(&data, batch);
+        return data.empty();
+      },
+      [this]() {
+        return std::unique_ptr<ofp::yaml::Decoder>{
+            new ofp::yaml::Decoder{json_, pktDecode_}};
+      },
+      [this](ofp::yaml::Decoder *decoder, Batch *batch) {
+        decodeBatch(decoder, batch);
+      },
+      [this](const Batch *batch) { return writeBatch(batch); });
+}
+
+// Read up to a batch of messages from the input. Report a read error in the
+// batch, so it is written after the output of all preceding messages.
+ExitStatus Decode::readBatch(std::istream &input, Batch *batch) {
+  llvm::raw_string_ostream errs{batch->readErrors};
+  ofp::ByteList &buffer = batch->buffer;
+  ofp::Timestamp timestamp;
+  ExitStatus result = ExitStatus::Success;
+
+  while (input && buffer.size() < kBatchMaxBytes &&
+         batch->items.size() < kBatchMaxMessages) {
+    // Read the message header.
+    size_t offset = buffer.size();
+    buffer.addUninitialized(sizeof(ofp::Header));
+    char *msg = reinterpret_cast<char *>(buffer.mutableData() + offset);
+
+    input.read(msg, sizeof(ofp::Header));
+    if (!input) {
+      buffer.resize(offset);
+      result = checkError(input, sizeof(ofp::Header), true, errs);
+      break;
+    }
+
+    if (timestampFormat_ > kTimestampNone) {
+      timestamp = ofp::Timestamp::now();
+    }
+
+    // If the header says the length is less than 8 bytes, the entire message
+    // *must* still be 8 bytes in length.
+    size_t msgLen = reinterpret_cast<const ofp::Header *>(msg)->length();
+    if (msgLen < sizeof(ofp::Header)) {
+      msgLen = sizeof(ofp::Header);
+    }
+
+    // Read the message body.
+    std::streamsize bodyLen = ofp::Signed_cast(msgLen - sizeof(ofp::Header));
+    buffer.addUninitialized(ofp::Unsigned_cast(bodyLen));
+    msg = reinterpret_cast<char *>(buffer.mutableData() + offset);
+
+    input.read(msg + sizeof(ofp::Header), bodyLen);
+    if (!input) {
+      buffer.resize(offset);
+      result = checkError(input, bodyLen, false, errs);
+      break;
+    }
+
+    batch->items.push_back({msgLen, timestamp});
+  }
+
+  batch->data = buffer.toRange();
+
+  return result;
+}
+
+// Frame up to a batch of messages in place from the front of `data`.
+ExitStatus Decode::frameBatch(ofp::ByteRange *data, Batch *batch) {
+  llvm::raw_string_ostream errs{batch->readErrors};
+  const UInt8 *begin = data->data();
+  ofp::Timestamp timestamp;
+  ofp::ByteRange msg;
+  ExitStatus result = ExitStatus::Success;
+
+  while (!data->empty() &&
+         ofp::Unsigned_cast(data->data() - begin) < kBatchMaxBytes &&
+         batch->items.size() < kBatchMaxMessages) {
+    result = frameMessage(data, &msg, errs);
+    if (result != ExitStatus::Success) {
+      break;
+    }
+
+    if (timestampFormat_ > kTimestampNone) {
+      timestamp = ofp::Timestamp::now();
+    }
+
+    batch->items.push_back({msg.size(), timestamp});
+  }
+
+  batch->data = ofp::ByteRange{begin, ofp::Unsigned_cast(data->data() - begin)};
+
+  return result;
+}
+
+// Decode the messages in a batch. This runs on a worker thread, so it must
+// not write to the output or error streams directly.
+void Decode::decodeBatch(ofp::yaml::Decoder *decoder, Batch *batch) {
+  ofp::Message message{nullptr};
+  llvm::raw_string_ostream errs{batch->errors};
+
+  message.setInfo(&sessionInfo_);
+
+  const UInt8 *data = batch->data.data();
+  for (const Batch::Item &item : batch->items) {
+    ofp::ByteRange original{data, item.size};
+    data += item.size;
+
+    if (!isMsgTypeAllowed(original, &sessionInfo_)) {
+      continue;
+    }
+
+    message.setData(original.data(), original.size());
+    if (!isPacketInAllowed(&message)) {
+      continue;
+    }
+
+    message.normalize();
+    message.setTime(item.time);
+
+    bool decoded = false;
+    ExitStatus result =
+        decodeMessage(decoder, &message, original, errs, &decoded);
+    if (result != ExitStatus::Success) {
+      batch->result = result;
+      if (!keepGoing_)
+        break;
+    }
+
+    if (decoded && !silent_) {
+      if (jsonArray_ && !batch->output.empty()) {
+        batch->output += ',';
+      }
+      llvm::StringRef text = decoder->result();
+      batch->output.append(text.data(), text.size());
+      if (json_) {
+        batch->output += '\n';
+      }
+    }
+  }
+
+  errs.flush();
+}
+
+// Write the output and errors from a decoded batch. Return the status that
+// the serial decoder would return after the same messages.
+ExitStatus Decode::writeBatch(const Batch *batch) {
+  if (!batch->output.empty()) {
+    if (jsonArray_ && jsonArrayNeedComma_) {
+      *output_ << ',';
+    }
+    *output_ << batch->output;
+    jsonArrayNeedComma_ = json_;
+    output_->flush();
+  }
+
+  if (!batch->errors.empty()) {
+    llvm::errs() << batch->errors;
+  }
+
+  if (batch->result != ExitStatus::Success && !keepGoing_) {
+    return batch->result;
+  }
+
+  if (batch->readResult != ExitStatus::Success) {
+    llvm::errs() << batch->readErrors;
+    return batch->readResult;
+  }
+
+  return ExitStatus::Success;
+}
+
 ExitStatus Decode::decodePcapDevice(const std::string &device) {
 #if HAVE_LIBPCAP
   ofp::demux::PktSource pcap;
@@ -303,23 +626,20 @@ ExitStatus Decode::decodePcapFiles() {
 }
 
 ExitStatus Decode::checkError(std::istream &input, std::streamsize readLen,
-                              bool header) {
+                              bool header, llvm::raw_ostream &errs) {
   assert(!input);
 
   if (!input.eof()) {
     // Premature I/O error; we're not at EOF.
     // FIXME: print out the error
-    llvm::errs() << "Filename: " << currentFilename_ << ":\n";
-    llvm::errs() << "Error: I/O error reading from file\n";
+    errs << "Filename: " << currentFilename_ << ":\n";
+    errs << "Error: I/O error reading from file\n";
     return ExitStatus::MessageReadFailed;
   } else if (input.gcount() != readLen && !(header && input.gcount() == 0)) {
     // EOF and insufficient input remaining. N.B. Zero bytes of header read at
     // EOF is a normal exit condition.
-    llvm::errs() << "Filename: " << currentFilename_ << ":\n";
-    const char *what = header ? "header" : "body";
-    llvm::errs() << "Error: Only " << input.gcount()
-                 << " bytes read of message " << what << ". Expected to read "
-                 << readLen << " bytes.\n";
+    reportShortRead(errs, ofp::Unsigned_cast(input.gcount()),
+                    ofp::Unsigned_cast(readLen), header);
     return ExitStatus::MessageReadFailed;
   } else {
     // EOF and everything is good.
@@ -327,27 +647,81 @@ ExitStatus Decode::checkError(std::istream &input, std::streamsize readLen,
   }
 }
 
+void Decode::reportShortRead(llvm::raw_ostream &errs, size_t count,
+                             size_t readLen, bool header) const {
+  errs << "Filename: " << currentFilename_ << ":\n";
+  const char *what = header ? "header" : "body";
+  errs << "Error: Only " << count << " bytes read of message " << what
+       << ". Expected to read " << readLen << " bytes.\n";
+}
+
 ExitStatus Decode::decodeOneMessage(const ofp::Message *message,
-                                    const ofp::Message *originalMessage) {
-  if (!isMsgTypeAllowed(message)) {
-    // Ignore message based on type.
-    log_debug("decodeOneMessage (message ignored)", message->type());
-    return ExitStatus::Success;
+                                    ofp::ByteRange original) {
+  bool decoded = false;
+  ExitStatus result = decodeMessage(decoder_.get(), message, original,
+                                    llvm::errs(), &decoded);
+  if (result != ExitStatus::Success || !decoded) {
+    return result;
   }
 
+  if (!silent_) {
+    if (jsonArray_ && jsonArrayNeedComma_) {
+      *output_ << ',';
+    }
+    *output_ << decoder_->result();
+    if (json_) {
+      *output_ << '\n';
+      jsonArrayNeedComma_ = true;
+    }
+    if (flushEachMessage_) {
+      output_->flush();
+    }
+  }
+
+  // Double-check the result by re-encoding the YAML message.
+  if (verifyOutput_ && !verifyOutput(decoder_->result(), original)) {
+    return ExitStatus::VerifyOutputFailed;
+  }
+
+  // Optionally, write data from PacketIn or PacketOut messages.
   const bool hasPkt = (message->type() == ofp::OFPT_PACKET_IN ||
                        message->type() == ofp::OFPT_PACKET_OUT);
-  if (hasPkt && !isPktDataAllowed(message)) {
-    // Ignore message based on packet_in/packet_out contents.
-    log_debug("decodeOneMessage (packet message ignored)");
-    return ExitStatus::Success;
+  if (pktSinkFile_ && hasPkt) {
+    extractPacketDataToFile(message);
+  }
+
+  // Optionally run the original message through a basic fuzz test to stress
+  // test the decoder.
+  if (fuzzStressTest_) {
+    fuzzStressTest(original);
   }
 
-  log_debug("decodeOneMessage (normalized):", *message);
+  return ExitStatus::Success;
+}
 
-  ofp::yaml::Decoder decoder{message, json_, pktDecode_};
+// Filter and decode one message using `decoder`. Report errors to `errs`. Set
+// `decoded` to false if the message is filtered out. `original` is the message
+// binary before it was normalized.
+//
+// The message type and PacketIn filters are checked by the caller, before the
+// message is normalized. Only the PacketOut filter is checked here, because
+// normalizing changes the layout of a version 1 PacketOut.
+ExitStatus Decode::decodeMessage(ofp::yaml::Decoder *decoder,
+                                 const ofp::Message *message,
+                                 ofp::ByteRange original,
+                                 llvm::raw_ostream &errs,
+                                 bool *decoded) const {
+  *decoded = false;
+
+  if (!isPacketOutAllowed(message)) {
+    // Ignore message based on packet_out contents.
+    log_debug("decodeMessage (packet message ignored)");
+    return ExitStatus::Success;
+  }
+
+  log_debug("decodeMessage (normalized):", *message);
 
-  if (!decoder.error().empty()) {
+  if (!decoder->decode(message)) {
     // An error occurred in decoding the message.
 
     if (invertCheck_) {
@@ -356,9 +730,9 @@ ExitStatus Decode::decodeOneMessage(const ofp::Message *message,
     }
 
     if (!silentError_) {
-      llvm::errs() << "Filename: " << currentFilename_ << '\n';
-      llvm::errs() << "Error: Decode failed: " << decoder.error() << '\n';
-      llvm::errs() << *originalMessage << '\n';
+      errs << "Filename: " << currentFilename_ << '\n';
+      errs << "Error: Decode failed: " << decoder->error() << '\n';
+      errs << ofp::ByteList{original} << '\n';
     }
 
     return ExitStatus::DecodeFailed;
@@ -368,42 +742,15 @@ ExitStatus Decode::decodeOneMessage(const ofp::Message *message,
     // There was no problem decoding the message, but we are expecting the data
     // to be invalid (because we are fuzz testing). Report this as an error.
     if (!silentError_) {
-      llvm::errs() << "Filename: " << currentFilename_ << '\n';
-      llvm::errs()
+      errs << "Filename: " << currentFilename_ << '\n';
+      errs
           << "Error: Decode succeeded when --invert-check flag is specified.\n";
-      llvm::errs() << *originalMessage << '\n';
+      errs << ofp::ByteList{original} << '\n';
     }
     return ExitStatus::DecodeSucceeded;
   }
 
-  if (!silent_) {
-    if (jsonArray_ && jsonArrayNeedComma_) {
-      *output_ << ',';
-    }
-    *output_ << decoder.result();
-    if (json_) {
-      *output_ << '\n';
-      jsonArrayNeedComma_ = true;
-    }
-    output_->flush();
-  }
-
-  // Double-check the result by re-encoding the YAML message.
-  if (verifyOutput_ && !verifyOutput(decoder.result(), originalMessage)) {
-    return ExitStatus::VerifyOutputFailed;
-  }
-
-  // Optionally, write data from PacketIn or PacketOut messages.
-  if (pktSinkFile_ && hasPkt) {
-    extractPacketDataToFile(message);
-  }
-
-  // Optionally run the original message through a basic fuzz test to stress
-  // test the decoder.
-  if (fuzzStressTest_) {
-    fuzzStressTest(originalMessage);
-  }
-
+  *decoded = true;
   return ExitStatus::Success;
 }
 
@@ -440,7 +787,7 @@ static bool matchConnId(llvm::StringRef pattern, ofp::UInt64 connId) {
 ///
 /// `msgType` is passed in pre-computed. If pattern begins with '!', negate
 /// the result.
-static bool matchMessage(const char *pattern, const ofp::Message *message,
+static bool matchMessage(const char *pattern, const ofp::MessageInfo *info,
                          const char *msgType) {
   assert(pattern);
   assert(msgType);
@@ -456,19 +803,16 @@ static bool matchMessage(const char *pattern, const ofp::Message *message,
 
   if (pat.startswith("src:")) {
     // "src:<port>" matches messages from <port>
-    ofp::MessageInfo *info = message->info();
     if (!info)
       return false;
     result = matchEndpoint(pat.substr(4), info->source());
   } else if (pat.startswith("dst:")) {
     // "dst:<port>" matches messages to <port>
-    ofp::MessageInfo *info = message->info();
     if (!info)
       return false;
     result = matchEndpoint(pat.substr(4), info->dest());
   } else if (pat.startswith("conn_id:")) {
     // "conn_id:<id>" matches message for conn_id <id>
-    ofp::MessageInfo *info = message->info();
     if (!info)
       return false;
     result = matchConnId(pat.substr(8), info->sessionId());
@@ -481,22 +825,41 @@ static bool matchMessage(const char *pattern, const ofp::Message *message,
 }
 
 /// Return true if we're allowed to output this message type.
-bool Decode::isMsgTypeAllowed(const ofp::Message *message) const {
+///
+/// `data` is the message binary before it is normalized. The type is
+/// translated exactly as Message::normalize() would translate it, so the
+/// message can be skipped without normalizing it.
+bool Decode::isMsgTypeAllowed(ofp::ByteRange data,
+                              const ofp::MessageInfo *info) const {
+  using namespace ofp;
+
   // No filters?  Allow everything.
   if (msgExcludeFilter_.empty() && msgIncludeFilter_.empty())
     return true;
 
+  const Header *header = Interpret_cast<Header>(data.data());
+  OFPType type =
+      Header::translateType(header->version(), header->type(), OFP_VERSION_4);
+  OFPMultipartType subtype = OFPMP_UNSUPPORTED;
+  if ((type == OFPT_MULTIPART_REQUEST || type == OFPT_MULTIPART_REPLY) &&
+      data.size() >= 12) {
+    UInt16 value = *Big16_cast(data.data() + 8);
+    subtype = static_cast<OFPMultipartType>(value);
+  }
+
   // Get message type as a string, exactly as we would output it.
   std::string buf;
   llvm::raw_string_ostream os{buf};
-  llvm::yaml::ScalarTraits<ofp::MessageType>::output(message->msgType(),
-                                                     nullptr, os);
+  llvm::yaml::ScalarTraits<MessageType>::output(MessageType{type, subtype},
+                                                nullptr, os);
   auto msgType = os.str();
 
   // Check msgType against the exclude filter.
   for (const auto &pattern : msgExcludeFilter_) {
-    if (matchMessage(pattern.c_str(), message, msgType.c_str()))
+    if (matchMessage(pattern.c_str(), info, msgType.c_str())) {
+      log_debug("isMsgTypeAllowed (message ignored)", type);
       return false;
+    }
   }
 
   // Empty include filter means allow everything that's not excluded.
@@ -505,32 +868,50 @@ bool Decode::isMsgTypeAllowed(const ofp::Message *message) const {
 
   // Check msgType against the include filter.
   for (const auto &pattern : msgIncludeFilter_) {
-    if (matchMessage(pattern.c_str(), message, msgType.c_str()))
+    if (matchMessage(pattern.c_str(), info, msgType.c_str()))
       return true;
   }
 
+  log_debug("isMsgTypeAllowed (message ignored)", type);
   return false;
 }
 
-/// Return true if we're allowed to output this packet.
-bool Decode::isPktDataAllowed(const ofp::Message *message) const {
+/// Return true if we're allowed to output this packet. `message` has not been
+/// normalized yet; PacketIn messages are the same before and after.
+bool Decode::isPacketInAllowed(const ofp::Message *message) const {
   using namespace ofp;
 
   if (pktIncludeFilter_.empty())
     return true;
 
-  if (message->type() == OFPT_PACKET_IN) {
-    const PacketIn *packetIn = PacketIn::cast(message);
-    if (packetIn) {
-      return pktIncludeFilter_.match(packetIn->enetFrame(),
-                                     packetIn->totalLen());
-    }
+  // Leave messages that normalize() will reject to the decoder.
+  const Header *header = message->header();
+  if (header->length() != message->size() ||
+      Header::translateType(header->version(), header->type(),
+                            OFP_VERSION_4) != OFPT_PACKET_IN) {
+    return true;
+  }
 
-  } else if (message->type() == OFPT_PACKET_OUT) {
-    const PacketOut *packetOut = PacketOut::cast(message);
-    if (packetOut) {
-      return pktIncludeFilter_.match(packetOut->enetFrame());
-    }
+  const PacketIn *packetIn = PacketIn::cast(message);
+  if (packetIn && !pktIncludeFilter_.match(packetIn->enetFrame(),
+                                           packetIn->totalLen())) {
+    log_debug("isPacketInAllowed (packet message ignored)");
+    return false;
+  }
+
+  return true;
+}
+
+/// Return true if we're allowed to output this packet.
+bool Decode::isPacketOutAllowed(const ofp::Message *message) const {
+  using namespace ofp;
+
+  if (pktIncludeFilter_.empty() || message->type() != OFPT_PACKET_OUT)
+    return true;
+
+  const PacketOut *packetOut = PacketOut::cast(message);
+  if (packetOut) {
+    return pktIncludeFilter_.match(packetOut->enetFrame());
   }
 
   return true;
@@ -591,13 +972,19 @@ void Decode::setCurrentFilename(const std::string &filename) {
 void Decode::pcapMessageCallback(ofp::Message *message, void *context) {
   Decode *decode = reinterpret_cast<Decode *>(context);
 
+  // Skip filtered messages before we copy and normalize them.
+  if (!decode->isMsgTypeAllowed({message->data(), message->size()},
+                                message->info()) ||
+      !decode->isPacketInAllowed(message)) {
+    return;
+  }
+
   // Save a copy of the original message binary before we normalize it
   // for parsing.
-  ofp::Message originalMessage{nullptr};
-  originalMessage.assign(*message);
+  ofp::ByteList original{message->data(), message->size()};
   message->normalize();
 
-  ExitStatus result = decode->decodeOneMessage(message, &originalMessage);
+  ExitStatus result = decode->decodeOneMessage(message, original.toRange());
   if (result != ExitStatus::Success) {
     log_debug("pcapMessageCallback: Failed to decode message");
   }
@@ -648,11 +1035,16 @@ bool Decode::pcapFormat() const {
   return false;
 }
 
+/// Return true if messages may be decoded by the parallel pipeline. Options
+/// that verify, fuzz or extract each message still run serially.
+bool Decode::parallelDecode() const {
+  return jobs_ > 1 && !verifyOutput_ && !fuzzStressTest_ && !pktSinkFile_;
+}
+
 // Double-check the result by re-encoding the YAML message. We should obtain
 // the original message contents. If there is a difference, report the
 // error.
-bool Decode::verifyOutput(const std::string &input,
-                          const ofp::Message *originalMessage) {
+bool Decode::verifyOutput(const std::string &input, ofp::ByteRange original) {
   ofp::yaml::Encoder encoder{input, false};
 
   if (!encoder.error().empty()) {
@@ -662,8 +1054,7 @@ bool Decode::verifyOutput(const std::string &input,
     return false;
   }
 
-  if (!equalMessages({originalMessage->data(), originalMessage->size()},
-                     {encoder.data(), encoder.size()})) {
+  if (!equalMessages(original, {encoder.data(), encoder.size()})) {
     return false;
   }
 
@@ -704,14 +1095,15 @@ void Decode::extractPacketDataToFile(const ofp::Message *message) {
 //     a. Set byte to 0x00
 //     b. Set byte to 0xFF
 //
-void Decode::fuzzStressTest(const ofp::Message *originalMessage) {
+void Decode::fuzzStressTest(ofp::ByteRange original) {
   using namespace ofp;
   Message message{nullptr};
   UInt64 count = 0;
 
+  const OFPType originalType = Interpret_cast<Header>(original.data())->type();
   for (UInt8 newType = 0; newType <= OFPT_MAX_ALLOWED; ++newType) {
-    if (newType != originalMessage->type()) {
-      message.assign(*originalMessage);
+    if (newType != originalType) {
+      message.setData(original.data(), original.size());
       message.mutableHeader()->setType(static_cast<OFPType>(newType));
       SetWatchdogTimer(3);
       message.normalize();
@@ -727,12 +1119,12 @@ void Decode::fuzzStressTest(const ofp::Message *originalMessage) {
   // Only fuzz the first 128 bytes.
   const size_t kFuzzPrefix = 128;
   const size_t kMaxSize =
-      std::min(originalMessage->size(), kFuzzPrefix + sizeof(Header));
+      std::min(original.size(), kFuzzPrefix + sizeof(Header));
 
   for (size_t i = sizeof(Header); i < kMaxSize; ++i) {
     for (UInt8 val : values) {
-      if (originalMessage->getByteAtIndex(i) != val) {
-        message.assign(*originalMessage);
+      if (original.data()[i] != val) {
+        message.setData(original.data(), original.size());
         message.setByteAtIndex(val, i);
         SetWatchdogTimer(3);
         message.normalize();
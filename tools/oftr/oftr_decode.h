@@ -9,6 +9,7 @@
 #include "./oftr.h"
 #include "ofp/messageinfo.h"
 #include "ofp/timestamp.h"
+#include "ofp/yaml/decoder.h"
 
 #if HAVE_LIBPCAP
 #include "ofp/demux/pktfilter.h"
@@ -57,6 +58,7 @@ namespace ofpx {
 //   --msg-include=<types> Output these OpenFlow message types (glob).
 //   --msg-exclude=<types> Don't output these OpenFlow message types (glob).
 //   --timestamp=none|secs Show timestamp in all decodes.
+//   --jobs=<num>          Decode messages using <num> worker threads.
 //
 // Usage:
 //
@@ -74,6 +76,11 @@ namespace ofpx {
 //
 //     oftr decode --invert-check "filename"
 //
+// To decode a large file of binary OpenFlow messages to JSON using 4 threads.
+// The output is in the same order as the input:
+//
+//     oftr decode --json --jobs=4 "filename"
+//
 
 OFP_BEGIN_IGNORE_PADDING
 
@@ -94,10 +101,14 @@ class Decode : public Subprogram {
   int run(int argc, const char *const *argv) override;
 
  private:
+  struct Batch;
+
   std::string currentFilename_;
   std::unique_ptr<llvm::raw_ostream> output_;
+  std::unique_ptr<ofp::yaml::Decoder> decoder_;
   ofp::MessageInfo sessionInfo_;
   bool jsonArrayNeedComma_ = false;
+  bool flushEachMessage_ = true;
 
   std::unique_ptr<ofp::demux::PktSink> pktSinkFile_;
   std::vector<std::string> msgIncludeFilter_;
@@ -108,29 +119,45 @@ class Decode : public Subprogram {
 
   ExitStatus decodeFiles();
   ExitStatus decodeFile(const std::string &filename);
+  ExitStatus decodeMappedFile(const std::string &filename);
   ExitStatus decodeMessages(std::istream &input);
+  ExitStatus decodeBuffer(ofp::ByteRange data);
+  ExitStatus frameMessage(ofp::ByteRange *data, ofp::ByteRange *msg,
+                          llvm::raw_ostream &errs) const;
+  ExitStatus decodeMessagesParallel(std::istream *input, ofp::ByteRange data);
+  ExitStatus readBatch(std::istream &input, Batch *batch);
+  ExitStatus frameBatch(ofp::ByteRange *data, Batch *batch);
+  void decodeBatch(ofp::yaml::Decoder *decoder, Batch *batch);
+  ExitStatus writeBatch(const Batch *batch);
   ExitStatus decodePcapDevice(const std::string &device);
   ExitStatus decodePcapFiles();
   ExitStatus checkError(std::istream &input, std::streamsize readLen,
-                        bool header);
+                        bool header, llvm::raw_ostream &errs);
+  void reportShortRead(llvm::raw_ostream &errs, size_t count, size_t readLen,
+                       bool header) const;
   ExitStatus decodeOneMessage(const ofp::Message *message,
-                              const ofp::Message *originalMessage);
+                              ofp::ByteRange original);
+  ExitStatus decodeMessage(ofp::yaml::Decoder *decoder,
+                           const ofp::Message *message, ofp::ByteRange original,
+                           llvm::raw_ostream &errs, bool *decoded) const;
 
   static void parseMsgFilter(const std::string &input,
                              std::vector<std::string> *filter);
-  bool isMsgTypeAllowed(const ofp::Message *message) const;
-  bool isPktDataAllowed(const ofp::Message *message) const;
+  bool isMsgTypeAllowed(ofp::ByteRange data,
+                        const ofp::MessageInfo *info) const;
+  bool isPacketInAllowed(const ofp::Message *message) const;
+  bool isPacketOutAllowed(const ofp::Message *message) const;
   bool equalMessages(ofp::ByteRange origData, ofp::ByteRange newData) const;
 
   void setCurrentFilename(const std::string &filename);
 
   static void pcapMessageCallback(ofp::Message *message, void *context);
   bool pcapFormat() const;
+  bool parallelDecode() const;
 
-  bool verifyOutput(const std::string &input,
-                    const ofp::Message *originalMessage);
+  bool verifyOutput(const std::string &input, ofp::ByteRange original);
   void extractPacketDataToFile(const ofp::Message *message);
-  void fuzzStressTest(const ofp::Message *originalMessage);
+  void fuzzStressTest(ofp::ByteRange original);
 
   enum PcapFormat { kPcapFormatAuto, kPcapFormatYes, kPcapFormatNo };
   enum TimestampFormat { kTimestampUnset, kTimestampNone, kTimestampSecs };
@@ -168,6 +195,9 @@ class Decode : public Subprogram {
                  clEnumValN(kTimestampSecs, "secs",
                             "Seconds since January 1, 1970 UTC")),
       cl::init(kTimestampUnset)};
+  cl::opt<unsigned> jobs_{
+      "jobs", cl::desc("Decode messages using N worker threads"),
+      cl::ValueRequired, cl::init(1)};
   cl::opt<std::string> outputFile_{
       "output", cl::desc("Write output to specified file instead of stdout"),
       cl::ValueRequired};
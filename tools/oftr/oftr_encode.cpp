@@ -6,6 +6,8 @@
 #include <fstream>
 #include <iostream>
 
+#include "./oftr_pipeline.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "ofp/yaml/decoder.h"
 #include "ofp/yaml/encoder.h"
 
@@ -15,6 +17,33 @@ using ExitStatus = Encode::ExitStatus;
 const char *const kNullYamlMessage = "---\nnull\n...\n";
 const char *const kNullJsonMessage = "null\n";
 
+// Size of the output buffer. When the input is a memory-mapped file, output is
+// only flushed when this buffer fills.
+const size_t kOutputBufferSize = 64 * 1024;
+
+/// A batch of message texts read from the input, along with the encoded output
+/// for the messages. Used by the parallel encoder (--jobs).
+///
+/// `data` refers to `buffer` when the messages are read from a stream, or to
+/// the input file itself when it is memory-mapped. Each item is located by its
+/// offset in `data`, since the texts may be separated by delimiters.
+struct Encode::Batch {
+  struct Item {
+    size_t offset;
+    size_t size;
+    int lineNum;
+  };
+
+  llvm::StringRef data;
+  std::string buffer;
+  std::vector<Item> items;
+  std::string output;
+  std::string errors;
+  ExitStatus result = ExitStatus::Success;
+  std::string readErrors;
+  ExitStatus readResult = ExitStatus::Success;
+};
+
 int Encode::run(int argc, const char *const *argv) {
   parseCommandLineOptions(
       argc, argv,
@@ -32,6 +61,7 @@ int Encode::run(int argc, const char *const *argv) {
     llvm::errs() << "Error: opening file for output " << outputFile_ << '\n';
     return static_cast<int>(ExitStatus::FileOpenFailed);
   }
+  output_->SetBufferSize(kOutputBufferSize);
 
   return static_cast<int>(encodeFiles());
 }
@@ -47,13 +77,16 @@ bool Encode::validateCommandLineArguments() {
     outputFile_ = "-";
   }
 
-  // Set up `readMessage` function.
+  // Set up `readMessage` functions.
   if (jsonArray_) {
     readMessage_ = ofp::yaml::getjson;
+    readMessageRange_ = ofp::yaml::getjson;
   } else if (json_) {
     readMessage_ = ofp::yaml::getline;
+    readMessageRange_ = ofp::yaml::getline;
   } else {
     readMessage_ = ofp::yaml::getyaml;
+    readMessageRange_ = ofp::yaml::getyaml;
   }
 
   return true;
@@ -83,6 +116,13 @@ ExitStatus Encode::encodeFile(const std::string &filename) {
       llvm::errs() << "Error: can't open directory: " << filename << '\n';
       return ExitStatus::FileOpenFailed;
     }
+
+    // Map a regular file into memory. Pipes and other special files are
+    // read as a stream.
+    if (llvm::sys::fs::is_regular_file(filename)) {
+      return encodeMappedFile(filename);
+    }
+
     file.open(filename);
     input = &file;
   } else {
@@ -93,7 +133,8 @@ ExitStatus Encode::encodeFile(const std::string &filename) {
     // Store current filename in instance variable for use in error messages.
     currentFilename_ = filename;
     lineNumber_ = 0;
-    result = encodeMessages(*input);
+    result = jobs_ > 1 ? encodeMessagesParallel(input, llvm::StringRef{})
+                       : encodeMessages(*input);
     currentFilename_ = "";
   } else {
     result = ExitStatus::FileOpenFailed;
@@ -103,73 +144,263 @@ ExitStatus Encode::encodeFile(const std::string &filename) {
   return result;
 }
 
+ExitStatus Encode::encodeMappedFile(const std::string &filename) {
+  auto buffer = llvm::MemoryBuffer::getFile(filename, -1, false);
+  if (!buffer) {
+    llvm::errs() << "Error: opening file " << filename << '\n';
+    return ExitStatus::FileOpenFailed;
+  }
+
+  // Store current filename in instance variable for use in error messages.
+  currentFilename_ = filename;
+  lineNumber_ = 0;
+  llvm::StringRef data = (*buffer)->getBuffer();
+  ExitStatus result = jobs_ > 1 ? encodeMessagesParallel(nullptr, data)
+                                : encodeBuffer(data);
+  currentFilename_ = "";
+
+  return result;
+}
+
 ExitStatus Encode::encodeMessages(std::istream &input) {
   std::string text;
   int lineNum = 0;
+  ofp::yaml::Decoder decoder{json_};
 
   while (readMessage_(input, text, lineNum, lineNumber_)) {
-    log_debug("readMessage line", lineNum, ':', text);
+    ExitStatus result = encodeMessage(text, lineNum, &parser_, &decoder,
+                                      *output_, llvm::errs(), true);
+    if (result != ExitStatus::Success) {
+      return result;
+    }
+    output_->flush();
+  }
 
-    ofp::yaml::Encoder encoder{text, !uncheckedMatch_, lineNum,
-                               ofp::UInt8_narrow_cast(ofversion_.getValue())};
+  if (!input.eof()) {
+    // Premature I/O error; we're not at EOF.
+    llvm::errs() << "Error: Error reading from file " << currentFilename_
+                 << '\n';
+    return ExitStatus::MessageReadFailed;
+  }
 
-    auto err = encoder.error();
-    if (!err.empty()) {
-      // There was an error in converting the text to a binary message.
-      if (roundtrip_ && !silent_) {
-        // Send back an empty message to indicate `roundtrip` failure.
-        *output_ << (json_ ? kNullJsonMessage : kNullYamlMessage);
-      }
-      if (!silentError_) {
-        llvm::errs() << err << '\n';
-      }
-      if (!keepGoing_) {
-        return ExitStatus::EncodeFailed;
-      }
+  return ExitStatus::Success;
+}
 
-    } else if (roundtrip_) {
-      // Translate binary message back to text.
-      ofp::Message message{encoder.data(), encoder.size()};
-      message.normalize();
+// Encode messages that are already in memory. Each message is split out in
+// place. The output is flushed only when the output buffer fills, or when all
+// the messages are encoded.
+ExitStatus Encode::encodeBuffer(llvm::StringRef input) {
+  llvm::StringRef text;
+  int lineNum = 0;
+  ofp::yaml::Decoder decoder{json_};
+
+  ExitStatus result = ExitStatus::Success;
+  while (readMessageRange_(input, text, lineNum, lineNumber_)) {
+    result = encodeMessage(text, lineNum, &parser_, &decoder, *output_,
+                           llvm::errs());
+    if (result != ExitStatus::Success) {
+      break;
+    }
+  }
 
-      ofp::yaml::Decoder decoder{&message, json_};
+  output_->flush();
 
-      err = decoder.error();
-      if (!err.empty()) {
-        if (!silent_) {
-          // Send back an empty message to indicate `roundtrip` failure.
-          *output_ << (json_ ? kNullJsonMessage : kNullYamlMessage);
-        }
-        if (!silentError_) {
-          llvm::errs() << err << '\n';
-        }
-        if (!keepGoing_) {
-          return ExitStatus::RoundtripFailed;
+  return result;
+}
+
+// Encode messages using a pipeline of threads. A reader thread splits the
+// input into batches of messages; `jobs_` worker threads encode the batches;
+// and the calling thread writes the output of each batch in input order. If
+// `input` is null, the messages are split in place from `data`.
+ExitStatus Encode::encodeMessagesParallel(std::istream *input,
+                                          llvm::StringRef data) {
+  // Each worker thread has its own parser and decoder.
+  struct WorkerState {
+    explicit WorkerState(bool json) : decoder{json} {}
+
+    ofp::yaml::InputJson parser;
+    ofp::yaml::Decoder decoder;
+  };
+
+  return RunOrderedPipeline<Batch, ExitStatus, WorkerState>(
+      jobs_,
+      [&](Batch *batch) {
+        if (input) {
+          batch->readResult = readBatch(*input, batch);
+          return !*input;
         }
-      } else if (!silent_) {
-        *output_ << decoder.result();
-        if (json_)
-          *output_ << '\n';
+        batch->readResult = frameBatch(&data, batch);
+        return data.empty();
+      },
+      [this]() {
+        return std::unique_ptr<WorkerState>{new WorkerState{json_}};
+      },
+      [this](WorkerState *state, Batch *batch) {
+        encodeBatch(&state->parser, &state->decoder, batch);
+      },
+      [this](const Batch *batch) { return writeBatch(batch); });
+}
+
+// Read up to a batch of messages from the input. Report a read error in the
+// batch, so it is written after the output of all preceding messages.
+ExitStatus Encode::readBatch(std::istream &input, Batch *batch) {
+  std::string text;
+  int lineNum = 0;
+
+  while (batch->buffer.size() < kBatchMaxBytes &&
+         batch->items.size() < kBatchMaxMessages) {
+    if (!readMessage_(input, text, lineNum, lineNumber_)) {
+      if (!input.eof()) {
+        // Premature I/O error; we're not at EOF.
+        llvm::raw_string_ostream errs{batch->readErrors};
+        errs << "Error: Error reading from file " << currentFilename_ << '\n';
+        return ExitStatus::MessageReadFailed;
       }
+      break;
+    }
 
-    } else if (!silent_) {
-      output(encoder.data(), encoder.size());
+    batch->items.push_back({batch->buffer.size(), text.size(), lineNum});
+    batch->buffer += text;
+  }
+
+  batch->data = batch->buffer;
+
+  return ExitStatus::Success;
+}
+
+// Split up to a batch of messages in place from the front of `data`.
+ExitStatus Encode::frameBatch(llvm::StringRef *data, Batch *batch) {
+  const char *begin = data->begin();
+  llvm::StringRef text;
+  int lineNum = 0;
+
+  while (ofp::Unsigned_cast(data->begin() - begin) < kBatchMaxBytes &&
+         batch->items.size() < kBatchMaxMessages) {
+    if (!readMessageRange_(*data, text, lineNum, lineNumber_)) {
+      break;
+    }
+
+    batch->items.push_back(
+        {ofp::Unsigned_cast(text.begin() - begin), text.size(), lineNum});
+  }
+
+  batch->data =
+      llvm::StringRef{begin, ofp::Unsigned_cast(data->begin() - begin)};
+
+  return ExitStatus::Success;
+}
+
+// Encode the messages in a batch. This runs on a worker thread, so it must
+// not write to the output or error streams directly.
+void Encode::encodeBatch(ofp::yaml::InputJson *parser,
+                         ofp::yaml::Decoder *decoder, Batch *batch) const {
+  llvm::raw_string_ostream out{batch->output};
+  llvm::raw_string_ostream errs{batch->errors};
+
+  for (const Batch::Item &item : batch->items) {
+    llvm::StringRef text = batch->data.substr(item.offset, item.size);
+    ExitStatus result =
+        encodeMessage(text, item.lineNum, parser, decoder, out, errs);
+    if (result != ExitStatus::Success) {
+      batch->result = result;
+      break;
     }
+  }
 
+  out.flush();
+  errs.flush();
+}
+
+// Write the output and errors from an encoded batch. Return the status that
+// the serial encoder would return after the same messages.
+ExitStatus Encode::writeBatch(const Batch *batch) {
+  if (!batch->output.empty()) {
+    *output_ << batch->output;
     output_->flush();
   }
 
-  if (!input.eof()) {
-    // Premature I/O error; we're not at EOF.
-    llvm::errs() << "Error: Error reading from file " << currentFilename_
-                 << '\n';
-    return ExitStatus::MessageReadFailed;
+  if (!batch->errors.empty()) {
+    llvm::errs() << batch->errors;
+  }
+
+  if (batch->result != ExitStatus::Success) {
+    return batch->result;
+  }
+
+  if (batch->readResult != ExitStatus::Success) {
+    llvm::errs() << batch->readErrors;
+    return batch->readResult;
+  }
+
+  return ExitStatus::Success;
+}
+
+// Encode one message and write the output. Return an error status only if we
+// should stop. Set `nullTerminated` if `text` is followed by a null character;
+// otherwise, YAML text is copied before it is parsed.
+ExitStatus Encode::encodeMessage(llvm::StringRef text, int lineNum,
+                                 ofp::yaml::InputJson *parser,
+                                 ofp::yaml::Decoder *decoder,
+                                 llvm::raw_ostream &out, llvm::raw_ostream &errs,
+                                 bool nullTerminated) const {
+  log_debug("readMessage line", lineNum, ':', text);
+
+  ofp::yaml::Encoder encoder{parser,
+                             text,
+                             !uncheckedMatch_,
+                             lineNum,
+                             ofp::UInt8_narrow_cast(ofversion_.getValue()),
+                             nullptr,
+                             nullTerminated};
+
+  auto err = encoder.error();
+  if (!err.empty()) {
+    // There was an error in converting the text to a binary message.
+    if (roundtrip_ && !silent_) {
+      // Send back an empty message to indicate `roundtrip` failure.
+      out << (json_ ? kNullJsonMessage : kNullYamlMessage);
+    }
+    if (!silentError_) {
+      errs << err << '\n';
+    }
+    if (!keepGoing_) {
+      return ExitStatus::EncodeFailed;
+    }
+
+  } else if (roundtrip_) {
+    // Translate binary message back to text.
+    ofp::Message message{encoder.data(), encoder.size()};
+    message.normalize();
+
+    decoder->decode(&message);
+
+    err = decoder->error();
+    if (!err.empty()) {
+      if (!silent_) {
+        // Send back an empty message to indicate `roundtrip` failure.
+        out << (json_ ? kNullJsonMessage : kNullYamlMessage);
+      }
+      if (!silentError_) {
+        errs << err << '\n';
+      }
+      if (!keepGoing_) {
+        return ExitStatus::RoundtripFailed;
+      }
+    } else if (!silent_) {
+      out << decoder->result();
+      if (json_)
+        out << '\n';
+    }
+
+  } else if (!silent_) {
+    output(out, encoder.data(), encoder.size());
   }
 
   return ExitStatus::Success;
 }
 
-void Encode::output(const void *data, size_t length) {
+void Encode::output(llvm::raw_ostream &out, const void *data,
+                    size_t length) const {
   if (hex_) {
     // Output hex in rows of 4 blocks of 8 bytes each.
     const unsigned rowlen = 68;
@@ -179,16 +410,16 @@ void Encode::output(const void *data, size_t length) {
     auto left = hex.size() % rowlen;
 
     for (auto i = 0U; i < rows; ++i) {
-      *output_ << hex.substr(i * rowlen, rowlen) << '\n';
+      out << hex.substr(i * rowlen, rowlen) << '\n';
     }
 
     if (left) {
-      *output_ << hex.substr(rows * rowlen, left) << '\n';
+      out << hex.substr(rows * rowlen, left) << '\n';
     }
-    *output_ << '\n';
+    out << '\n';
 
   } else {
     // Write binary message to stdout.
-    output_->write(static_cast<const char *>(data), length);
+    out.write(static_cast<const char *>(data), length);
   }
 }
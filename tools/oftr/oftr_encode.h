@@ -5,7 +5,9 @@
 #define TOOLS_OFTR_OFTR_ENCODE_H_
 
 #include "./oftr.h"
+#include "ofp/yaml/decoder.h"
 #include "ofp/yaml/getjson.h"
+#include "ofp/yaml/inputjson.h"
 
 namespace ofpx {
 
@@ -31,6 +33,7 @@ namespace ofpx {
 //   --json-array             Json input is arbitrarily delimited objects
 //   --ofversion=0            OpenFlow version to use when unspecified
 //   --output=<file> (-o)     Write output to specified file instead of stdout
+//   --jobs=<num>             Encode messages using <num> worker threads
 //
 // Usage:
 //
@@ -52,6 +55,11 @@ namespace ofpx {
 // contained in a JSON array:
 //
 //   oftr encode --json-array "filename"
+//
+// To translate a large text file of JSON objects using 4 threads. The output
+// is in the same order as the input:
+//
+//   oftr encode --json --jobs=4 "filename"
 
 OFP_BEGIN_IGNORE_PADDING
 
@@ -69,16 +77,34 @@ class Encode : public Subprogram {
   int run(int argc, const char *const *argv) override;
 
  private:
+  struct Batch;
+
   std::string currentFilename_;
   std::unique_ptr<llvm::raw_ostream> output_;
   int lineNumber_ = 0;
   ofp::yaml::GetMsgFunction readMessage_ = nullptr;
+  ofp::yaml::GetMsgRangeFunction readMessageRange_ = nullptr;
+  ofp::yaml::InputJson parser_;
 
   bool validateCommandLineArguments();
   ExitStatus encodeFiles();
   ExitStatus encodeFile(const std::string &filename);
+  ExitStatus encodeMappedFile(const std::string &filename);
   ExitStatus encodeMessages(std::istream &input);
-  void output(const void *data, size_t length);
+  ExitStatus encodeBuffer(llvm::StringRef input);
+  ExitStatus encodeMessagesParallel(std::istream *input,
+                                    llvm::StringRef data);
+  ExitStatus readBatch(std::istream &input, Batch *batch);
+  ExitStatus frameBatch(llvm::StringRef *data, Batch *batch);
+  void encodeBatch(ofp::yaml::InputJson *parser, ofp::yaml::Decoder *decoder,
+                   Batch *batch) const;
+  ExitStatus writeBatch(const Batch *batch);
+  ExitStatus encodeMessage(llvm::StringRef text, int lineNum,
+                           ofp::yaml::InputJson *parser,
+                           ofp::yaml::Decoder *decoder, llvm::raw_ostream &out,
+                           llvm::raw_ostream &errs,
+                           bool nullTerminated = false) const;
+  void output(llvm::raw_ostream &out, const void *data, size_t length) const;
 
   // --- Command-line Arguments ---
   cl::opt<bool> hex_{"hex", cl::desc("Output hexadecimal rather than binary")};
@@ -101,6 +127,9 @@ class Encode : public Subprogram {
   cl::opt<std::string> outputFile_{
       "output", cl::desc("Write output to specified file instead of stdout"),
       cl::ValueRequired};
+  cl::opt<unsigned> jobs_{
+      "jobs", cl::desc("Encode messages using N worker threads"),
+      cl::ValueRequired, cl::init(1)};
   cl::list<std::string> inputFiles_{cl::Positional, cl::desc("<Input files>")};
 
   // --- Argument Aliases (May be grouped into one argument) ---
@@ -148,7 +148,7 @@ static const char *const kBuiltinTypes[] = {
     "MacAddress",    "IPv4Address",    "IPv6Address",    "IPEndpoint",
     "LLDPChassisID", "LLDPPortID",     "ActionID",       "FieldID",
     "InstructionID", "Timestamp",      "RegisterBits",   "DurationSec",
-    "VlanNumber",    "LLDPByteString", "LLDPOrgSpecific"};
+    "VlanNumber",    "LLDPByteString", "LLDPOrgSpecific", "Boolean"};
 
 using SchemaPair = std::pair<ofp::yaml::SchemaMakerFunction, const char *>;
 
@@ -6,7 +6,7 @@
 #include <sys/resource.h>  // for getrlimit, setrlimit
 #include <unistd.h>        // for STDIN_FILENO, STDOUT_FILENO
 
-#include "ofp/rpc/rpcserver.h"
+#include "ofp/rpc/rpcevents.h"
 
 using namespace ofpx;
 using namespace ofp;
@@ -17,6 +17,11 @@ int JsonRpc::run(int argc, const char *const *argv) {
   parseCommandLineOptions(argc, argv, "Run a JSON-RPC server\n");
   setMaxOpenFiles();
 
+  if (!rpcShm_.empty()) {
+    // Communicate over shared memory.
+    return runSharedMemory(rpcShm_);
+  }
+
   if (rpcSocket_.empty()) {
     // Communicate over STDIN/STDOUT.
     return runStdio();
@@ -61,10 +66,39 @@ void JsonRpc::setMaxOpenFiles() {
   log_info("Open file limit: rlim_cur", rlp.rlim_cur, "rlim_max", rlp.rlim_max);
 }
 
+/// Apply options shared by all RPC transports. Return false on error.
+bool JsonRpc::setUpServer(rpc::RpcServer *server) {
+  server->setOutputLimit(outputLimit_, overflowPolicy_, outputLowWater_);
+
+  // A merged multipart reply is sent as one RPC event, so there is no use
+  // buffering more than the largest event.
+  size_t multipartLimit = multipartLimit_;
+  if (multipartLimit > rpc::RPC_MAX_MESSAGE_SIZE) {
+    log_warning("--multipart-limit too large; using",
+                rpc::RPC_MAX_MESSAGE_SIZE);
+    multipartLimit = rpc::RPC_MAX_MESSAGE_SIZE;
+  }
+  server->setMultipartLimit(multipartLimit, Milliseconds{multipartTimeout_});
+  server->setBase64Bytes(base64Bytes_);
+
+  if (!metricsSocket_.empty()) {
+    auto err = server->bindMetrics(metricsSocket_);
+    if (err) {
+      log_error("Metrics socket error:", metricsSocket_, err);
+      return false;
+    }
+  }
+
+  return true;
+}
+
 int JsonRpc::runStdio() {
   const Milliseconds metricInterval{metricInterval_};
 
   rpc::RpcServer server{binaryProtocol_, metricInterval};
+  if (!setUpServer(&server)) {
+    return static_cast<int>(ExitStatus::ListenFailed);
+  }
   server.bind(::dup(STDIN_FILENO), ::dup(STDOUT_FILENO));
   server.run();
 
@@ -75,6 +109,9 @@ int JsonRpc::runSocket(int socketFD) {
   const Milliseconds metricInterval{metricInterval_};
 
   rpc::RpcServer server{binaryProtocol_, metricInterval};
+  if (!setUpServer(&server)) {
+    return static_cast<int>(ExitStatus::ListenFailed);
+  }
   auto err = server.bind(socketFD);
   if (err) {
     log_error("Unix domain socket error:", err);
@@ -90,6 +127,9 @@ int JsonRpc::runSocketServer(const std::string &path) {
   const Milliseconds metricInterval{metricInterval_};
 
   rpc::RpcServer server{binaryProtocol_, metricInterval};
+  if (!setUpServer(&server)) {
+    return static_cast<int>(ExitStatus::ListenFailed);
+  }
   auto err = server.bind(path);
   if (err) {
     log_error("Unix domain socket error:", path, err);
@@ -101,6 +141,24 @@ int JsonRpc::runSocketServer(const std::string &path) {
   return 0;
 }
 
+int JsonRpc::runSharedMemory(const std::string &path) {
+  const Milliseconds metricInterval{metricInterval_};
+
+  rpc::RpcServer server{true, metricInterval};
+  if (!setUpServer(&server)) {
+    return static_cast<int>(ExitStatus::ListenFailed);
+  }
+  auto err = server.bindSharedMemory(path);
+  if (err) {
+    log_error("Shared memory error:", path, err);
+    return static_cast<int>(ExitStatus::ListenFailed);
+  }
+
+  server.run();
+
+  return 0;
+}
+
 /// Return integer value of RPC socket path.
 /// Return -1 if value is not a positive integer.
 int JsonRpc::getSocketFD() const {
@@ -5,6 +5,7 @@
 #define TOOLS_OFTR_OFTR_JSONRPC_H_
 
 #include "./oftr.h"
+#include "ofp/rpc/rpcserver.h"
 
 namespace ofpx {
 
@@ -17,7 +18,27 @@ namespace ofpx {
 //                           If <path> is an integer, use inherited descriptor
 //                           number. Otherwise, listen on <path> for first
 //                           connection.
+//   --rpc-shm=<path>        Control connection runs over shared memory. The
+//                           controller connects to <path> to obtain the
+//                           shared memory region (Linux only).
 //   --metric-interval=0     Log RPC metrics at specified interval (msec)
+//   --rpc-output-limit=0    Limit size of RPC output queue (bytes)
+//   --rpc-overflow-policy=block
+//                           What to do when the RPC output queue is full:
+//                           block, drop or disconnect
+//   --rpc-output-low-water=0
+//                           Resume reading after a block when the RPC output
+//                           queue drains to this size (0 means half the
+//                           limit)
+//   --multipart-limit=0     Reassemble multipart replies using up to this
+//                           many bytes of buffer space (0 means disabled,
+//                           at most 1048576)
+//   --multipart-timeout=1000
+//                           Send partial multipart replies after timeout
+//                           (msec)
+//   --rpc-base64            Write byte fields, like PacketIn data, as base64
+//                           instead of hexadecimal (default for each RPC
+//                           connection; see OFP.DESCRIPTION)
 //
 // Usage:
 //
@@ -38,16 +59,53 @@ class JsonRpc : public Subprogram {
                                 cl::desc("Use binary frame protocol")};
   cl::opt<std::string> rpcSocket_{"rpc-socket",
                                   cl::desc("Listen on unix domain socket")};
+  cl::opt<std::string> rpcShm_{
+      "rpc-shm", cl::desc("Use shared memory; listen on unix domain socket")};
   cl::opt<unsigned> metricInterval_{
       "metric-interval",
       cl::desc("Log RPC metrics at specified interval (msec)"),
       cl::ValueRequired};
+  cl::opt<unsigned> outputLimit_{
+      "rpc-output-limit",
+      cl::desc("Limit size of RPC output queue (bytes)"), cl::ValueRequired};
+  cl::opt<ofp::rpc::RpcOverflowPolicy> overflowPolicy_{
+      "rpc-overflow-policy",
+      cl::desc("Action when RPC output queue is full"),
+      cl::ValueRequired,
+      cl::init(ofp::rpc::RpcOverflowPolicy::BLOCK),
+      cl::values(clEnumValN(ofp::rpc::RpcOverflowPolicy::BLOCK, "block",
+                            "Pause reading from OpenFlow connections"),
+                 clEnumValN(ofp::rpc::RpcOverflowPolicy::DROP, "drop",
+                            "Drop oldest PACKET_IN events"),
+                 clEnumValN(ofp::rpc::RpcOverflowPolicy::DISCONNECT,
+                            "disconnect", "Close the RPC connection"))};
+  cl::opt<unsigned> outputLowWater_{
+      "rpc-output-low-water",
+      cl::desc("Resume reading when RPC output queue drains to size (bytes)"),
+      cl::ValueRequired};
+  cl::opt<unsigned> multipartLimit_{
+      "multipart-limit",
+      cl::desc("Reassemble multipart replies using up to N bytes"),
+      cl::ValueRequired};
+  cl::opt<unsigned> multipartTimeout_{
+      "multipart-timeout",
+      cl::desc("Send partial multipart replies after timeout (msec)"),
+      cl::ValueRequired, cl::init(1000)};
+  cl::opt<bool> base64Bytes_{
+      "rpc-base64",
+      cl::desc("Write byte fields in OFP.MESSAGE events as base64")};
+  cl::opt<std::string> metricsSocket_{
+      "metrics-socket",
+      cl::desc("Serve Prometheus metrics on unix domain socket"),
+      cl::ValueRequired};
 
   void setMaxOpenFiles();
+  bool setUpServer(ofp::rpc::RpcServer *server);
 
   int runStdio();
   int runSocket(int socketFD);
   int runSocketServer(const std::string &path);
+  int runSharedMemory(const std::string &path);
 
   int getSocketFD() const;
 };
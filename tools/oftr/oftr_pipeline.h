@@ -0,0 +1,137 @@
+// Copyright (c) 2015-2018 William W. Fisher (at gmail dot com)
+// This file is distributed under the MIT License.
+
+#ifndef TOOLS_OFTR_OFTR_PIPELINE_H_
+#define TOOLS_OFTR_OFTR_PIPELINE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ofpx {
+
+// Limits on the size of a batch of messages in the parallel pipeline.
+const size_t kBatchMaxBytes = 256 * 1024;
+const size_t kBatchMaxMessages = 1024;
+
+// Number of batches each worker thread may have in flight.
+const size_t kBatchesPerJob = 4;
+
+/// Process batches of messages using a pipeline of threads, and write the
+/// results in input order. Used by `oftr decode` and `oftr encode` (--jobs).
+///
+/// A reader thread calls `read` to fill each new batch; `read` returns true
+/// for the last batch. `jobs` worker threads each call `makeState` once, then
+/// call `work` for each batch with their own state. The calling thread calls
+/// `write` for each batch in input order. If `write` returns a status other
+/// than `Status::Success`, the pipeline stops and returns that status.
+template <class Batch, class Status, class State>
+Status RunOrderedPipeline(
+    unsigned jobs, const std::function<bool(Batch *)> &read,
+    const std::function<std::unique_ptr<State>()> &makeState,
+    const std::function<void(State *, Batch *)> &work,
+    const std::function<Status(const Batch *)> &write) {
+  struct Slot {
+    std::unique_ptr<Batch> batch;
+    bool done;
+  };
+
+  const size_t maxBatches = kBatchesPerJob * jobs;
+
+  // `batches` holds the batches in input order; `firstSeq` is the sequence
+  // number of the front batch and `nextSeq` is the next batch to process.
+  std::mutex mutex;
+  std::condition_variable workReady;
+  std::condition_variable batchDone;
+  std::deque<Slot> batches;
+  size_t firstSeq = 0;
+  size_t nextSeq = 0;
+  bool eof = false;
+  bool stop = false;
+
+  std::thread reader{[&]() {
+    bool last = false;
+    while (!last) {
+      std::unique_ptr<Batch> batch{new Batch};
+      last = read(batch.get());
+
+      std::unique_lock<std::mutex> lock{mutex};
+      batchDone.wait(lock,
+                     [&]() { return stop || batches.size() < maxBatches; });
+      if (stop)
+        return;
+      batches.push_back(Slot{std::move(batch), false});
+      eof = last;
+      workReady.notify_all();
+      if (eof)
+        batchDone.notify_all();
+    }
+  }};
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < jobs; ++i) {
+    workers.emplace_back([&]() {
+      std::unique_ptr<State> state = makeState();
+
+      std::unique_lock<std::mutex> lock{mutex};
+      for (;;) {
+        workReady.wait(lock, [&]() {
+          return stop || eof || nextSeq < firstSeq + batches.size();
+        });
+        if (stop || nextSeq == firstSeq + batches.size())
+          return;
+
+        // The batch stays in `batches` until it is done.
+        size_t seq = nextSeq++;
+        Batch *batch = batches[seq - firstSeq].batch.get();
+        lock.unlock();
+        work(state.get(), batch);
+        lock.lock();
+        batches[seq - firstSeq].done = true;
+        batchDone.notify_all();
+      }
+    });
+  }
+
+  Status result = Status::Success;
+  std::unique_lock<std::mutex> lock{mutex};
+  for (;;) {
+    batchDone.wait(lock, [&]() {
+      return (eof && batches.empty()) ||
+             (!batches.empty() && batches.front().done);
+    });
+    if (batches.empty())
+      break;
+
+    std::unique_ptr<Batch> batch = std::move(batches.front().batch);
+    batches.pop_front();
+    ++firstSeq;
+    batchDone.notify_all();
+
+    lock.unlock();
+    result = write(batch.get());
+    lock.lock();
+    if (result != Status::Success)
+      break;
+  }
+
+  stop = true;
+  workReady.notify_all();
+  batchDone.notify_all();
+  lock.unlock();
+
+  reader.join();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  return result;
+}
+
+}  // namespace ofpx
+
+#endif  // TOOLS_OFTR_OFTR_PIPELINE_H_
@@ -26,6 +26,12 @@ for input in $CURRENT_SOURCE_DIR/*-pass.bin ; do
   diff $output_json "$CURRENT_SOURCE_DIR/$name.json"
   rm $output_json
 
+  echo "  Run oftr decode --jobs=2 to convert $input to $output_json"
+  $LIBOFP_MEMCHECK ../oftr decode --json --jobs=2 $input > $output_json
+  echo "  Compare $output_json to $CURRENT_SOURCE_DIR/$name.json"
+  diff $output_json "$CURRENT_SOURCE_DIR/$name.json"
+  rm $output_json
+
   if [ -f "$CURRENT_SOURCE_DIR/$name.jsonarray" ]; then
     # Not all test cases include a .jsonarray version.
     echo "  Run oftr decode to convert $input to $output_array"
@@ -47,6 +53,12 @@ for input in $CURRENT_SOURCE_DIR/*-pass.yml ; do
   echo "  Compare $output to $CURRENT_SOURCE_DIR/$name.bin"
   diff $output "$CURRENT_SOURCE_DIR/$name.bin"
   rm $output
+
+  echo "  Run oftr encode --jobs=2 to convert $input to $output"
+  $LIBOFP_MEMCHECK ../oftr encode -M --jobs=2 $input > $output
+  echo "  Compare $output to $CURRENT_SOURCE_DIR/$name.bin"
+  diff $output "$CURRENT_SOURCE_DIR/$name.bin"
+  rm $output
 done
 
 echo "Test encode of JSON OpenFlow messages."
@@ -88,6 +100,118 @@ for input in $CURRENT_SOURCE_DIR/*-pass.json-alt ; do
   rm $output
 done
 
+echo "Test encode --jobs=2 --keep-going of messages with errors."
+
+# Write more than one batch (1024 messages) of JSON messages with an invalid
+# message in each batch. The parallel encoder must produce the same output,
+# errors and exit status as the serial encoder.
+input="keep-going$$.json"
+for i in `seq 1 3000`; do
+  if [ $((i % 250)) -eq 0 ]; then
+    echo "{\"type\":\"BOGUS\",\"version\":4,\"xid\":$i,\"msg\":{}}"
+  else
+    echo "{\"type\":\"BARRIER_REQUEST\",\"version\":4,\"xid\":$i,\"msg\":{}}"
+  fi
+done > $input
+
+# Run oftr encode reading $input from a file or stdin (first argument). Save
+# the output, errors and exit status to files named by the second argument.
+run_encode() {
+  local source=$1
+  local result=$2
+  shift 2
+  local status=0
+  if [ "$source" = "stdin" ]; then
+    $LIBOFP_MEMCHECK ../oftr encode "$@" < $input > $result.out 2> $result.err || status=$?
+  else
+    $LIBOFP_MEMCHECK ../oftr encode "$@" $input > $result.out 2> $result.err || status=$?
+  fi
+  echo $status > $result.status
+}
+
+for source in file stdin; do
+  serial="keep-going-serial$$"
+  parallel="keep-going-parallel$$"
+
+  echo "  Run oftr encode --keep-going reading $input from $source"
+  run_encode $source $serial -Rj --keep-going
+  echo "  Run oftr encode --jobs=2 --keep-going reading $input from $source"
+  run_encode $source $parallel -Rj --keep-going --jobs=2
+
+  echo "  Compare $parallel output, errors and exit status to $serial"
+  diff $parallel.out $serial.out
+  diff $parallel.err $serial.err
+  diff $parallel.status $serial.status
+
+  # Make sure the test input did what it is meant to. Each invalid message
+  # is reported with its line number, and leaves a `null` in the output.
+  test `grep -c "^YAML:[0-9]*:9: error" $serial.err` -eq 12
+  grep -q "^YAML:3000:9: error" $serial.err
+  test `grep -c "^null$" $serial.out` -eq 12
+  test `grep -c "BARRIER_REQUEST" $serial.out` -eq 2988
+
+  rm $serial.out $serial.err $serial.status
+  rm $parallel.out $parallel.err $parallel.status
+done
+
+rm $input
+
+echo "Test decode with message type and packet filters."
+
+# The input mixes version 1 messages with later versions. A version 1
+# BARRIER_REQUEST has the type number of a MULTIPART_REQUEST in later versions,
+# and a version 1 STATS_REQUEST has the type number of a PORT_MOD.
+input="filter$$.bin"
+cat "$CURRENT_SOURCE_DIR/hydrogen_from_controller-pass.bin" \
+    "$CURRENT_SOURCE_DIR/hydrogen_to_controller-pass.bin" \
+    "$CURRENT_SOURCE_DIR/ryu_packet_data-pass.bin" > $input
+
+unfiltered="filter-all$$.out"
+$LIBOFP_MEMCHECK ../oftr decode -j --pkt-decode $input > $unfiltered
+
+# Match a message's type and version, or an ARP packet in its _pkt.
+v1_type() { echo '^{"type":"'$1'",[^{]*"version":1,'; }
+arp_pkt='"_pkt":\[[^]]*"field":"ETH_TYPE","value":2054'
+
+# Decode $input with the given filter arguments, reading from a file, from
+# stdin and with --jobs=2. Compare each output to $expected.
+run_decode_filter() {
+  local output="filter$$.out"
+  echo "  Run oftr decode $@"
+  $LIBOFP_MEMCHECK ../oftr decode -j --pkt-decode "$@" $input > $output
+  diff $output $expected
+  $LIBOFP_MEMCHECK ../oftr decode -j --pkt-decode "$@" < $input > $output
+  diff $output $expected
+  $LIBOFP_MEMCHECK ../oftr decode -j --pkt-decode --jobs=2 "$@" $input > $output
+  diff $output $expected
+  rm $output
+}
+
+expected="filter-expected$$.out"
+
+grep '^{"type":"BARRIER_' $unfiltered > $expected
+test `grep -c "$(v1_type BARRIER_REQUEST)" $expected` -eq 2
+test `grep -c "$(v1_type BARRIER_REPLY)" $expected` -eq 2
+run_decode_filter --msg-include='BARRIER_*'
+
+grep '^{"type":"PORT_STATS_\|^{"type":"PORT_MOD"' $unfiltered > $expected
+test `grep -c "$(v1_type PORT_STATS_REQUEST)" $expected` -eq 8
+test `grep -c "$(v1_type PORT_STATS_REPLY)" $expected` -eq 8
+run_decode_filter --msg-include='PORT_STATS_*,PORT_MOD'
+
+grep -v '^{"type":"PACKET_' $unfiltered > $expected
+run_decode_filter --msg-exclude='PACKET_*'
+
+awk '!/^{"type":"PACKET_/ || /'"$arp_pkt"'/' $unfiltered > $expected
+test `grep -c "$(v1_type PACKET_IN)" $expected` -eq 5
+test `grep -c "$(v1_type PACKET_OUT)" $expected` -eq 5
+run_decode_filter --pkt-filter=arp
+
+grep '^{"type":"PACKET_' $unfiltered | grep "$arp_pkt" > $expected
+run_decode_filter --msg-include='PACKET_*' --pkt-filter=arp
+
+rm $input $unfiltered $expected
+
 echo "Done."
 
 exit 0